@@ -0,0 +1,79 @@
+#include "AudioBackendRegistry.h"
+
+#include "AudioCaptureImpl_File.h"
+#include "AudioCaptureImpl_Pipe.h"
+#include "AudioCaptureImpl_SDL.h"
+#include "AudioCaptureImpl_Synthetic.h"
+
+#ifdef AUDIO_BACKEND_WASAPI
+#include "AudioCaptureImpl_WASAPI.h"
+#endif
+
+#include <Poco/String.h>
+
+#include <algorithm>
+
+void AudioBackendRegistry::Register(const std::string& name, const std::string& description, Factory factory)
+{
+    auto& backends = BackendList();
+
+    auto existingBackend = std::find_if(backends.begin(), backends.end(), [&name](const Backend& backend) {
+        return Poco::icompare(backend.name, name) == 0;
+    });
+
+    if (existingBackend != backends.end())
+    {
+        existingBackend->description = description;
+        existingBackend->factory = std::move(factory);
+        return;
+    }
+
+    backends.push_back({Poco::toLower(name), description, std::move(factory)});
+}
+
+std::unique_ptr<AudioCaptureImpl> AudioBackendRegistry::Create(const std::string& name)
+{
+    for (const auto& backend : BackendList())
+    {
+        if (Poco::icompare(backend.name, name) == 0)
+        {
+            return backend.factory();
+        }
+    }
+
+    return {};
+}
+
+const std::vector<AudioBackendRegistry::Backend>& AudioBackendRegistry::Backends()
+{
+    return BackendList();
+}
+
+std::string AudioBackendRegistry::DefaultBackend()
+{
+#ifdef AUDIO_BACKEND_WASAPI
+    // SDL's WASAPI driver can't record from playback devices in loopback mode.
+    return "wasapi";
+#else
+    return "sdl";
+#endif
+}
+
+std::vector<AudioBackendRegistry::Backend>& AudioBackendRegistry::BackendList()
+{
+    static std::vector<Backend> backends{
+#ifdef AUDIO_BACKEND_WASAPI
+        {"wasapi", "Windows Audio Session API, including loopback recording from playback devices.",
+         [] { return std::unique_ptr<AudioCaptureImpl>(new AudioCaptureImpl_WASAPI); }},
+#endif
+        {"sdl", "SDL2 audio recording devices.",
+         [] { return std::unique_ptr<AudioCaptureImpl>(new AudioCaptureImpl_SDL); }},
+        {"file", "Plays back the WAV, FLAC or raw PCM file set in audio.file.",
+         [] { return std::unique_ptr<AudioCaptureImpl>(new AudioCaptureImpl_File); }},
+        {"pipe", "Reads raw PCM data from standard input or the named pipe set in audio.pipe.",
+         [] { return std::unique_ptr<AudioCaptureImpl>(new AudioCaptureImpl_Pipe); }},
+        {"synthetic", "Generates a deterministic test signal with a steady beat.",
+         [] { return std::unique_ptr<AudioCaptureImpl>(new AudioCaptureImpl_Synthetic); }}};
+
+    return backends;
+}
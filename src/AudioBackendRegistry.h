@@ -0,0 +1,67 @@
+#pragma once
+
+#include "AudioCaptureImpl.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Registry of all audio capture backends compiled into the application.
+ *
+ * Maps backend names, as used in the audio.backend configuration key, to factory functions. All built-in backends are
+ * registered automatically. The registry is only accessed on the main thread and thus not thread-safe.
+ */
+class AudioBackendRegistry
+{
+public:
+    using Factory = std::function<std::unique_ptr<AudioCaptureImpl>()>;
+
+    /**
+     * @brief Information about a registered backend.
+     */
+    struct Backend
+    {
+        std::string name; //!< Unique, lower-case name of the backend.
+        std::string description; //!< Short, human-readable description.
+        Factory factory; //!< Function creating a new backend instance.
+    };
+
+    /**
+     * @brief Adds a backend to the registry.
+     *
+     * If a backend with the same name already exists, it is replaced.
+     *
+     * @param name The name used to select the backend.
+     * @param description A short description, shown in the command line help.
+     * @param factory Function creating a new backend instance.
+     */
+    static void Register(const std::string& name, const std::string& description, Factory factory);
+
+    /**
+     * @brief Creates a new instance of the given backend.
+     * @param name The backend name. Case-insensitive.
+     * @return The new backend instance, or nullptr if no backend with the given name is registered.
+     */
+    static std::unique_ptr<AudioCaptureImpl> Create(const std::string& name);
+
+    /**
+     * @brief Returns all registered backends in registration order.
+     * @return A list of all backends.
+     */
+    static const std::vector<Backend>& Backends();
+
+    /**
+     * @brief Returns the name of the preferred backend for the current platform.
+     * @return The default backend name.
+     */
+    static std::string DefaultBackend();
+
+private:
+    /**
+     * @brief Returns the list of backends, registering the built-in ones on first use.
+     * @return The mutable backend list.
+     */
+    static std::vector<Backend>& BackendList();
+};
@@ -1,7 +1,6 @@
 #include "AudioCapture.h"
 
-#include AUDIO_IMPL_HEADER
-
+#include "AudioBackendRegistry.h"
 #include "ProjectMWrapper.h"
 
 #include "notifications/DisplayToastNotification.h"
@@ -23,7 +22,7 @@ void AudioCapture::initialize(Poco::Util::Application& app)
 
     if (!_impl)
     {
-        _impl = new AudioCaptureImpl;
+        _impl = CreateBackend();
     }
 
     auto deviceList = _impl->AudioDeviceList();
@@ -39,8 +38,7 @@ void AudioCapture::uninitialize()
     if (_impl)
     {
         _impl->StopRecording();
-        delete _impl;
-        _impl = nullptr;
+        _impl.reset();
     }
 }
 
@@ -82,11 +80,12 @@ std::string AudioCapture::AudioDeviceName() const
     return _impl->AudioDeviceName();
 }
 
-AudioCapture::AudioDeviceMap AudioCapture::AudioDeviceList()
+const AudioCapture::AudioDeviceMap& AudioCapture::AudioDeviceList()
 {
     if (!_impl)
     {
-        return {{-1, "(No audio devices available)"}};
+        static const AudioDeviceMap noDevices{{-1, "(No audio devices available)"}};
+        return noDevices;
     }
 
     return _impl->AudioDeviceList();
@@ -102,6 +101,71 @@ void AudioCapture::FillBuffer()
     _impl->FillBuffer();
 }
 
+bool AudioCapture::EndOfInput() const
+{
+    if (!_impl)
+    {
+        return true;
+    }
+
+    return _impl->EndOfInput();
+}
+
+std::unique_ptr<AudioCaptureImpl> AudioCapture::CreateBackend()
+{
+    // For convenience, a configured audio file selects the file backend if no backend is set explicitly.
+    auto backendName = _config->getString("backend", "");
+    if (backendName.empty())
+    {
+        backendName = _config->getString("file", "").empty() ? AudioBackendRegistry::DefaultBackend() : "file";
+    }
+
+    auto backend = AudioBackendRegistry::Create(backendName);
+    if (!backend)
+    {
+        std::string availableBackends;
+        for (const auto& availableBackend : AudioBackendRegistry::Backends())
+        {
+            availableBackends += (availableBackends.empty() ? "" : ", ") + availableBackend.name;
+        }
+
+        poco_error_f3(_logger, R"(Unknown audio backend "%s". Available backends are: %s. Using "%s" instead.)",
+                      backendName, availableBackends, AudioBackendRegistry::DefaultBackend());
+
+        backendName = AudioBackendRegistry::DefaultBackend();
+        backend = AudioBackendRegistry::Create(backendName);
+    }
+
+    poco_information_f1(_logger, R"(Using audio backend "%s".)", backendName);
+
+    return backend;
+}
+
+void AudioCapture::AudioDeviceEvent(const SDL_AudioDeviceEvent& event)
+{
+    if (!_impl)
+    {
+        return;
+    }
+
+    if (event.type == SDL_AUDIODEVICEADDED)
+    {
+        _impl->AudioDeviceAdded(static_cast<int>(event.which), event.iscapture != 0);
+    }
+    else if (event.type == SDL_AUDIODEVICEREMOVED)
+    {
+        auto previousDeviceName = _impl->AudioDeviceName();
+        _impl->AudioDeviceRemoved(event.which, event.iscapture != 0);
+
+        auto currentDeviceName = _impl->AudioDeviceName();
+        if (currentDeviceName != previousDeviceName)
+        {
+            Poco::NotificationCenter::defaultCenter().postNotification(
+                new DisplayToastNotification("Audio device removed, switched to " + currentDeviceName));
+        }
+    }
+}
+
 void AudioCapture::PrintDeviceList(const AudioDeviceMap& deviceList) const
 {
     if (_config->getBool("listDevices", false))
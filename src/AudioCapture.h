@@ -1,18 +1,21 @@
 #pragma once
 
+#include "AudioCaptureImpl.h"
+
 #include <Poco/Logger.h>
 
+#include <SDL2/SDL.h>
+
 #include <Poco/Util/Subsystem.h>
 #include <Poco/Util/AbstractConfiguration.h>
 
 #include <memory>
 
-class AudioCaptureImpl;
-
 /**
  * @brief Audio capturing proxy class/subsystem.
  *
- * Creates the OS-specific audio recording class and forwards the necessary calls to it.
+ * Creates the audio capture backend selected in audio.backend and forwards the necessary calls to it. If no backend
+ * is configured, the platform's default backend is used, or the file backend if audio.file is set.
  */
 class AudioCapture : public Poco::Util::Subsystem
 {
@@ -50,16 +53,44 @@ public:
 
     /**
      * @brief Returns a list of currently available audio devices.
+     *
+     * The list is cached by the backend and updated on hotplug events, so this is cheap to call every frame.
+     *
      * @return A map with device index/name pairs.
      */
-    AudioDeviceMap AudioDeviceList();
+    const AudioDeviceMap& AudioDeviceList();
 
     /**
      * @brief Asks the capture client to fill projectM's audio buffer for the next frame.
      */
     void FillBuffer();
 
+    /**
+     * @brief Returns whether the audio source has run out of data, e.g. at the end of a non-looping file.
+     * @return True if the backend won't deliver any more audio data.
+     */
+    bool EndOfInput() const;
+
+    /**
+     * @brief Forwards SDL's audio device hotplug events to the capture backend.
+     *
+     * If the current device was removed, the backend falls back to the default device and a toast message
+     * is displayed.
+     *
+     * @param event The SDL audio device event.
+     */
+    void AudioDeviceEvent(const SDL_AudioDeviceEvent& event);
+
 protected:
+    /**
+     * @brief Creates the configured audio capture backend.
+     *
+     * Falls back to the platform default backend if the configured name is unknown.
+     *
+     * @return The new backend instance.
+     */
+    std::unique_ptr<AudioCaptureImpl> CreateBackend();
+
     /**
      * @brief Prints a list of available audio devices on standard output if requested by the user.
      * @param deviceList The list of available audio devices.
@@ -82,7 +113,7 @@ protected:
 
     Poco::AutoPtr<Poco::Util::AbstractConfiguration> _config; //!< View of the "audio" configuration subkey.
 
-    AudioCaptureImpl* _impl{}; //!< The OS-specific capture implementation.
+    std::unique_ptr<AudioCaptureImpl> _impl; //!< The capture backend implementation.
 
     Poco::Logger& _logger{ Poco::Logger::get("AudioCapture") }; //!< The class logger.
 };
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Poco/Foundation.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+struct projectm;
+
+/**
+ * @brief Interface for audio capturing backends.
+ *
+ * Each backend provides audio data from a different source, e.g. a capture API, a file or a pipe. Backends are
+ * created via the AudioBackendRegistry and used through the AudioCapture subsystem.
+ */
+class AudioCaptureImpl
+{
+public:
+    virtual ~AudioCaptureImpl() = default;
+
+    /**
+     * @brief Returns a map of available recording devices.
+     *
+     * Backends cache the device list and only update it if devices are added or removed, so this is cheap to call
+     * on every frame. The IDs are only valid as long as the backend exists.
+     *
+     * @return A map of available audio device IDs and names.
+     */
+    virtual const std::map<int, std::string>& AudioDeviceList() = 0;
+
+    /**
+     * @brief Starts audio capturing with the first available device.
+     * @param projectMHandle projectM instance handle that will receive the captured data.
+     * @param audioDeviceIndex The initial audio device ID to capture from. Use -1 to select the implementation's
+     *                      default device.
+     */
+    virtual void StartRecording(projectm* projectMHandle, int audioDeviceIndex) = 0;
+
+    /**
+     * @brief Stops audio recording.
+     */
+    virtual void StopRecording() = 0;
+
+    /**
+     * @brief Switches to the next available audio recording device.
+     */
+    virtual void NextAudioDevice() = 0;
+
+    /**
+     * @brief Activates the audio device with the given idnex for recording.
+     * @param index The index, as listed by @a AudioDeviceList()
+     */
+    virtual void AudioDeviceIndex(int index) = 0;
+
+    /**
+     * @brief Returns the currently used Audio device index.
+     * @return The index of the current audio device, as listed by @a AudioDeviceList()
+     */
+    virtual int AudioDeviceIndex() const = 0;
+
+    /**
+     * @brief Retrieves the current audio device name.
+     * @return The name of the currently selected audio recording device.
+     */
+    virtual std::string AudioDeviceName() const = 0;
+
+    /**
+     * @brief Asks the capture client to fill projectM's audio buffer for the next frame.
+     */
+    virtual void FillBuffer() = 0;
+
+    /**
+     * @brief Returns whether the audio source has no more data to deliver.
+     *
+     * Live devices never run out of data. Finite sources, e.g. a non-looping file, return true once all samples
+     * were passed to projectM.
+     *
+     * @return True if all audio data has been consumed.
+     */
+    virtual bool EndOfInput() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Called if SDL reports that an audio device was added.
+     * @param index SDL's index of the new device.
+     * @param isCapture True if the device is a recording device.
+     */
+    virtual void AudioDeviceAdded(POCO_UNUSED int index, POCO_UNUSED bool isCapture)
+    {
+    }
+
+    /**
+     * @brief Called if SDL reports that an opened audio device was removed.
+     * @param deviceId SDL's audio device ID of the removed device.
+     * @param isCapture True if the device is a recording device.
+     */
+    virtual void AudioDeviceRemoved(POCO_UNUSED uint32_t deviceId, POCO_UNUSED bool isCapture)
+    {
+    }
+};
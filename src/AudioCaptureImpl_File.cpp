@@ -0,0 +1,213 @@
+#include "AudioCaptureImpl_File.h"
+
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/Path.h>
+
+#include <Poco/Util/Application.h>
+
+#include <projectM-4/projectM.h>
+
+#include <algorithm>
+#include <cstring>
+
+AudioCaptureImpl_File::AudioCaptureImpl_File()
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _fileName = config.getString("audio.file", "");
+    _realtime = config.getBool("audio.file.realtime", true);
+    _loop = config.getBool("audio.file.loop", true);
+    _rawSampleRate = config.getUInt("audio.file.sampleRate", 44100);
+    _rawChannels = config.getUInt("audio.file.channels", 2);
+    _targetFps = config.getUInt("projectM.fps", 60);
+    _resamplerQuality = Resampler::QualityFromString(config.getString("audio.resamplerQuality", "medium"));
+
+    _deviceList = {{-1, AudioDeviceName()}};
+}
+
+AudioCaptureImpl_File::~AudioCaptureImpl_File()
+{
+    StopRecording();
+}
+
+const std::map<int, std::string>& AudioCaptureImpl_File::AudioDeviceList()
+{
+    return _deviceList;
+}
+
+void AudioCaptureImpl_File::StartRecording(projectm* projectMHandle, int)
+{
+    _projectMHandle = projectMHandle;
+
+    StopRecording();
+
+    try
+    {
+        Poco::File file(_fileName);
+        _mappedFile = std::make_unique<Poco::SharedMemory>(file, Poco::SharedMemory::AM_READ);
+        _decoder = AudioFileDecoder::Create(_mappedFile->begin(), file.getSize(), _rawSampleRate, _rawChannels);
+    }
+    catch (Poco::Exception& ex)
+    {
+        poco_error_f2(_logger, R"(Failed to open audio file "%s": %s)", _fileName, ex.displayText());
+        _decoder.reset();
+        _mappedFile.reset();
+        return;
+    }
+
+    // projectM only handles mono and stereo data, so multichannel files are downmixed to stereo.
+    _channels = std::min(_decoder->Channels(), 2U);
+    _sampleConverter.Configure(SampleConverter::Format::F32, _decoder->Channels());
+
+    _decodeBuffer.resize(_decodeBlockFrames * _decoder->Channels());
+    _downmixBuffer.resize(_decoder->Channels() > 2 ? _decodeBlockFrames * 2 : 0);
+    _pendingBuffer.clear();
+    _pendingFrames = 0;
+    _endOfFile = false;
+
+    _resampler.Configure(_decoder->SampleRate(), _projectMSampleFrequency, _channels, _resamplerQuality);
+
+    _framesPlayed = 0;
+    _fractionalFrames = 0.0;
+    _playbackStartTime.update();
+
+    poco_information_f4(_logger, R"(Playing %s audio file "%s" with %?u channels at %?u Hz.)",
+                        std::string(_decoder->FormatName()), _fileName, _decoder->Channels(), _decoder->SampleRate());
+    poco_information_f2(_logger, "Audio file playback is %s, looping is %s.",
+                        std::string(_realtime ? "paced in real time" : "paced by the target FPS"),
+                        std::string(_loop ? "enabled" : "disabled"));
+}
+
+void AudioCaptureImpl_File::StopRecording()
+{
+    if (_decoder)
+    {
+        _decoder.reset();
+        _mappedFile.reset();
+
+        poco_debug(_logger, "Stopped audio file playback.");
+    }
+}
+
+void AudioCaptureImpl_File::NextAudioDevice()
+{
+}
+
+void AudioCaptureImpl_File::AudioDeviceIndex(int)
+{
+}
+
+int AudioCaptureImpl_File::AudioDeviceIndex() const
+{
+    return -1;
+}
+
+std::string AudioCaptureImpl_File::AudioDeviceName() const
+{
+    return Poco::Path(_fileName).getFileName();
+}
+
+void AudioCaptureImpl_File::FillBuffer()
+{
+    if (!_decoder || _endOfFile)
+    {
+        return;
+    }
+
+    auto frames = FramesForCurrentFrame();
+    if (frames == 0)
+    {
+        return;
+    }
+
+    DecodeFrames(frames);
+
+    frames = std::min(frames, _pendingFrames);
+    if (frames == 0)
+    {
+        return;
+    }
+
+    // projectM only keeps the most recent samples, so anything beyond that is consumed, but not passed on.
+    auto maxFrames = static_cast<size_t>(projectm_pcm_get_max_samples());
+    size_t skippedFrames = frames > maxFrames ? frames - maxFrames : 0;
+
+    projectm_pcm_add_float(_projectMHandle, _pendingBuffer.data() + skippedFrames * _channels,
+                           static_cast<unsigned int>(frames - skippedFrames),
+                           static_cast<projectm_channels>(_channels));
+
+    _pendingFrames -= frames;
+    std::memmove(_pendingBuffer.data(), _pendingBuffer.data() + frames * _channels, _pendingFrames * _channels * sizeof(float));
+    _framesPlayed += frames;
+}
+
+bool AudioCaptureImpl_File::EndOfInput() const
+{
+    return _endOfFile && _pendingFrames == 0;
+}
+
+void AudioCaptureImpl_File::DecodeFrames(size_t frames)
+{
+    while (_pendingFrames < frames && !_endOfFile)
+    {
+        auto decodedFrames = _decoder->Decode(_decodeBuffer.data(), _decodeBlockFrames);
+        if (decodedFrames == 0)
+        {
+            if (!_loop)
+            {
+                poco_information_f1(_logger, R"(Reached end of audio file "%s".)", _fileName);
+                _endOfFile = true;
+                break;
+            }
+
+            _decoder->Rewind();
+            decodedFrames = _decoder->Decode(_decodeBuffer.data(), _decodeBlockFrames);
+            if (decodedFrames == 0)
+            {
+                poco_error_f1(_logger, R"(Audio file "%s" contains no audio data.)", _fileName);
+                _endOfFile = true;
+                break;
+            }
+        }
+
+        const float* converted = _decodeBuffer.data();
+        if (_decoder->Channels() > _channels)
+        {
+            _sampleConverter.Process(_decodeBuffer.data(), decodedFrames, _downmixBuffer.data());
+            converted = _downmixBuffer.data();
+        }
+
+        size_t convertedFrames = decodedFrames;
+        if (!_resampler.Passthrough())
+        {
+            convertedFrames = _resampler.Process(converted, decodedFrames, _resampledBuffer);
+            converted = _resampledBuffer.data();
+        }
+
+        _pendingBuffer.resize((_pendingFrames + convertedFrames) * _channels);
+        std::memcpy(_pendingBuffer.data() + _pendingFrames * _channels, converted, convertedFrames * _channels * sizeof(float));
+        _pendingFrames += convertedFrames;
+    }
+}
+
+size_t AudioCaptureImpl_File::FramesForCurrentFrame()
+{
+    size_t frames{0};
+
+    if (_realtime)
+    {
+        // Derive the position from the total elapsed time, so rounding errors can't accumulate.
+        auto targetFrames = static_cast<uint64_t>(_playbackStartTime.elapsed()) * _projectMSampleFrequency / 1000000;
+        frames = static_cast<size_t>(targetFrames - std::min(targetFrames, _framesPlayed));
+    }
+    else
+    {
+        // Unlimited FPS has no fixed frame duration, so assume 60 FPS in this case.
+        double framesPerFrame = static_cast<double>(_projectMSampleFrequency) / (_targetFps > 0 ? _targetFps : 60);
+        _fractionalFrames += framesPerFrame;
+        frames = static_cast<size_t>(_fractionalFrames);
+        _fractionalFrames -= static_cast<double>(frames);
+    }
+
+    return frames;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "AudioCaptureImpl.h"
+#include "AudioFileDecoder.h"
+#include "Resampler.h"
+#include "SampleConverter.h"
+
+#include <Poco/Clock.h>
+#include <Poco/Logger.h>
+#include <Poco/SharedMemory.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Audio "capturing" from a WAV, FLAC or raw float PCM file.
+ *
+ * Plays back the file set in audio.file instead of recording from a live device, so preset performance can be
+ * measured against the exact same audio data in every run. The file is memory-mapped and decoded incrementally,
+ * then converted to projectM's sample rate.
+ *
+ * Each call to FillBuffer() passes exactly one frame's worth of samples to projectM. In real-time mode, the amount is
+ * based on the elapsed wall clock time, so playback runs at the original speed regardless of the actual frame rate.
+ * Otherwise, each frame receives the sample count for the configured target FPS, making the audio data seen by any
+ * given frame independent of rendering performance.
+ */
+class AudioCaptureImpl_File : public AudioCaptureImpl
+{
+public:
+    AudioCaptureImpl_File();
+
+    ~AudioCaptureImpl_File() override;
+
+    /**
+     * @brief Returns a "device" list containing only the audio file.
+     * @return A map with a single entry with index -1 and the file name.
+     */
+    const std::map<int, std::string>& AudioDeviceList() override;
+
+    /**
+     * @brief Opens the audio file and starts playback.
+     * @param projectMHandle projectM instance handle that will receive the audio data.
+     * @param audioDeviceIndex Ignored.
+     */
+    void StartRecording(projectm* projectMHandle, int audioDeviceIndex) override;
+
+    /**
+     * @brief Stops playback and closes the audio file.
+     */
+    void StopRecording() override;
+
+    /**
+     * @brief Does nothing, as there's only a single input.
+     */
+    void NextAudioDevice() override;
+
+    /**
+     * @brief Does nothing, as there's only a single input.
+     * @param index Ignored.
+     */
+    void AudioDeviceIndex(int index) override;
+
+    /**
+     * @brief Returns the index of the audio file "device".
+     * @return Always -1.
+     */
+    int AudioDeviceIndex() const override;
+
+    /**
+     * @brief Returns the name of the file being played.
+     * @return The file name, without the path.
+     */
+    std::string AudioDeviceName() const override;
+
+    /**
+     * @brief Decodes the samples for the next frame and passes them to projectM.
+     */
+    void FillBuffer() override;
+
+    /**
+     * @brief Returns true if looping is disabled and all samples of the file were passed to projectM.
+     * @return True if playback has finished.
+     */
+    bool EndOfInput() const override;
+
+protected:
+    /**
+     * @brief Decodes and resamples audio data until at least the given number of frames is pending.
+     * @param frames The number of output frames required.
+     */
+    void DecodeFrames(size_t frames);
+
+    /**
+     * @brief Calculates the number of output frames to pass to projectM in the current frame.
+     * @return The number of sample frames at projectM's sample rate.
+     */
+    size_t FramesForCurrentFrame();
+
+    std::string _fileName; //!< Full path of the audio file.
+    std::map<int, std::string> _deviceList; //!< The "device" list with a single entry.
+    bool _realtime{true}; //!< If true, audio data is paced by the wall clock, otherwise by the target FPS.
+    bool _loop{true}; //!< If true, playback restarts at the beginning of the file when reaching the end.
+    uint32_t _rawSampleRate{44100}; //!< Sample rate assumed for headerless files.
+    uint32_t _rawChannels{2}; //!< Channel count assumed for headerless files.
+    uint32_t _targetFps{60}; //!< Configured target FPS, used to determine the samples per frame if not in real-time mode.
+
+    projectm* _projectMHandle{nullptr}; //!< Handle if the projectM instance that will receive the audio data.
+
+    std::unique_ptr<Poco::SharedMemory> _mappedFile; //!< The memory-mapped audio file.
+    std::unique_ptr<AudioFileDecoder> _decoder; //!< The decoder for the audio file's format.
+    bool _endOfFile{false}; //!< True if the end of the file was reached and looping is disabled.
+
+    uint32_t _channels{2}; //!< Number of channels passed to projectM, either 1 or 2. Multichannel files are downmixed.
+    std::vector<float> _decodeBuffer; //!< Decoded samples in the file's sample rate and channel layout.
+    std::vector<float> _downmixBuffer; //!< Decoded samples downmixed to stereo, only used for multichannel files.
+    SampleConverter _sampleConverter; //!< Downmixes multichannel files to stereo.
+    std::vector<float> _resampledBuffer; //!< Resampler output.
+    std::vector<float> _pendingBuffer; //!< Converted samples not yet passed to projectM.
+    size_t _pendingFrames{0}; //!< Number of frames in the pending buffer.
+    Resampler _resampler; //!< Converts the file's sample rate to the rate projectM expects.
+    Resampler::Quality _resamplerQuality{Resampler::Quality::Medium}; //!< User-configured resampler quality.
+
+    Poco::Clock _playbackStartTime; //!< Time playback was started, used in real-time mode.
+    uint64_t _framesPlayed{0}; //!< Total number of output frames passed to projectM since playback was started.
+    double _fractionalFrames{0.0}; //!< Accumulated sub-sample remainder of the per-frame sample count.
+
+    constexpr static uint32_t _projectMSampleFrequency{44100}; //!< Sample frequency passed to projectM.
+    constexpr static size_t _decodeBlockFrames{1024}; //!< Number of frames decoded at once.
+
+    Poco::Logger& _logger{Poco::Logger::get("AudioCapture.File")}; //!< The class logger.
+};
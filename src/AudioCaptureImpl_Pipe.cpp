@@ -0,0 +1,191 @@
+#include "AudioCaptureImpl_Pipe.h"
+
+#include <Poco/Util/Application.h>
+
+#include <projectM-4/projectM.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+Poco::Logger& AudioCaptureImpl_Pipe::_logger{Poco::Logger::get("AudioCapture.Pipe")};
+
+AudioCaptureImpl_Pipe::AudioCaptureImpl_Pipe()
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _pipeName = config.getString("audio.pipe", "-");
+    _sampleFrequency = config.getUInt("audio.pipe.sampleRate", 44100);
+    _sampleFormat = SampleConverter::FormatFromString(config.getString("audio.pipe.format", "f32"));
+    _inputChannels = std::max(1U, config.getUInt("audio.pipe.channels", 2));
+    _channels = std::min(_inputChannels, 2U);
+    _resamplerQuality = Resampler::QualityFromString(config.getString("audio.resamplerQuality", "medium"));
+
+    if (_pipeName.empty())
+    {
+        _pipeName = "-";
+    }
+
+    _deviceList = {{-1, AudioDeviceName()}};
+}
+
+AudioCaptureImpl_Pipe::~AudioCaptureImpl_Pipe()
+{
+    StopRecording();
+}
+
+const std::map<int, std::string>& AudioCaptureImpl_Pipe::AudioDeviceList()
+{
+    return _deviceList;
+}
+
+void AudioCaptureImpl_Pipe::StartRecording(projectm* projectMHandle, int)
+{
+    StopRecording();
+
+    _projectMHandle = projectMHandle;
+
+    _readerState = std::make_shared<ReaderState>();
+    _readerState->pipeName = _pipeName;
+    _readerState->channels = _channels;
+    _readerState->sampleFormat = _sampleFormat;
+    _readerState->bytesPerFrame = SampleConverter::BytesPerSample(_sampleFormat) * _inputChannels;
+    _readerState->converter.Configure(_sampleFormat, _inputChannels);
+    _readerState->ringBuffer.Resize(static_cast<size_t>(_sampleFrequency) * _channels / 2);
+
+    size_t maxInputFrames = static_cast<size_t>(projectm_pcm_get_max_samples()) * _sampleFrequency / _projectMSampleFrequency + 1;
+    _transferBuffer.resize(maxInputFrames * _channels);
+
+    _resampler.Configure(_sampleFrequency, _projectMSampleFrequency, _channels, _resamplerQuality);
+
+    std::thread(&AudioCaptureImpl_Pipe::ReaderThread, _readerState).detach();
+
+    poco_information_f3(_logger, R"(Reading audio data from "%s" with %?u channels at %?u Hz.)",
+                        AudioDeviceName(), _inputChannels, _sampleFrequency);
+}
+
+void AudioCaptureImpl_Pipe::StopRecording()
+{
+    if (_readerState)
+    {
+        _readerState->stop = true;
+        _readerState.reset();
+
+        poco_debug(_logger, "Stopped reading audio data.");
+    }
+}
+
+void AudioCaptureImpl_Pipe::NextAudioDevice()
+{
+}
+
+void AudioCaptureImpl_Pipe::AudioDeviceIndex(int)
+{
+}
+
+int AudioCaptureImpl_Pipe::AudioDeviceIndex() const
+{
+    return -1;
+}
+
+std::string AudioCaptureImpl_Pipe::AudioDeviceName() const
+{
+    return _pipeName == "-" ? "Standard input" : _pipeName;
+}
+
+void AudioCaptureImpl_Pipe::FillBuffer()
+{
+    if (!_readerState)
+    {
+        return;
+    }
+
+    auto& ringBuffer = _readerState->ringBuffer;
+
+    // projectM only keeps the most recent samples, so anything beyond that can be skipped right away.
+    size_t maxSamples = _transferBuffer.size();
+    size_t availableSamples = ringBuffer.Available();
+    if (availableSamples > maxSamples)
+    {
+        ringBuffer.Discard(availableSamples - maxSamples);
+    }
+
+    size_t samplesRead = ringBuffer.Read(_transferBuffer.data(), maxSamples);
+    if (samplesRead == 0)
+    {
+        return;
+    }
+
+    if (_resampler.Passthrough())
+    {
+        projectm_pcm_add_float(_projectMHandle, _transferBuffer.data(), samplesRead / _channels,
+                               static_cast<projectm_channels>(_channels));
+        return;
+    }
+
+    auto outputFrames = _resampler.Process(_transferBuffer.data(), samplesRead / _channels, _resampledBuffer);
+    if (outputFrames > 0)
+    {
+        projectm_pcm_add_float(_projectMHandle, _resampledBuffer.data(), static_cast<unsigned int>(outputFrames),
+                               static_cast<projectm_channels>(_channels));
+    }
+}
+
+void AudioCaptureImpl_Pipe::ReaderThread(std::shared_ptr<ReaderState> state)
+{
+    FILE* pipe{nullptr};
+    if (state->pipeName == "-")
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        pipe = stdin;
+    }
+    else
+    {
+        // Opening a named pipe blocks until a writer connects.
+        pipe = std::fopen(state->pipeName.c_str(), "rb");
+    }
+
+    if (pipe == nullptr)
+    {
+        poco_error_f1(_logger, R"(Could not open audio pipe "%s".)", state->pipeName);
+        return;
+    }
+
+    // About 10 ms at 48 kHz, which keeps latency low while not waking up too often.
+    constexpr size_t chunkFrames{512};
+    std::vector<char> buffer(chunkFrames * state->bytesPerFrame);
+    std::vector<float> convertedBuffer(chunkFrames * 2);
+
+    while (!state->stop)
+    {
+        auto framesRead = std::fread(buffer.data(), state->bytesPerFrame, chunkFrames, pipe);
+        if (framesRead == 0)
+        {
+            poco_information(_logger, "Reached end of audio pipe input.");
+            break;
+        }
+
+        // Mono data is passed through as-is, everything else is converted to stereo.
+        if (state->channels == 1)
+        {
+            SampleConverter::ConvertToFloat(state->sampleFormat, buffer.data(), framesRead, convertedBuffer.data());
+        }
+        else
+        {
+            state->converter.Process(buffer.data(), framesRead, convertedBuffer.data());
+        }
+
+        // If the render thread can't keep up, the data is dropped.
+        state->ringBuffer.Write(convertedBuffer.data(), framesRead * state->channels);
+    }
+
+    if (pipe != stdin)
+    {
+        std::fclose(pipe);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AudioCaptureImpl.h"
+#include "AudioRingBuffer.h"
+#include "Resampler.h"
+#include "SampleConverter.h"
+
+#include <Poco/Logger.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Reads raw audio data from standard input or a named pipe.
+ *
+ * Expects headerless, interleaved PCM data in native byte order, e.g. from "parec --format=float32le" or
+ * "ffmpeg -f f32le -". Sample format, rate and channel count are taken from the configuration. The reader thread
+ * converts the data to float and downmixes more than two channels to stereo.
+ *
+ * A background thread reads the data into a ring buffer, which is drained on the render thread like captured
+ * device data.
+ */
+class AudioCaptureImpl_Pipe : public AudioCaptureImpl
+{
+public:
+    AudioCaptureImpl_Pipe();
+
+    ~AudioCaptureImpl_Pipe() override;
+
+    const std::map<int, std::string>& AudioDeviceList() override;
+
+    void StartRecording(projectm* projectMHandle, int audioDeviceIndex) override;
+
+    void StopRecording() override;
+
+    void NextAudioDevice() override;
+
+    void AudioDeviceIndex(int index) override;
+
+    int AudioDeviceIndex() const override;
+
+    std::string AudioDeviceName() const override;
+
+    void FillBuffer() override;
+
+protected:
+    /**
+     * @brief State shared with the reader thread.
+     *
+     * Reading from a pipe may block indefinitely, so the thread can't always be joined when stopping. Instead, it's
+     * detached and keeps the shared state alive until the blocking read returns.
+     */
+    struct ReaderState
+    {
+        std::string pipeName; //!< File name of the pipe, or "-" for standard input.
+        SampleConverter::Format sampleFormat{SampleConverter::Format::F32}; //!< Sample format of the incoming data.
+        size_t bytesPerFrame{8}; //!< Size of one sample frame in the incoming data.
+        uint32_t channels{2}; //!< Number of interleaved channels after conversion, either 1 or 2.
+        SampleConverter converter; //!< Converts the incoming data to float and downmixes it.
+        AudioRingBuffer ringBuffer; //!< Samples read from the pipe, not yet passed to projectM.
+        std::atomic_bool stop{false}; //!< If true, the reader thread exits after the current read.
+    };
+
+    /**
+     * @brief Reader thread function.
+     * @param state The shared reader state.
+     */
+    static void ReaderThread(std::shared_ptr<ReaderState> state);
+
+    std::string _pipeName{"-"}; //!< File name of the pipe, or "-" for standard input.
+    std::map<int, std::string> _deviceList; //!< The "device" list with a single entry.
+    uint32_t _sampleFrequency{44100}; //!< Sample rate of the incoming data.
+    SampleConverter::Format _sampleFormat{SampleConverter::Format::F32}; //!< Sample format of the incoming data.
+    uint32_t _inputChannels{2}; //!< Number of interleaved channels in the incoming data.
+    uint32_t _channels{2}; //!< Number of channels passed to projectM, either 1 or 2.
+
+    projectm* _projectMHandle{nullptr}; //!< Handle if the projectM instance that will receive the audio data.
+    std::shared_ptr<ReaderState> _readerState; //!< State shared with the reader thread, if running.
+
+    std::vector<float> _transferBuffer; //!< Buffer used to pass samples from the ring buffer to the resampler.
+    std::vector<float> _resampledBuffer; //!< Resampler output which is passed to projectM.
+    Resampler _resampler; //!< Converts the input sample rate to the rate projectM expects.
+    Resampler::Quality _resamplerQuality{Resampler::Quality::Medium}; //!< User-configured resampler quality.
+
+    constexpr static uint32_t _projectMSampleFrequency{44100}; //!< Sample frequency passed to projectM.
+
+    static Poco::Logger& _logger; //!< The class logger, also used in the reader thread.
+};
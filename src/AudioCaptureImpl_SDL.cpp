@@ -4,156 +4,450 @@
 
 #include <projectM-4/projectM.h>
 
-AudioCaptureImpl::AudioCaptureImpl()
-    : _requestedSampleCount(projectm_pcm_get_max_samples())
+constexpr char AudioCaptureImpl_SDL::_defaultDeviceName[];
+
+AudioCaptureImpl_SDL::AudioCaptureImpl_SDL()
+    : _deviceSwitchThread(this, &AudioCaptureImpl_SDL::DeviceSwitchThread)
 {
-    auto targetFps = Poco::Util::Application::instance().config().getUInt("projectM.fps", 60);
-    if (targetFps > 0)
-    {
-        _requestedSampleCount = std::min(_requestedSampleFrequency / targetFps, _requestedSampleCount);
-        // Don't let the buffer get too small to prevent excessive updates calls.
-        // 300 samples is enough for 144 FPS.
-        _requestedSampleCount = std::max(_requestedSampleCount, 300U);
-    }
+    auto& config = Poco::Util::Application::instance().config();
+    _targetFps = config.getUInt("projectM.fps", 60);
+    _resamplerQuality = Resampler::QualityFromString(config.getString("audio.resamplerQuality", "medium"));
 
 #ifdef SDL_HINT_AUDIO_INCLUDE_MONITORS
     SDL_SetHint(SDL_HINT_AUDIO_INCLUDE_MONITORS, "1");
 #endif
     SDL_InitSubSystem(SDL_INIT_AUDIO);
+
+    UpdateDeviceList();
 }
 
-AudioCaptureImpl::~AudioCaptureImpl()
+AudioCaptureImpl_SDL::~AudioCaptureImpl_SDL()
 {
+    StopRecording();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
 
-std::map<int, std::string> AudioCaptureImpl::AudioDeviceList()
+const std::map<int, std::string>& AudioCaptureImpl_SDL::AudioDeviceList()
 {
-    std::map<int, std::string> deviceList{
-        {-1, "Default capturing device"}};
+    return _deviceList;
+}
 
-    auto recordingDeviceCount = SDL_GetNumAudioDevices(true);
+void AudioCaptureImpl_SDL::AudioDeviceAdded(int index, bool isCapture)
+{
+    if (!isCapture)
+    {
+        return;
+    }
 
-    for (int i = 0; i < recordingDeviceCount; i++)
+    auto deviceName = SDL_GetAudioDeviceName(index, true);
+    if (deviceName == nullptr)
     {
-        auto deviceName = SDL_GetAudioDeviceName(i, true);
-        if (deviceName)
-        {
-            deviceList.insert(std::make_pair(i, deviceName));
-        }
-        else
-        {
-            poco_error_f2(_logger, "Could not get device name for device ID %d: %s", i, std::string(SDL_GetError()));
-        }
+        return;
     }
 
-    return deviceList;
+    // SDL also reports all devices present at startup, which are already known.
+    auto deviceId = DeviceIdForName(deviceName);
+    if (_deviceList.find(deviceId) == _deviceList.end())
+    {
+        _deviceList.insert(std::make_pair(deviceId, deviceName));
+        poco_information_f2(_logger, R"(Audio recording device "%s" (ID %?d) was added.)", std::string(deviceName), deviceId);
+    }
 }
 
-void AudioCaptureImpl::StartRecording(projectm* projectMHandle, int audioDeviceIndex)
+void AudioCaptureImpl_SDL::AudioDeviceRemoved(uint32_t deviceId, bool isCapture)
 {
-    _projectMHandle = projectMHandle;
-    _currentAudioDeviceIndex = audioDeviceIndex;
+    if (!isCapture)
+    {
+        return;
+    }
+
+    // SDL only reports removed devices if they're opened, so any other removed devices are only found
+    // by enumerating all devices again.
+    UpdateDeviceList();
 
-    if (OpenAudioDevice())
+    auto stream = std::atomic_load(&_stream);
+    bool currentDeviceRemoved = stream && stream->deviceId == deviceId;
+    if (_currentAudioDeviceIndex >= 0 && _deviceList.find(_currentAudioDeviceIndex) == _deviceList.end())
     {
-        SDL_PauseAudioDevice(_currentAudioDeviceID, false);
+        currentDeviceRemoved = true;
+    }
 
-        poco_debug(_logger, "Started audio recording.");
+    if (currentDeviceRemoved)
+    {
+        poco_warning_f1(_logger, "Audio recording device with ID %?d was removed, switching to default device.",
+                        static_cast<int>(_currentAudioDeviceIndex));
+        RequestAudioDevice(-1);
     }
 }
 
-void AudioCaptureImpl::StopRecording()
+void AudioCaptureImpl_SDL::StartRecording(projectm* projectMHandle, int audioDeviceIndex)
 {
-    if (_currentAudioDeviceID)
+    _projectMHandle = projectMHandle;
+
+    if (!_deviceSwitchThreadRunning)
     {
-        SDL_PauseAudioDevice(_currentAudioDeviceID, true);
-        SDL_CloseAudioDevice(_currentAudioDeviceID);
-        _currentAudioDeviceID = 0;
+        _deviceSwitchThreadRunning = true;
+        _deviceSwitchThreadResult = _deviceSwitchThread();
+    }
+
+    RequestAudioDevice(audioDeviceIndex);
+}
+
+void AudioCaptureImpl_SDL::StopRecording()
+{
+    if (_deviceSwitchThreadRunning)
+    {
+        _deviceSwitchThreadRunning = false;
+        _deviceSwitchEvent.set();
+        _deviceSwitchThreadResult.wait();
+    }
+
+    auto stream = std::atomic_exchange(&_stream, std::shared_ptr<CaptureStream>());
+    if (stream)
+    {
+        CloseAudioDevice(stream);
 
         poco_debug(_logger, "Stopped audio recording and closed device.");
     }
 }
 
-void AudioCaptureImpl::NextAudioDevice()
+void AudioCaptureImpl_SDL::NextAudioDevice()
 {
-    StopRecording();
-
-    // Will wrap around to default capture device (-1).
-    int nextAudioDeviceId = ((_currentAudioDeviceIndex + 2) % (SDL_GetNumAudioDevices(true) + 1)) - 1;
+    // Will wrap around to default capture device (-1), which is always the first entry.
+    auto nextDevice = _deviceList.upper_bound(_currentAudioDeviceIndex);
+    if (nextDevice == _deviceList.end())
+    {
+        nextDevice = _deviceList.begin();
+    }
 
-    StartRecording(_projectMHandle, nextAudioDeviceId);
+    RequestAudioDevice(nextDevice->first);
 }
 
-void AudioCaptureImpl::AudioDeviceIndex(int index)
+void AudioCaptureImpl_SDL::AudioDeviceIndex(int index)
 {
-    if (index >= -1 && index < SDL_GetNumAudioDevices(true))
+    if (_deviceList.find(index) != _deviceList.end())
     {
-        _currentAudioDeviceIndex = index;
-        StartRecording(_projectMHandle, index);
+        RequestAudioDevice(index);
     }
 }
 
-int AudioCaptureImpl::AudioDeviceIndex() const
+int AudioCaptureImpl_SDL::AudioDeviceIndex() const
 {
     return _currentAudioDeviceIndex;
 }
 
-std::string AudioCaptureImpl::AudioDeviceName() const
+std::string AudioCaptureImpl_SDL::AudioDeviceName() const
 {
-    if (_currentAudioDeviceIndex >= 0)
+    auto device = _deviceList.find(_currentAudioDeviceIndex);
+    if (device != _deviceList.end())
+    {
+        return device->second;
+    }
+
+    return _defaultDeviceName;
+}
+
+void AudioCaptureImpl_SDL::FillBuffer()
+{
+    // Keep a reference, so the stream can't be destroyed while in use if the device is switched in the meantime.
+    auto stream = std::atomic_load(&_stream);
+    if (!stream || stream->channels == 0)
+    {
+        return;
+    }
+
+    // projectM only keeps the most recent samples, so anything beyond that can be skipped right away.
+    size_t maxSamples = stream->transferBuffer.size();
+    size_t availableSamples = stream->ringBuffer.Available();
+    if (availableSamples > maxSamples)
+    {
+        stream->ringBuffer.Discard(availableSamples - maxSamples);
+    }
+
+    size_t samplesRead = stream->ringBuffer.Read(stream->transferBuffer.data(), maxSamples);
+    if (samplesRead == 0)
+    {
+        return;
+    }
+
+    if (stream->resampler.Passthrough())
     {
-        return SDL_GetAudioDeviceName(_currentAudioDeviceIndex, true);
+        projectm_pcm_add_float(_projectMHandle, stream->transferBuffer.data(), samplesRead / stream->channels,
+                               static_cast<projectm_channels>(stream->channels));
+        return;
     }
-    else
+
+    auto outputFrames = stream->resampler.Process(stream->transferBuffer.data(), samplesRead / stream->channels, stream->resampledBuffer);
+    if (outputFrames > 0)
+    {
+        projectm_pcm_add_float(_projectMHandle, stream->resampledBuffer.data(), static_cast<unsigned int>(outputFrames),
+                               static_cast<projectm_channels>(stream->channels));
+    }
+}
+
+void AudioCaptureImpl_SDL::RequestAudioDevice(int index)
+{
+    // Report the new device right away, so the UI reflects the user's choice while the device is being opened.
+    _currentAudioDeviceIndex = index;
+
     {
-        return "Default capturing device";
+        std::lock_guard<std::mutex> lock(_deviceSwitchRequestMutex);
+        _requestedAudioDeviceIndex = index;
+        _requestedAudioDeviceName = index >= 0 ? _deviceList.at(index) : std::string();
     }
+
+    _deviceSwitchRequested = true;
+    _deviceSwitchEvent.set();
 }
 
-bool AudioCaptureImpl::OpenAudioDevice()
+void AudioCaptureImpl_SDL::UpdateDeviceList()
 {
+    _deviceList = {{-1, _defaultDeviceName}};
+
+    auto recordingDeviceCount = SDL_GetNumAudioDevices(true);
+
+    for (int i = 0; i < recordingDeviceCount; i++)
+    {
+        auto deviceName = SDL_GetAudioDeviceName(i, true);
+        if (deviceName)
+        {
+            _deviceList.insert(std::make_pair(DeviceIdForName(deviceName), deviceName));
+        }
+        else
+        {
+            poco_error_f2(_logger, "Could not get device name for device ID %d: %s", i, std::string(SDL_GetError()));
+        }
+    }
+}
+
+int AudioCaptureImpl_SDL::DeviceIdForName(const std::string& deviceName)
+{
+    auto knownDevice = _deviceIds.find(deviceName);
+    if (knownDevice != _deviceIds.end())
+    {
+        return knownDevice->second;
+    }
+
+    int deviceId = _nextDeviceId++;
+    _deviceIds.insert(std::make_pair(deviceName, deviceId));
+
+    return deviceId;
+}
+
+void AudioCaptureImpl_SDL::DeviceSwitchThread()
+{
+    poco_debug(_logger, "Audio device switch thread started.");
+
+    while (_deviceSwitchThreadRunning)
+    {
+        _deviceSwitchEvent.wait();
+
+        // Multiple requests made while a device was being opened are coalesced, only the last one is executed.
+        while (_deviceSwitchThreadRunning && _deviceSwitchRequested.exchange(false))
+        {
+            int index;
+            std::string deviceName;
+            {
+                std::lock_guard<std::mutex> lock(_deviceSwitchRequestMutex);
+                index = _requestedAudioDeviceIndex;
+                deviceName = _requestedAudioDeviceName;
+            }
+
+            auto newStream = OpenAudioDevice(index, deviceName);
+            if (!newStream)
+            {
+                // Keep the previous device running and report it as current again, unless another switch is pending.
+                auto currentStream = std::atomic_load(&_stream);
+                if (currentStream && !_deviceSwitchRequested)
+                {
+                    _currentAudioDeviceIndex = currentStream->deviceIndex;
+                }
+                continue;
+            }
+
+            // Start capturing before the old device is closed, so the render thread never runs out of data.
+            SDL_PauseAudioDevice(newStream->deviceId, false);
+
+            auto oldStream = std::atomic_exchange(&_stream, newStream);
+            CloseAudioDevice(oldStream);
+
+            poco_debug(_logger, "Started audio recording.");
+        }
+    }
+
+    poco_debug(_logger, "Audio device switch thread exited.");
+}
+
+std::shared_ptr<AudioCaptureImpl_SDL::CaptureStream> AudioCaptureImpl_SDL::OpenAudioDevice(int index, const std::string& deviceName)
+{
+    auto stream = std::make_shared<CaptureStream>();
+    stream->deviceIndex = index;
+
     SDL_AudioSpec requestedSpecs{};
     SDL_AudioSpec actualSpecs{};
 
-    requestedSpecs.freq = _requestedSampleFrequency;
-    requestedSpecs.format = AUDIO_F32;
-    requestedSpecs.channels = 2;
-    requestedSpecs.samples = _requestedSampleCount;
-    requestedSpecs.callback = AudioCaptureImpl::AudioInputCallback;
-    requestedSpecs.userdata = this;
+    // Capture at the device's native rate, format and channel count, so SDL doesn't need to convert anything inside
+    // the audio callback. Our own converter downmixes the data to stereo, and the resampler converts the sample rate
+    // on the render thread.
+    auto nativeSpecs = NativeAudioSpec(deviceName);
+
+    auto requestedSampleCount = projectm_pcm_get_max_samples();
+    if (_targetFps > 0)
+    {
+        requestedSampleCount = std::min(static_cast<uint32_t>(nativeSpecs.freq) / _targetFps, requestedSampleCount);
+        // Don't let the buffer get too small to prevent excessive updates calls.
+        // 300 samples is enough for 144 FPS.
+        requestedSampleCount = std::max(requestedSampleCount, 300U);
+    }
+
+    requestedSpecs.freq = nativeSpecs.freq;
+    requestedSpecs.format = nativeSpecs.format;
+    requestedSpecs.channels = nativeSpecs.channels;
+    requestedSpecs.samples = static_cast<Uint16>(requestedSampleCount);
+    requestedSpecs.callback = AudioCaptureImpl_SDL::AudioInputCallback;
+    requestedSpecs.userdata = stream.get();
+
+    // Devices are opened by name, as SDL's device indices change if devices are added or removed.
+    // Passing NULL automatically selects the default device.
+    std::string displayName = !deviceName.empty() ? deviceName : "System default capturing device";
+    const char* sdlDeviceName = !deviceName.empty() ? deviceName.c_str() : nullptr;
+
+    // The device stays paused until the stream is fully set up, so the audio callback can't access it yet.
+    stream->deviceId = SDL_OpenAudioDevice(sdlDeviceName, true, &requestedSpecs, &actualSpecs,
+                                           SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_FORMAT_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+
+    SampleConverter::Format converterFormat{SampleConverter::Format::F32};
+    if (stream->deviceId != 0 && !ConverterFormat(actualSpecs.format, converterFormat))
+    {
+        // Formats like unsigned or byte-swapped samples are rare. Let SDL convert those to float.
+        poco_debug_f1(_logger, "Device sample format 0x%?x not supported natively, reopening as float.", static_cast<int>(actualSpecs.format));
+
+        SDL_CloseAudioDevice(stream->deviceId);
 
-    // Will be NULL on error, which happens if the requested index is -1. This automatically selects the default device.
-    auto deviceName = SDL_GetAudioDeviceName(_currentAudioDeviceIndex, true);
-    _currentAudioDeviceID = SDL_OpenAudioDevice(deviceName, true, &requestedSpecs, &actualSpecs, 0);
+        requestedSpecs.format = AUDIO_F32SYS;
+        converterFormat = SampleConverter::Format::F32;
+        stream->deviceId = SDL_OpenAudioDevice(sdlDeviceName, true, &requestedSpecs, &actualSpecs,
+                                               SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    }
 
-    if (_currentAudioDeviceID == 0)
+    if (stream->deviceId == 0)
     {
         poco_error_f3(_logger, R"(Failed to open audio device "%s" (ID %?d): %s)",
-                      std::string(deviceName != nullptr ? deviceName : "System default capturing device"),
-                      _currentAudioDeviceIndex,
-                      std::string(SDL_GetError()));
-        return false;
+                      displayName, index, std::string(SDL_GetError()));
+        return {};
     }
 
-    _channels = actualSpecs.channels;
+    stream->converter.Configure(converterFormat, actualSpecs.channels);
+    stream->bytesPerFrame = SampleConverter::BytesPerSample(converterFormat) * actualSpecs.channels;
+    stream->callbackBuffer.resize(static_cast<size_t>(std::max<Uint16>(actualSpecs.samples, 1)) * 2);
+
+    // All data is downmixed to stereo in the audio callback.
+    stream->channels = 2;
+    stream->sampleFrequency = actualSpecs.freq;
+
+    // Keep about half a second of audio, which is plenty even if a few frames take longer to render.
+    stream->ringBuffer.Resize(static_cast<size_t>(stream->sampleFrequency) * stream->channels / 2);
+
+    // Enough input samples to produce projectM's maximum sample count after conversion.
+    size_t maxInputFrames = static_cast<size_t>(projectm_pcm_get_max_samples()) * stream->sampleFrequency / _projectMSampleFrequency + 1;
+    stream->transferBuffer.resize(maxInputFrames * stream->channels);
+
+    stream->resampler.Configure(stream->sampleFrequency, _projectMSampleFrequency, stream->channels, _resamplerQuality);
 
     poco_information_f4(_logger, R"(Opened audio recording device "%s" (ID %?d) with %?d channels at %?d Hz.)",
-                        std::string(deviceName != nullptr ? deviceName : "System default capturing device"),
-                        _currentAudioDeviceIndex,
-                        actualSpecs.channels,
+                        displayName,
+                        index,
+                        static_cast<int>(actualSpecs.channels),
                         actualSpecs.freq);
 
-    return true;
+    return stream;
+}
+
+void AudioCaptureImpl_SDL::CloseAudioDevice(const std::shared_ptr<CaptureStream>& stream)
+{
+    if (stream && stream->deviceId != 0)
+    {
+        // Closing waits for a running audio callback to return, so the stream isn't accessed afterwards.
+        SDL_PauseAudioDevice(stream->deviceId, true);
+        SDL_CloseAudioDevice(stream->deviceId);
+        stream->deviceId = 0;
+    }
+}
+
+SDL_AudioSpec AudioCaptureImpl_SDL::NativeAudioSpec(const std::string& deviceName) const
+{
+    SDL_AudioSpec fallbackSpecs{};
+    fallbackSpecs.freq = static_cast<int>(_projectMSampleFrequency);
+    fallbackSpecs.format = AUDIO_F32SYS;
+    fallbackSpecs.channels = 2;
+
+    SDL_AudioSpec nativeSpecs{};
+
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+    if (deviceName.empty() && SDL_GetDefaultAudioInfo(nullptr, &nativeSpecs, true) == 0 && nativeSpecs.freq > 0)
+    {
+        return nativeSpecs;
+    }
+#endif
+
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+    auto recordingDeviceCount = SDL_GetNumAudioDevices(true);
+    for (int i = 0; i < recordingDeviceCount && !deviceName.empty(); i++)
+    {
+        auto name = SDL_GetAudioDeviceName(i, true);
+        if (name != nullptr && deviceName == name && SDL_GetAudioDeviceSpec(i, true, &nativeSpecs) == 0 && nativeSpecs.freq > 0)
+        {
+            if (nativeSpecs.channels == 0)
+            {
+                nativeSpecs.channels = fallbackSpecs.channels;
+            }
+            if (nativeSpecs.format == 0)
+            {
+                nativeSpecs.format = fallbackSpecs.format;
+            }
+            return nativeSpecs;
+        }
+    }
+#endif
+
+    return fallbackSpecs;
 }
 
-void AudioCaptureImpl::AudioInputCallback(void* userData, unsigned char* stream, int len)
+bool AudioCaptureImpl_SDL::ConverterFormat(SDL_AudioFormat format, SampleConverter::Format& converterFormat)
+{
+    switch (format)
+    {
+        case AUDIO_S16SYS:
+            converterFormat = SampleConverter::Format::S16;
+            return true;
+
+        case AUDIO_S32SYS:
+            converterFormat = SampleConverter::Format::S32;
+            return true;
+
+        case AUDIO_F32SYS:
+            converterFormat = SampleConverter::Format::F32;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void AudioCaptureImpl_SDL::AudioInputCallback(void* userData, unsigned char* stream, int len)
 {
     poco_assert_dbg(userData);
-    auto instance = reinterpret_cast<AudioCaptureImpl*>(userData);
+    auto captureStream = reinterpret_cast<CaptureStream*>(userData);
 
-    unsigned int samples = len / sizeof(float) / instance->_channels;
+    // If the render thread can't keep up, the ring buffer is full and this data is dropped.
+    // Nothing here may block, lock or allocate.
+    size_t frames = static_cast<size_t>(len) / captureStream->bytesPerFrame;
+    size_t maxFrames = captureStream->callbackBuffer.size() / 2;
 
-    projectm_pcm_add_float(instance->_projectMHandle, reinterpret_cast<float*>(stream), samples,
-                           static_cast<projectm_channels>(instance->_channels));
+    for (size_t frame = 0; frame < frames; frame += maxFrames)
+    {
+        size_t count = std::min(maxFrames, frames - frame);
+        captureStream->converter.Process(stream + frame * captureStream->bytesPerFrame, count, captureStream->callbackBuffer.data());
+        captureStream->ringBuffer.Write(captureStream->callbackBuffer.data(), count * 2);
+    }
 }
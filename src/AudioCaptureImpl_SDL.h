@@ -1,102 +1,234 @@
 #pragma once
 
+#include "AudioCaptureImpl.h"
+#include "AudioRingBuffer.h"
+#include "Resampler.h"
+#include "SampleConverter.h"
+
 #include <SDL2/SDL.h>
 
+#include <Poco/ActiveMethod.h>
+#include <Poco/Event.h>
 #include <Poco/Logger.h>
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-class projectm;
-
 /**
  * @brief SDL-based audio capturing thread.
  *
  * Uses SDL's audio API to capture PCM data from any supported drivers.
+ *
+ * Opening and closing devices can take hundreds of milliseconds with some sound servers, so this is done on a
+ * separate device switch thread. The previous device keeps capturing until the new one is running.
  */
-class AudioCaptureImpl
+class AudioCaptureImpl_SDL : public AudioCaptureImpl
 {
 public:
-    AudioCaptureImpl();
+    AudioCaptureImpl_SDL();
 
-    ~AudioCaptureImpl();
+    ~AudioCaptureImpl_SDL() override;
 
     /**
      * @brief Returns a map of available recording devices.
      * @return A vector of available audio device IDs and names.
      */
-    std::map<int, std::string> AudioDeviceList();
+    const std::map<int, std::string>& AudioDeviceList() override;
 
     /**
      * @brief Starts audio capturing with the first available device.
+     *
+     * The device is opened asynchronously on the device switch thread.
+     *
      * @param projectMHandle projectM instance handle that will receive the captured data.
      * @param audioDeviceIndex The initial audio device ID to capture from. Use -1 to select the implementation's
      *                      default device.
      */
-    void StartRecording(projectm* projectMHandle, int audioDeviceIndex);
+    void StartRecording(projectm* projectMHandle, int audioDeviceIndex) override;
 
     /**
      * @brief Stops audio recording.
+     *
+     * Waits for the device switch thread to exit, then closes the current device.
      */
-    void StopRecording();
+    void StopRecording() override;
 
     /**
      * @brief Switches to the next available audio recording device.
      */
-    void NextAudioDevice();
+    void NextAudioDevice() override;
 
     /**
      * @brief Activates the audio device with the given idnex for recording.
      * @param index The index, as listed by @a AudioDeviceList()
      */
-    void AudioDeviceIndex(int index);
+    void AudioDeviceIndex(int index) override;
 
     /**
      * @brief Returns the currently used Audio device index.
      * @return The index of the current audio device, as listed by @a AudioDeviceList()
      */
-    int AudioDeviceIndex() const;
+    int AudioDeviceIndex() const override;
 
     /**
      * @brief Retrieves the current audio device name.
      * @return The name of the currently selected audio recording device.
      */
-    std::string AudioDeviceName() const;
+    std::string AudioDeviceName() const override;
 
     /**
      * @brief Asks the capture client to fill projectM's audio buffer for the next frame.
      *
-     * As of now, SDL uses async callbacks to directly fill projectM's audio buffer.
-     *
-     * @todo Store audio samples internally and push them to projectM when requested.
+     * Drains all samples the SDL audio callback has stored in the ring buffer since the last call
+     * and passes them to projectM.
+     */
+    void FillBuffer() override;
+
+    /**
+     * @brief Adds a newly connected recording device to the device list.
+     * @param index SDL's index of the new device.
+     * @param isCapture True if the device is a recording device.
+     */
+    void AudioDeviceAdded(int index, bool isCapture) override;
+
+    /**
+     * @brief Updates the device list and switches to the default device if the current one was removed.
+     * @param deviceId SDL's audio device ID of the removed device.
+     * @param isCapture True if the device is a recording device.
      */
-    void FillBuffer(){};
+    void AudioDeviceRemoved(uint32_t deviceId, bool isCapture) override;
 
 protected:
     /**
-     * @brief Opens the SDL audio device with the currently selected index.
-     * @return
+     * @brief An opened SDL capture device and all data associated with it.
+     *
+     * When switching devices, a new stream is created on the device switch thread while the old one keeps capturing.
+     * The render thread only ever accesses the stream currently published in _stream, so it never waits on the audio
+     * device itself.
+     */
+    struct CaptureStream
+    {
+        SDL_AudioDeviceID deviceId{0}; //!< Device ID of the opened audio device.
+        int deviceIndex{-1}; //!< ID of the device, as listed by AudioDeviceList().
+        uint32_t channels{2}; //!< Channel count of the ring buffer data. The device data is always downmixed to stereo.
+        uint32_t sampleFrequency{44100}; //!< Actual sample frequency of the opened device.
+
+        SampleConverter converter; //!< Converts the device's native sample format and channel layout to stereo float.
+        size_t bytesPerFrame{0}; //!< Size of a single sample frame in the device's native format.
+        std::vector<float> callbackBuffer; //!< Converter output in the audio callback, preallocated to not allocate on SDL's audio thread.
+        AudioRingBuffer ringBuffer; //!< Lock-free buffer between SDL's audio thread and the render thread.
+        std::vector<float> transferBuffer; //!< Buffer used to pass samples from the ring buffer to the resampler.
+        std::vector<float> resampledBuffer; //!< Resampler output which is passed to projectM.
+        Resampler resampler; //!< Converts the device's native sample rate to the rate projectM expects.
+    };
+
+    /**
+     * @brief Asks the device switch thread to open the audio device with the given index.
+     *
+     * Returns immediately. If another switch is still in progress, only the most recent request is executed.
+     *
+     * @param index The device ID, as listed by AudioDeviceList(), or -1 for the default device.
+     */
+    void RequestAudioDevice(int index);
+
+    /**
+     * @brief Enumerates all recording devices and rebuilds the device list.
+     */
+    void UpdateDeviceList();
+
+    /**
+     * @brief Returns the stable ID of a device.
+     *
+     * SDL's device indices change whenever devices are added or removed, so devices are identified by name instead.
+     * A device which is removed and connected again receives the same ID.
+     *
+     * @param deviceName The device name.
+     * @return The ID assigned to the device name.
      */
-    bool OpenAudioDevice();
+    int DeviceIdForName(const std::string& deviceName);
+
+    /**
+     * @brief Device switch thread.
+     *
+     * Waits for device switch requests, opens the new device while the previous one keeps capturing, then publishes
+     * the new stream and closes the old device.
+     */
+    void DeviceSwitchThread();
+
+    /**
+     * @brief Opens the SDL audio device with the given name.
+     * @param index The device ID, or -1 for the default device.
+     * @param deviceName The device name, or an empty string for the default device.
+     * @return The new, still paused capture stream, or nullptr if the device couldn't be opened.
+     */
+    std::shared_ptr<CaptureStream> OpenAudioDevice(int index, const std::string& deviceName);
+
+    /**
+     * @brief Pauses and closes the device of the given stream.
+     * @param stream The stream to close. May be nullptr.
+     */
+    void CloseAudioDevice(const std::shared_ptr<CaptureStream>& stream);
+
+    /**
+     * @brief Determines the native sample frequency, format and channel count of the given device.
+     *
+     * Requires SDL 2.0.16 for specific devices and SDL 2.24.0 for the default device. If the device's
+     * format can't be determined, 44100 Hz stereo float is returned.
+     *
+     * @param deviceName The device name, or an empty string for the default device.
+     * @return The preferred audio spec of the device. Only frequency, format and channels are filled.
+     */
+    SDL_AudioSpec NativeAudioSpec(const std::string& deviceName) const;
+
+    /**
+     * @brief Maps an SDL audio format to the corresponding sample converter format.
+     * @param format The SDL audio format.
+     * @param[out] converterFormat Receives the sample converter format.
+     * @return True if the format is supported by the sample converter, false if not.
+     */
+    static bool ConverterFormat(SDL_AudioFormat format, SampleConverter::Format& converterFormat);
 
     /**
      * @brief SDL audio capture callback.
      *
-     * Called everytime if there is new data available in the audio recording buffer.
+     * Called everytime if there is new data available in the audio recording buffer. Runs on SDL's audio thread,
+     * so it only converts the data to stereo float, copies it into the stream's ring buffer and never calls into
+     * projectM.
      *
-     * @param userData
+     * @param userData The CaptureStream of the device.
      * @param stream
      * @param len
      */
     static void AudioInputCallback(void* userData, unsigned char* stream, int len);
 
     projectm* _projectMHandle{nullptr}; //!< Handle if the projectM instance that will receive the audio data.
-    int32_t _currentAudioDeviceIndex{-1}; //!< Currently selected audio device index.
-    SDL_AudioDeviceID _currentAudioDeviceID{0}; //!< Device ID of the currently opened audio device.
-    uint32_t _channels{2};
+    std::atomic_int _currentAudioDeviceIndex{-1}; //!< Currently selected audio device ID, possibly still being opened.
+
+    std::map<int, std::string> _deviceList; //!< Cached list of recording devices, by stable device ID.
+    std::map<std::string, int> _deviceIds; //!< Stable IDs of all devices seen so far, by device name.
+    int _nextDeviceId{0}; //!< The ID assigned to the next previously unknown device.
+
+    std::shared_ptr<CaptureStream> _stream; //!< The currently active capture stream. Only accessed via std::atomic_load/store.
+
+    Poco::ActiveMethod<void, void, AudioCaptureImpl_SDL> _deviceSwitchThread; //!< Active method running the device switch thread.
+    Poco::ActiveResult<void> _deviceSwitchThreadResult{new Poco::ActiveResultHolder<void>()};
+    std::atomic_bool _deviceSwitchThreadRunning{false}; //!< If true, the device switch thread is running.
+    std::atomic_bool _deviceSwitchRequested{false}; //!< If true, a new device should be opened.
+    std::mutex _deviceSwitchRequestMutex; //!< Protects the requested device index and name.
+    int _requestedAudioDeviceIndex{-1}; //!< Device ID to open on the next switch.
+    std::string _requestedAudioDeviceName; //!< Device name to open on the next switch. Empty for the default device.
+    Poco::Event _deviceSwitchEvent; //!< Event which gets set if a device switch was requested or the thread should exit.
+
+    Resampler::Quality _resamplerQuality{Resampler::Quality::Medium}; //!< User-configured resampler quality.
+
+    constexpr static uint32_t _projectMSampleFrequency{44100}; //!< Sample frequency passed to projectM. Hardcoded as 44100 Hz, as this is what the spectrum analyzer expects.
+    uint32_t _targetFps{60}; //!< Configured target FPS, used to determine the audio buffer size.
 
-    constexpr static uint32_t _requestedSampleFrequency{44100}; //!< Requested sample frequency. Currently hardcoded as 44100 Hz, as this is what the spectrum analyzer expects.
-    uint32_t _requestedSampleCount{44100U / 60U}; //!< Requested audio buffer size. Determines how often SDL will call AudioInputCallback() with new data, and how much data is delivered on each call.
+    static constexpr char _defaultDeviceName[] = "Default capturing device"; //!< Display name for the default device (index -1).
 
     Poco::Logger& _logger{Poco::Logger::get("AudioCapture.SDL")}; //!< The class logger.
 };
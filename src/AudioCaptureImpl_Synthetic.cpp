@@ -0,0 +1,113 @@
+#include "AudioCaptureImpl_Synthetic.h"
+
+#include <Poco/Util/Application.h>
+
+#include <projectM-4/projectM.h>
+
+#include <cmath>
+
+namespace {
+constexpr double Pi{3.14159265358979323846};
+}
+
+AudioCaptureImpl_Synthetic::AudioCaptureImpl_Synthetic()
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _beatsPerMinute = config.getDouble("audio.synthetic.bpm", 120.0);
+    _targetFps = config.getUInt("projectM.fps", 60);
+
+    if (_beatsPerMinute <= 0.0)
+    {
+        _beatsPerMinute = 120.0;
+    }
+
+    _deviceList = {{-1, AudioDeviceName()}};
+}
+
+const std::map<int, std::string>& AudioCaptureImpl_Synthetic::AudioDeviceList()
+{
+    return _deviceList;
+}
+
+void AudioCaptureImpl_Synthetic::StartRecording(projectm* projectMHandle, int)
+{
+    _projectMHandle = projectMHandle;
+    _sampleIndex = 0;
+    _noiseState = 1;
+    _sweepPhase = 0.0;
+    _fractionalFrames = 0.0;
+    _isRunning = true;
+
+    poco_information_f1(_logger, "Generating synthetic test signal at %.1f BPM.", _beatsPerMinute);
+}
+
+void AudioCaptureImpl_Synthetic::StopRecording()
+{
+    _isRunning = false;
+}
+
+void AudioCaptureImpl_Synthetic::NextAudioDevice()
+{
+}
+
+void AudioCaptureImpl_Synthetic::AudioDeviceIndex(int)
+{
+}
+
+int AudioCaptureImpl_Synthetic::AudioDeviceIndex() const
+{
+    return -1;
+}
+
+std::string AudioCaptureImpl_Synthetic::AudioDeviceName() const
+{
+    return "Synthetic test signal";
+}
+
+void AudioCaptureImpl_Synthetic::FillBuffer()
+{
+    if (!_isRunning)
+    {
+        return;
+    }
+
+    // Unlimited FPS has no fixed frame duration, so assume 60 FPS in this case.
+    _fractionalFrames += static_cast<double>(_sampleFrequency) / (_targetFps > 0 ? _targetFps : 60);
+    auto frames = static_cast<size_t>(_fractionalFrames);
+    _fractionalFrames -= static_cast<double>(frames);
+
+    if (frames == 0)
+    {
+        return;
+    }
+
+    _buffer.resize(frames * 2);
+
+    double samplesPerBeat = 60.0 * _sampleFrequency / _beatsPerMinute;
+
+    for (size_t frame = 0; frame < frames; frame++, _sampleIndex++)
+    {
+        double time = static_cast<double>(_sampleIndex) / _sampleFrequency;
+        double beatPosition = std::fmod(static_cast<double>(_sampleIndex), samplesPerBeat) / _sampleFrequency;
+        double offBeatPosition = std::fmod(static_cast<double>(_sampleIndex) + samplesPerBeat / 2.0, samplesPerBeat) / _sampleFrequency;
+
+        // Bass drum: sine with a falling pitch and exponential decay.
+        double kickFrequency = 50.0 + 100.0 * std::exp(-beatPosition * 30.0);
+        double kick = 0.8 * std::sin(2.0 * Pi * kickFrequency * beatPosition) * std::exp(-beatPosition * 8.0);
+
+        // Hi-hat: white noise burst from a linear congruential generator.
+        _noiseState = _noiseState * 1664525U + 1013904223U;
+        double noise = static_cast<double>(_noiseState >> 8) / static_cast<double>(1U << 24) * 2.0 - 1.0;
+        double hiHat = 0.15 * noise * std::exp(-offBeatPosition * 40.0);
+
+        // Exponential sine sweep from 200 Hz to 5 kHz and back every 16 seconds.
+        double sweepPosition = std::fabs(std::fmod(time, 16.0) - 8.0) / 8.0;
+        _sweepPhase = std::fmod(_sweepPhase + 2.0 * Pi * 200.0 * std::pow(25.0, sweepPosition) / _sampleFrequency, 2.0 * Pi);
+        double sweep = 0.2 * std::sin(_sweepPhase);
+
+        _buffer[frame * 2] = static_cast<float>(kick + hiHat + sweep);
+        _buffer[frame * 2 + 1] = static_cast<float>(kick - hiHat + sweep);
+    }
+
+    projectm_pcm_add_float(_projectMHandle, _buffer.data(), static_cast<unsigned int>(frames), PROJECTM_STEREO);
+}
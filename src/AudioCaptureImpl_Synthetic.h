@@ -0,0 +1,56 @@
+#pragma once
+
+#include "AudioCaptureImpl.h"
+
+#include <Poco/Logger.h>
+
+#include <vector>
+
+/**
+ * @brief Generates a synthetic test signal instead of capturing audio.
+ *
+ * The signal consists of a decaying bass drum on every beat, noise bursts on the off-beats and a slow sine sweep
+ * across the mid frequencies, so it triggers beat detection and covers the whole spectrum. It's fully deterministic
+ * and doesn't require any audio hardware, which makes it useful for benchmarking and headless test runs.
+ *
+ * Each call to FillBuffer() generates exactly 1/fps seconds of audio.
+ */
+class AudioCaptureImpl_Synthetic : public AudioCaptureImpl
+{
+public:
+    AudioCaptureImpl_Synthetic();
+
+    const std::map<int, std::string>& AudioDeviceList() override;
+
+    void StartRecording(projectm* projectMHandle, int audioDeviceIndex) override;
+
+    void StopRecording() override;
+
+    void NextAudioDevice() override;
+
+    void AudioDeviceIndex(int index) override;
+
+    int AudioDeviceIndex() const override;
+
+    std::string AudioDeviceName() const override;
+
+    void FillBuffer() override;
+
+protected:
+    projectm* _projectMHandle{nullptr}; //!< Handle if the projectM instance that will receive the audio data.
+    std::map<int, std::string> _deviceList; //!< The "device" list with a single entry.
+    bool _isRunning{false}; //!< True if the signal is being generated.
+
+    double _beatsPerMinute{120.0}; //!< Tempo of the generated beat.
+    uint32_t _targetFps{60}; //!< Configured target FPS, used to determine the samples per frame.
+
+    uint64_t _sampleIndex{0}; //!< Index of the next sample frame to generate.
+    uint32_t _noiseState{1}; //!< State of the pseudo-random noise generator.
+    double _sweepPhase{0.0}; //!< Current phase of the sine sweep in radians.
+    double _fractionalFrames{0.0}; //!< Accumulated sub-sample remainder of the per-frame sample count.
+    std::vector<float> _buffer; //!< Generated interleaved stereo samples.
+
+    constexpr static uint32_t _sampleFrequency{44100}; //!< Sample frequency of the generated signal.
+
+    Poco::Logger& _logger{Poco::Logger::get("AudioCapture.Synthetic")}; //!< The class logger.
+};
@@ -8,114 +8,132 @@
 #include <mmdeviceapi.h>
 #include <objbase.h>
 
-AudioCaptureImpl::AudioCaptureImpl()
-    : _captureThread(this, &AudioCaptureImpl::CaptureThread)
+constexpr char AudioCaptureImpl_WASAPI::_defaultDeviceName[];
+
+AudioCaptureImpl_WASAPI::AudioCaptureImpl_WASAPI()
+    : _captureThread(this, &AudioCaptureImpl_WASAPI::CaptureThread)
 {
     CoInitializeEx(nullptr, COINIT_MULTITHREADED);
 }
 
-AudioCaptureImpl::~AudioCaptureImpl()
+AudioCaptureImpl_WASAPI::~AudioCaptureImpl_WASAPI()
 {
     CoUninitialize();
 }
 
-std::map<int, std::string> AudioCaptureImpl::AudioDeviceList()
+const std::map<int, std::string>& AudioCaptureImpl_WASAPI::AudioDeviceList()
+{
+    return CachedDeviceList();
+}
+
+const std::map<int, std::string>& AudioCaptureImpl_WASAPI::CachedDeviceList() const
 {
-    std::map<int, std::string> deviceList{
-        {-1, _defaultDeviceName}};
+    // Only enumerate devices again if the MM notification client reported a change.
+    if (!_deviceListDirty.exchange(false))
+    {
+        return _deviceList;
+    }
+
+    _deviceList = {{-1, _defaultDeviceName}};
 
     IMMDeviceEnumerator* enumerator{GetDeviceEnumerator()};
     auto captureDevices{GetAudioDeviceList(enumerator)};
     enumerator->Release();
 
-    uint32_t index{0};
+    _deviceEndpoints.clear();
     for (const auto& device : captureDevices)
     {
         if (device.DeviceId() != nullptr)
         {
-            deviceList.insert(std::make_pair(index, device.FriendlyName()));
+            auto deviceId = DeviceIdForEndpoint(device.DeviceId());
+            _deviceList.insert(std::make_pair(deviceId, device.FriendlyName()));
+            _deviceEndpoints.insert(std::make_pair(deviceId, DeviceEndpoint{device.DeviceId(), device.IsRenderDevice()}));
         }
+    }
 
-        index++;
+    return _deviceList;
+}
+
+int AudioCaptureImpl_WASAPI::DeviceIdForEndpoint(const std::wstring& endpointId) const
+{
+    auto knownDevice = _deviceIds.find(endpointId);
+    if (knownDevice != _deviceIds.end())
+    {
+        return knownDevice->second;
     }
 
-    return deviceList;
+    int deviceId = _nextDeviceId++;
+    _deviceIds.insert(std::make_pair(endpointId, deviceId));
+
+    return deviceId;
 }
 
-void AudioCaptureImpl::StartRecording(projectm* projectMHandle, int audioDeviceIndex)
+void AudioCaptureImpl_WASAPI::StartRecording(projectm* projectMHandle, int audioDeviceIndex)
 {
     _projectMHandle = projectMHandle;
-    _currentAudioDeviceIndex = audioDeviceIndex;
-
-    _isCapturing = true;
-    _captureThreadResult = _captureThread();
+    RequestAudioDevice(audioDeviceIndex);
 }
 
-void AudioCaptureImpl::StopRecording()
+void AudioCaptureImpl_WASAPI::StopRecording()
 {
-    if (_isCapturing)
+    // The thread may already have exited after an error, but still has to be joined.
+    if (_captureThreadStarted)
     {
         poco_trace(_logger, "Stopping audio capturing thread.");
         _isCapturing = false;
         _fillBufferEvent.set();
         _captureThreadResult.wait();
+        _captureThreadStarted = false;
         poco_trace(_logger, "Audio capturing thread joined.");
     }
 }
 
-void AudioCaptureImpl::NextAudioDevice()
+void AudioCaptureImpl_WASAPI::NextAudioDevice()
 {
-    StopRecording();
-
-    IMMDeviceEnumerator* enumerator{GetDeviceEnumerator()};
-    auto captureDevices{GetAudioDeviceList(enumerator)};
-    enumerator->Release();
+    const auto& deviceList = CachedDeviceList();
 
-    // Will wrap around to loopback capture device (-1).
-    int nextAudioDeviceId = ((_currentAudioDeviceIndex + 2) % (static_cast<int>(captureDevices.size()) + 1)) - 1;
+    // Will wrap around to loopback capture device (-1), which is always the first entry.
+    auto nextDevice = deviceList.upper_bound(_currentAudioDeviceIndex);
+    if (nextDevice == deviceList.end())
+    {
+        nextDevice = deviceList.begin();
+    }
 
-    StartRecording(_projectMHandle, nextAudioDeviceId);
+    RequestAudioDevice(nextDevice->first);
 }
 
-void AudioCaptureImpl::AudioDeviceIndex(int index)
+void AudioCaptureImpl_WASAPI::AudioDeviceIndex(int index)
 {
-    IMMDeviceEnumerator* enumerator{GetDeviceEnumerator()};
-    auto captureDevices{GetAudioDeviceList(enumerator)};
-    enumerator->Release();
-
-    if (index >= -1 && index < static_cast<int>(captureDevices.size()))
+    const auto& deviceList = CachedDeviceList();
+    if (deviceList.find(index) != deviceList.end())
     {
-        _currentAudioDeviceIndex = index;
-        StopRecording();
-        StartRecording(_projectMHandle, index);
+        RequestAudioDevice(index);
     }
 }
 
-int AudioCaptureImpl::AudioDeviceIndex() const
+int AudioCaptureImpl_WASAPI::AudioDeviceIndex() const
 {
     return _currentAudioDeviceIndex;
 }
 
-std::string AudioCaptureImpl::AudioDeviceName() const
+std::string AudioCaptureImpl_WASAPI::AudioDeviceName() const
 {
     if (_currentAudioDeviceIndex < 0)
     {
         return "System Default Audio Device";
     }
 
-    IMMDeviceEnumerator* enumerator{GetDeviceEnumerator()};
-    auto captureDevices{GetAudioDeviceList(enumerator)};
-    enumerator->Release();
-
-    if (captureDevices.empty() || _currentAudioDeviceIndex >= static_cast<int>(captureDevices.size()))
+    const auto& deviceList = CachedDeviceList();
+    auto device = deviceList.find(_currentAudioDeviceIndex);
+    if (device == deviceList.end())
     {
         return {};
     }
 
-    return captureDevices.at(_currentAudioDeviceIndex).FriendlyName();
+    return device->second;
 }
 
-void AudioCaptureImpl::FillBuffer()
+void AudioCaptureImpl_WASAPI::FillBuffer()
 {
     if (_isCapturing)
     {
@@ -132,7 +150,42 @@ void AudioCaptureImpl::FillBuffer()
     }
 }
 
-HRESULT AudioCaptureImpl::QueryInterface(const IID& riid, void** ppvObject)
+void AudioCaptureImpl_WASAPI::RequestAudioDevice(int index)
+{
+    CachedDeviceList();
+    auto endpoint = _deviceEndpoints.find(index);
+    if (endpoint == _deviceEndpoints.end())
+    {
+        index = -1;
+    }
+
+    // Report the new device right away, so the UI reflects the user's choice while the device is being opened.
+    _currentAudioDeviceIndex = index;
+    {
+        std::lock_guard<std::mutex> lock(_requestedAudioDeviceMutex);
+        _requestedAudioDeviceIndex = index;
+        _requestedEndpointId = index >= 0 ? endpoint->second.endpointId : std::wstring();
+        _requestedAudioDeviceName = index >= 0 ? _deviceList.at(index) : std::string(_defaultDeviceName);
+        _requestedLoopback = index < 0 || endpoint->second.isRenderDevice;
+    }
+
+    if (_isCapturing)
+    {
+        // The capture thread closes the current device and opens the requested one.
+        _restartCapturing = true;
+        _fillBufferEvent.set();
+        return;
+    }
+
+    // Not started yet, or the thread has exited after an error.
+    StopRecording();
+
+    _isCapturing = true;
+    _captureThreadResult = _captureThread();
+    _captureThreadStarted = true;
+}
+
+HRESULT AudioCaptureImpl_WASAPI::QueryInterface(const IID& riid, void** ppvObject)
 {
     if (ppvObject == nullptr)
     {
@@ -153,24 +206,24 @@ HRESULT AudioCaptureImpl::QueryInterface(const IID& riid, void** ppvObject)
     return E_NOINTERFACE;
 }
 
-ULONG AudioCaptureImpl::AddRef()
+ULONG AudioCaptureImpl_WASAPI::AddRef()
 {
     return InterlockedIncrement(&_referenceCount);
 }
 
-ULONG AudioCaptureImpl::Release()
+ULONG AudioCaptureImpl_WASAPI::Release()
 {
     return InterlockedDecrement(&_referenceCount);
 }
 
-std::string AudioCaptureImpl::UnicodeToString(LPCWSTR unicodeString)
+std::string AudioCaptureImpl_WASAPI::UnicodeToString(LPCWSTR unicodeString)
 {
     std::string utf8String;
     Poco::UnicodeConverter::convert(std::wstring(unicodeString), utf8String);
     return utf8String;
 }
 
-std::vector<AudioCaptureImpl::AudioDevice> AudioCaptureImpl::GetAudioDeviceList(IMMDeviceEnumerator* enumerator) const
+std::vector<AudioCaptureImpl_WASAPI::AudioDevice> AudioCaptureImpl_WASAPI::GetAudioDeviceList(IMMDeviceEnumerator* enumerator) const
 {
     auto addEndpoints = [this, enumerator](std::vector<AudioDevice>& deviceList, EDataFlow dataFlow) {
         HRESULT result{S_OK};
@@ -210,7 +263,7 @@ std::vector<AudioCaptureImpl::AudioDevice> AudioCaptureImpl::GetAudioDeviceList(
     return deviceList;
 }
 
-bool AudioCaptureImpl::OpenAudioDevice(IMMDevice* device, bool useLoopback)
+bool AudioCaptureImpl_WASAPI::OpenAudioDevice(IMMDevice* device, bool useLoopback)
 {
     // activate an IAudioClient
     HRESULT result = device->Activate(__uuidof(IAudioClient),
@@ -242,25 +295,52 @@ bool AudioCaptureImpl::OpenAudioDevice(IMMDevice* device, bool useLoopback)
         return false;
     }
 
-    // Should default to float32 data, but some devices might deliver other formats.
-    if (pwfx->wFormatTag != WAVE_FORMAT_IEEE_FLOAT)
+    // Should default to float32 data, but some devices might deliver integer formats. Those are converted to float
+    // and all channels are downmixed to stereo before passing the data to projectM.
+    bool isFloat = pwfx->wFormatTag == WAVE_FORMAT_IEEE_FLOAT;
+    bool isPcm = pwfx->wFormatTag == WAVE_FORMAT_PCM;
+    if (pwfx->wFormatTag == WAVE_FORMAT_EXTENSIBLE)
     {
         auto extensibleFormat = reinterpret_cast<PWAVEFORMATEXTENSIBLE>(pwfx);
-        if (pwfx->wFormatTag != WAVE_FORMAT_EXTENSIBLE)
-        {
-            poco_error_f1(_logger, "IAudioClient::GetMixFormat returned non-float sample format: 0x%04?x", pwfx->wFormatTag);
-            CoTaskMemFree(pwfx);
-            return false;
-        }
-        else if (!IsEqualGUID(KSDATAFORMAT_SUBTYPE_IEEE_FLOAT, extensibleFormat->SubFormat))
-        {
-            poco_error_f1(_logger, "IAudioClient::GetMixFormat returned non-float extensible sub format: 0x%04?x", extensibleFormat->SubFormat);
-            CoTaskMemFree(pwfx);
-            return false;
-        }
+        isFloat = IsEqualGUID(KSDATAFORMAT_SUBTYPE_IEEE_FLOAT, extensibleFormat->SubFormat);
+        isPcm = IsEqualGUID(KSDATAFORMAT_SUBTYPE_PCM, extensibleFormat->SubFormat);
+    }
+
+    // The container size is used, as 24-bit samples in 32-bit containers are MSB-aligned.
+    SampleConverter::Format sampleFormat;
+    if (isFloat && pwfx->wBitsPerSample == 32)
+    {
+        sampleFormat = SampleConverter::Format::F32;
+    }
+    else if (isPcm && pwfx->wBitsPerSample == 16)
+    {
+        sampleFormat = SampleConverter::Format::S16;
+    }
+    else if (isPcm && pwfx->wBitsPerSample == 24)
+    {
+        sampleFormat = SampleConverter::Format::S24;
+    }
+    else if (isPcm && pwfx->wBitsPerSample == 32)
+    {
+        sampleFormat = SampleConverter::Format::S32;
+    }
+    else
+    {
+        poco_error_f2(_logger, "IAudioClient::GetMixFormat returned unsupported sample format: 0x%04?x with %hu bits per sample",
+                      pwfx->wFormatTag, pwfx->wBitsPerSample);
+        CoTaskMemFree(pwfx);
+        return false;
+    }
+
+    if (pwfx->nChannels > SampleConverter::MaxInputChannels)
+    {
+        poco_error_f1(_logger, "IAudioClient::GetMixFormat returned unsupported channel count: %hu", pwfx->nChannels);
+        CoTaskMemFree(pwfx);
+        return false;
     }
 
     _channels = pwfx->nChannels;
+    _sampleConverter.Configure(sampleFormat, _channels);
 
     // Can't use event-driven processing in loopback mode, but as we
     // get a "fill buffer" request before rendering each frame, this isn't
@@ -302,10 +382,13 @@ bool AudioCaptureImpl::OpenAudioDevice(IMMDevice* device, bool useLoopback)
     return true;
 }
 
-void AudioCaptureImpl::CloseAudioDevice(IMMDevice* device)
+void AudioCaptureImpl_WASAPI::CloseAudioDevice(IMMDevice* device)
 {
-    poco_trace(_logger, "Stopping audio client.");
-    _audioClient->Stop();
+    if (_audioClient)
+    {
+        poco_trace(_logger, "Stopping audio client.");
+        _audioClient->Stop();
+    }
 
     if (_audioCaptureClient)
     {
@@ -328,7 +411,7 @@ void AudioCaptureImpl::CloseAudioDevice(IMMDevice* device)
     }
 }
 
-void AudioCaptureImpl::CaptureThread()
+void AudioCaptureImpl_WASAPI::CaptureThread()
 {
     poco_debug(_logger, "Audio capture thread starting.");
 
@@ -337,6 +420,7 @@ void AudioCaptureImpl::CaptureThread()
     if (FAILED(result))
     {
         poco_error_f1(_logger, "CoInitializeEx() failed: result = 0x%08?x", result);
+        _isCapturing = false;
         throw std::bad_alloc();
     }
 
@@ -344,6 +428,7 @@ void AudioCaptureImpl::CaptureThread()
 
     if (enumerator == nullptr)
     {
+        _isCapturing = false;
         CoUninitialize();
         throw std::bad_alloc();
     }
@@ -355,36 +440,53 @@ void AudioCaptureImpl::CaptureThread()
     {
         _restartCapturing = false;
 
-        auto devices{GetAudioDeviceList(enumerator)};
-        bool useLoopback{true};
+        int index;
+        std::wstring endpointId;
         std::string deviceName;
+        bool useLoopback;
+        {
+            std::lock_guard<std::mutex> lock(_requestedAudioDeviceMutex);
+            index = _requestedAudioDeviceIndex;
+            endpointId = _requestedEndpointId;
+            deviceName = _requestedAudioDeviceName;
+            useLoopback = _requestedLoopback;
+        }
 
         IMMDevice* device{nullptr};
 
-        if (_currentAudioDeviceIndex == -1 || _currentAudioDeviceIndex >= devices.size())
+        if (index >= 0)
+        {
+            // Get the device by its endpoint ID, which stays valid if other devices are added or removed.
+            DWORD state{0};
+            result = enumerator->GetDevice(endpointId.c_str(), &device);
+            if (FAILED(result) || FAILED(device->GetState(&state)) || state != DEVICE_STATE_ACTIVE)
+            {
+                poco_warning_f1(_logger, R"(Audio device "%s" is not available, using the default device.)", deviceName);
+
+                if (device != nullptr)
+                {
+                    device->Release();
+                    device = nullptr;
+                }
+
+                // Only report the default device if no other device was selected in the meantime.
+                _currentAudioDeviceIndex.compare_exchange_strong(index, -1);
+            }
+        }
+
+        if (device == nullptr)
         {
             // Get the default render endpoint for opening it as a loopback device.
             result = enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device);
             if (FAILED(result))
             {
                 poco_error_f1(_logger, "IMMDeviceEnumerator::GetDefaultAudioEndpoint failed: result = 0x%08?x", result);
+                _isCapturing = false;
                 break;
             }
 
             deviceName = _defaultDeviceName;
-        }
-        else
-        {
-            // Get a device by its ID according to the currently selected index.
-            useLoopback = devices.at(_currentAudioDeviceIndex).IsRenderDevice();
-            deviceName = devices.at(_currentAudioDeviceIndex).FriendlyName();
-            result = enumerator->GetDevice(devices.at(_currentAudioDeviceIndex).DeviceId(), &device);
-
-            if (FAILED(result))
-            {
-                poco_error_f1(_logger, "IMMDeviceEnumerator::GetDevice failed: result = 0x%08?x", result);
-                break;
-            }
+            useLoopback = true;
         }
 
         LPWSTR deviceID{nullptr};
@@ -398,12 +500,16 @@ void AudioCaptureImpl::CaptureThread()
             _currentCaptureDeviceId = UnicodeToString(deviceID);
         }
 
-        if (!OpenAudioDevice(device, useLoopback))
+        // If the device can't be opened, wait for another device to be selected. FillBuffer() must not block meanwhile.
+        bool deviceOpened = OpenAudioDevice(device, useLoopback);
+        if (deviceOpened)
         {
-            _isCapturing = false;
+            poco_information_f3(_logger, "Audio device opened: %s (channels: %hu, loopback: %b)", deviceName, _channels, useLoopback);
+        }
+        else
+        {
+            poco_error_f1(_logger, "Could not open audio device %s, select another device.", deviceName);
         }
-
-        poco_information_f3(_logger, "Audio device opened: %s (channels: %hu, loopback: %b)", deviceName, _channels, useLoopback);
 
         while (_isCapturing && !_restartCapturing)
         {
@@ -421,9 +527,13 @@ void AudioCaptureImpl::CaptureThread()
                 break;
             }
 
-            UINT32 packetLength;
+            UINT32 packetLength{0};
+
+            if (deviceOpened)
+            {
+                _audioCaptureClient->GetNextPacketSize(&packetLength);
+            }
 
-            _audioCaptureClient->GetNextPacketSize(&packetLength);
             while (packetLength != 0)
             {
                 BYTE* data;
@@ -447,7 +557,13 @@ void AudioCaptureImpl::CaptureThread()
 
                 if (framesAvailable > 0 && data != nullptr)
                 {
-                    projectm_pcm_add_float(_projectMHandle, reinterpret_cast<float*>(data), framesAvailable, static_cast<projectm_channels>(_channels));
+                    if (_conversionBuffer.size() < framesAvailable * 2)
+                    {
+                        _conversionBuffer.resize(framesAvailable * 2);
+                    }
+
+                    _sampleConverter.Process(data, framesAvailable, _conversionBuffer.data());
+                    projectm_pcm_add_float(_projectMHandle, _conversionBuffer.data(), framesAvailable, PROJECTM_STEREO);
                 }
 
                 _audioCaptureClient->ReleaseBuffer(framesAvailable);
@@ -461,7 +577,7 @@ void AudioCaptureImpl::CaptureThread()
         CloseAudioDevice(device);
 
         poco_debug(_logger, "Audio device closed.");
-    } while (_restartCapturing);
+    } while (_isCapturing && _restartCapturing);
 
     poco_trace(_logger, "Unregistering device callbacks.");
     enumerator->UnregisterEndpointNotificationCallback(this);
@@ -474,7 +590,7 @@ void AudioCaptureImpl::CaptureThread()
     poco_debug(_logger, "Audio capture thread exiting.");
 }
 
-IMMDeviceEnumerator* AudioCaptureImpl::GetDeviceEnumerator() const
+IMMDeviceEnumerator* AudioCaptureImpl_WASAPI::GetDeviceEnumerator() const
 {
     IMMDeviceEnumerator* enumerator{nullptr};
 
@@ -493,39 +609,25 @@ IMMDeviceEnumerator* AudioCaptureImpl::GetDeviceEnumerator() const
     return enumerator;
 }
 
-HRESULT AudioCaptureImpl::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState)
+HRESULT AudioCaptureImpl_WASAPI::OnDeviceStateChanged(LPCWSTR pwstrDeviceId, DWORD dwNewState)
 {
     auto deviceId{UnicodeToString(pwstrDeviceId)};
 
     poco_trace_f2(_logger, "Audio device state changed for device ID %s: %lu", deviceId, dwNewState);
 
-    // Recalculate current device index and restart only if not default.
-    if (_currentAudioDeviceIndex >= 0)
-    {
-        IMMDeviceEnumerator* enumerator{GetDeviceEnumerator()};
-        auto captureDevices{GetAudioDeviceList(enumerator)};
-        enumerator->Release();
-
-        for (int index = 0; index < captureDevices.size(); ++index)
-        {
-            if (UnicodeToString(captureDevices.at(index).DeviceId()) == deviceId)
-            {
-                _currentAudioDeviceIndex = index;
-                break;
-            }
-        }
+    _deviceListDirty = true;
 
-        // Restart capturing only in case the current device state changed.
-        if (_isCapturing && deviceId == _currentCaptureDeviceId)
-        {
-            _restartCapturing = true;
-        }
+    // Device IDs don't depend on the list position, so the current ID stays valid. Restart only if not default and
+    // the current device state changed. If the device is gone, the capture thread falls back to the default device.
+    if (_currentAudioDeviceIndex >= 0 && _isCapturing && deviceId == _currentCaptureDeviceId)
+    {
+        _restartCapturing = true;
     }
 
     return S_OK;
 }
 
-HRESULT AudioCaptureImpl::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId)
+HRESULT AudioCaptureImpl_WASAPI::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR pwstrDefaultDeviceId)
 {
     poco_trace_f1(_logger, "Default audio device changed to ID %s", UnicodeToString(pwstrDefaultDeviceId));
 
@@ -542,28 +644,32 @@ HRESULT AudioCaptureImpl::OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPC
     return S_OK;
 }
 
-HRESULT AudioCaptureImpl::OnDeviceAdded(LPCWSTR pwstrDeviceId)
+HRESULT AudioCaptureImpl_WASAPI::OnDeviceAdded(LPCWSTR pwstrDeviceId)
 {
     poco_trace_f1(_logger, "Audio device added: %s", UnicodeToString(pwstrDeviceId));
 
+    _deviceListDirty = true;
+
     return S_OK;
 }
 
-HRESULT AudioCaptureImpl::OnDeviceRemoved(LPCWSTR pwstrDeviceId)
+HRESULT AudioCaptureImpl_WASAPI::OnDeviceRemoved(LPCWSTR pwstrDeviceId)
 {
     poco_trace_f1(_logger, "Audio device removed: %s", UnicodeToString(pwstrDeviceId));
 
+    _deviceListDirty = true;
+
     return S_OK;
 }
 
-HRESULT AudioCaptureImpl::OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key)
+HRESULT AudioCaptureImpl_WASAPI::OnPropertyValueChanged(LPCWSTR pwstrDeviceId, const PROPERTYKEY key)
 {
     poco_trace_f1(_logger, "Audio device property changed for device ID %s", UnicodeToString(pwstrDeviceId));
 
     return S_OK;
 }
 
-AudioCaptureImpl::AudioDevice::AudioDevice(IMMDevice* device, bool isRenderDevice)
+AudioCaptureImpl_WASAPI::AudioDevice::AudioDevice(IMMDevice* device, bool isRenderDevice)
     : _friendlyName(GetAudioEndpointFriendlyName(device))
     , _isRenderDevice(isRenderDevice)
 {
@@ -577,11 +683,11 @@ AudioCaptureImpl::AudioDevice::AudioDevice(IMMDevice* device, bool isRenderDevic
         }
 
         poco_trace_f3(_logger, R"(Added WASAPI audio device "%s" with ID %s (Render device: %b))",
-                      _friendlyName, AudioCaptureImpl::UnicodeToString(_deviceId), _isRenderDevice);
+                      _friendlyName, AudioCaptureImpl_WASAPI::UnicodeToString(_deviceId), _isRenderDevice);
     }
 }
 
-AudioCaptureImpl::AudioDevice::AudioDevice(AudioCaptureImpl::AudioDevice&& other) noexcept
+AudioCaptureImpl_WASAPI::AudioDevice::AudioDevice(AudioCaptureImpl_WASAPI::AudioDevice&& other) noexcept
 {
     _deviceId = other._deviceId;
     other._deviceId = nullptr;
@@ -589,7 +695,7 @@ AudioCaptureImpl::AudioDevice::AudioDevice(AudioCaptureImpl::AudioDevice&& other
     _isRenderDevice = other._isRenderDevice;
 }
 
-AudioCaptureImpl::AudioDevice::~AudioDevice()
+AudioCaptureImpl_WASAPI::AudioDevice::~AudioDevice()
 {
     if (_deviceId)
     {
@@ -598,13 +704,13 @@ AudioCaptureImpl::AudioDevice::~AudioDevice()
     }
 }
 
-std::string AudioCaptureImpl::AudioDevice::GetAudioEndpointFriendlyName(IMMDevice* pMMDevice)
+std::string AudioCaptureImpl_WASAPI::AudioDevice::GetAudioEndpointFriendlyName(IMMDevice* pMMDevice)
 {
     HRESULT result{S_OK};
 
     if (pMMDevice == nullptr)
     {
-        return AudioCaptureImpl::_defaultDeviceName;
+        return AudioCaptureImpl_WASAPI::_defaultDeviceName;
     }
 
     IPropertyStore* deviceProps{nullptr};
@@ -626,7 +732,7 @@ std::string AudioCaptureImpl::AudioDevice::GetAudioEndpointFriendlyName(IMMDevic
         return {};
     }
 
-    std::string deviceFriendlyName = AudioCaptureImpl::UnicodeToString(variantName.pwszVal);
+    std::string deviceFriendlyName = AudioCaptureImpl_WASAPI::UnicodeToString(variantName.pwszVal);
 
     PropVariantClear(&variantName);
     deviceProps->Release();
@@ -634,17 +740,17 @@ std::string AudioCaptureImpl::AudioDevice::GetAudioEndpointFriendlyName(IMMDevic
     return deviceFriendlyName;
 }
 
-LPWSTR AudioCaptureImpl::AudioDevice::DeviceId() const
+LPWSTR AudioCaptureImpl_WASAPI::AudioDevice::DeviceId() const
 {
     return _deviceId;
 }
 
-std::string AudioCaptureImpl::AudioDevice::FriendlyName() const
+std::string AudioCaptureImpl_WASAPI::AudioDevice::FriendlyName() const
 {
     return _friendlyName;
 }
 
-bool AudioCaptureImpl::AudioDevice::IsRenderDevice() const
+bool AudioCaptureImpl_WASAPI::AudioDevice::IsRenderDevice() const
 {
     return _isRenderDevice;
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "AudioCaptureImpl.h"
+#include "SampleConverter.h"
+
 #include <Poco/Logger.h>
 
 #include <Audioclient.h>
@@ -8,9 +11,12 @@
 #include <Poco/Event.h>
 
 #include <mmdeviceapi.h>
-#include <string>
 
-struct projectm;
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 /**
  * @brief WASAPI-based audio capturing implementation.
@@ -22,67 +28,84 @@ struct projectm;
  * The system-default playback device is always considered as the "first" available device. All other external audio
  * sources come after that, with playback devices before recording devices.
  *
- * It supports hot-plug device changes with fallback to other devices.
+ * Devices are opened and closed on the capture thread. Switching devices only passes the request to the thread, so the
+ * render thread never waits for a device to be torn down or initialized.
+ *
+ * It supports hot-plug device changes with fallback to other devices. Device IDs are assigned per endpoint ID, so they
+ * stay the same if other devices are plugged in or removed, and a reconnected device receives its previous ID.
  */
-class AudioCaptureImpl : public IMMNotificationClient
+class AudioCaptureImpl_WASAPI : public AudioCaptureImpl, public IMMNotificationClient
 {
 public:
     /**
      * Constructor.
      */
-    AudioCaptureImpl();
+    AudioCaptureImpl_WASAPI();
 
     /**
      * Destructor.
      */
-    ~AudioCaptureImpl();
+    ~AudioCaptureImpl_WASAPI() override;
 
     /**
      * @brief Returns a map of available recording devices.
-     * @return A vector of available audio device IDs and names.
+     *
+     * The list is cached and only enumerated again after the MM notification client reported a device change.
+     *
+     * @return A map of available audio device IDs and names.
      */
-    std::map<int, std::string> AudioDeviceList();
+    const std::map<int, std::string>& AudioDeviceList() override;
 
     /**
      * @brief Starts audio capturing with the first available device.
+     *
+     * The device is opened asynchronously on the capture thread.
+     *
      * @param projectMHandle projectM instance handle that will receive the captured data.
      * @param audioDeviceIndex The initial audio device ID to capture from. Use -1 to select the implementation's
      *                      default device.
      */
-    void StartRecording(projectm* projectMHandle, int audioDeviceIndex);
+    void StartRecording(projectm* projectMHandle, int audioDeviceIndex) override;
 
     /**
      * @brief Stops audio recording.
+     *
+     * Waits for the capture thread to close the device and exit.
      */
-    void StopRecording();
+    void StopRecording() override;
 
     /**
      * @brief Switches to the next available audio recording device.
+     *
+     * Returns immediately, the capture thread switches the device in the background.
      */
-    void NextAudioDevice();
+    void NextAudioDevice() override;
 
     /**
      * @brief Activates the audio device with the given idnex for recording.
+     *
+     * Returns immediately, the capture thread switches the device in the background.
+     *
      * @param index The index, as listed by @a AudioDeviceList()
      */
-    void AudioDeviceIndex(int index);
+    void AudioDeviceIndex(int index) override;
 
     /**
      * @brief Returns the currently used Audio device index.
      * @return The index of the current audio device, as listed by @a AudioDeviceList()
      */
-    int AudioDeviceIndex() const;
+    int AudioDeviceIndex() const override;
 
     /**
      * @brief Retrieves the current audio device name.
      * @return The name of the currently selected audio recording device.
      */
-    std::string AudioDeviceName() const;
+    std::string AudioDeviceName() const override;
 
     /**
      * @brief Asks the capture client to fill projectM's audio buffer for the next frame.
      */
-    void FillBuffer();
+    void FillBuffer() override;
 
     /**
      * @brief Converts a widechar/unicode string to a UTF-8-encoded string
@@ -168,6 +191,15 @@ protected:
         bool _isRenderDevice{false}; //!< If true, the device is a render device and will be opened in loopback mode.
     };
 
+    /**
+     * @brief An entry of the cached device list.
+     */
+    struct DeviceEndpoint
+    {
+        std::wstring endpointId; //!< The opaque WASAPI endpoint ID.
+        bool isRenderDevice{false}; //!< If true, the device is a render device and will be opened in loopback mode.
+    };
+
     /**
      * @brief Creates a list of currently available audio devices.
      *
@@ -179,6 +211,33 @@ protected:
      */
     std::vector<AudioDevice> GetAudioDeviceList(IMMDeviceEnumerator* enumerator) const;
 
+    /**
+     * @brief Returns the cached device list, enumerating all devices again if it's outdated.
+     * @return A map of available audio device IDs and names.
+     */
+    const std::map<int, std::string>& CachedDeviceList() const;
+
+    /**
+     * @brief Returns the stable ID of a device.
+     *
+     * WASAPI enumerates devices in no particular order, so the list position of a device changes whenever devices are
+     * added or removed. Devices are identified by their endpoint ID instead.
+     *
+     * @param endpointId The device's endpoint ID.
+     * @return The ID assigned to the endpoint.
+     */
+    int DeviceIdForEndpoint(const std::wstring& endpointId) const;
+
+    /**
+     * @brief Asks the capture thread to switch to the audio device with the given ID.
+     *
+     * Returns immediately if the capture thread is running. Otherwise, e.g. on the first call, the thread is started.
+     *
+     * @param index The device ID, as listed by AudioDeviceList(), or -1 for the default device. Unknown IDs select
+     *              the default device.
+     */
+    void RequestAudioDevice(int index);
+
     /**
      * @brief Opens the given audio device in capture or loopback mode.
      *
@@ -205,7 +264,8 @@ protected:
      *
      * The capture thread also registers the MM notification callbacks, which enable us to react to hot-plug events.
      * The callback will trigger a loop restart inside the thread to reinitialize the current audio device if it has
-     * been affected by such an event. The thread itself is only restarted if the user switches audio devices manually.
+     * been affected by such an event. Switching audio devices manually restarts the loop the same way. If a device
+     * can't be opened, the thread keeps running and waits for another device to be selected.
      */
     void CaptureThread();
 
@@ -281,16 +341,30 @@ protected:
     Poco::Logger& _logger{Poco::Logger::get("AudioCapture.WASAPI")}; //!< The class logger.
 
     projectm* _projectMHandle{nullptr}; //!< Handle if the projectM instance that will receive the audio data.
-    int _currentAudioDeviceIndex{-1}; //!< Currently selected audio device index.
+    std::atomic_int _currentAudioDeviceIndex{-1}; //!< Currently selected audio device ID.
     IAudioClient* _audioClient{nullptr}; //!< Currently used audio client.
     IAudioCaptureClient* _audioCaptureClient{nullptr}; //!< Currently used capture client.
 
     LONG _referenceCount{0}; //!< COM IUnknown object reference counter
 
-    Poco::ActiveMethod<void, void, AudioCaptureImpl> _captureThread; //!< Active method running the capture thread.
+    Poco::ActiveMethod<void, void, AudioCaptureImpl_WASAPI> _captureThread; //!< Active method running the capture thread.
     Poco::ActiveResult<void> _captureThreadResult{new Poco::ActiveResultHolder<void>()};
+    bool _captureThreadStarted{false}; //!< True if the capture thread was started and not joined yet.
     std::string _currentCaptureDeviceId; //!< Current capture device ID. USed for checking if capturing needs restarting.
+    std::mutex _requestedAudioDeviceMutex; //!< Protects the requested device members below.
+    int _requestedAudioDeviceIndex{-1}; //!< Device ID the capture thread opens next, -1 for the default device.
+    std::wstring _requestedEndpointId; //!< Endpoint ID of the requested device. Empty for the default device.
+    std::string _requestedAudioDeviceName; //!< Display name of the requested device.
+    bool _requestedLoopback{true}; //!< If true, the requested device is opened in loopback mode.
     WORD _channels{0}; //!< Number of channels on the current capture device.
+    SampleConverter _sampleConverter; //!< Converts the device's mix format to stereo float samples.
+    std::vector<float> _conversionBuffer; //!< Converted stereo samples passed to projectM.
+
+    mutable std::map<int, std::string> _deviceList; //!< Cached list of available devices, by stable device ID.
+    mutable std::map<int, DeviceEndpoint> _deviceEndpoints; //!< Endpoints of the cached devices, by stable device ID.
+    mutable std::map<std::wstring, int> _deviceIds; //!< Stable IDs of all devices seen so far, by endpoint ID.
+    mutable int _nextDeviceId{0}; //!< The ID assigned to the next previously unknown device.
+    mutable std::atomic_bool _deviceListDirty{true}; //!< If true, the device list needs to be enumerated again.
 
     std::atomic_bool _isCapturing{false}; //!< If true, capturing is running. Capture thread will exit if set to false.
     std::atomic_bool _restartCapturing{false}; //!< If true, the capture thread will stop and restart capturing without exiting.
@@ -0,0 +1,23 @@
+#include "AudioFileDecoder.h"
+
+#include "FlacFileDecoder.h"
+#include "RawFileDecoder.h"
+#include "WavFileDecoder.h"
+
+#include <cstring>
+
+std::unique_ptr<AudioFileDecoder> AudioFileDecoder::Create(const char* data, size_t size,
+                                                           uint32_t rawSampleRate, uint32_t rawChannels)
+{
+    if (size >= 12 && std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data + 8, "WAVE", 4) == 0)
+    {
+        return std::make_unique<WavFileDecoder>(data, size);
+    }
+
+    if (size >= 4 && std::memcmp(data, "fLaC", 4) == 0)
+    {
+        return std::make_unique<FlacFileDecoder>(data, size);
+    }
+
+    return std::make_unique<RawFileDecoder>(data, size, rawSampleRate, rawChannels);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Base class for streaming audio file decoders.
+ *
+ * Decoders operate on a complete file image in memory, usually a memory-mapped file, and decode it incrementally
+ * into interleaved float samples. The memory must stay valid for the lifetime of the decoder.
+ *
+ * Decoders throw a Poco::DataFormatException if the file contents are invalid or unsupported.
+ */
+class AudioFileDecoder
+{
+public:
+    virtual ~AudioFileDecoder() = default;
+
+    /**
+     * @brief Creates a decoder for the given file contents.
+     *
+     * The format is detected from the file header. WAV and FLAC files are recognized by their signature, anything
+     * else is treated as headerless, interleaved 32-bit float PCM data.
+     *
+     * @param data Pointer to the file contents.
+     * @param size Size of the file contents in bytes.
+     * @param rawSampleRate Sample rate to assume for raw PCM data.
+     * @param rawChannels Number of channels to assume for raw PCM data.
+     * @return The decoder instance.
+     */
+    static std::unique_ptr<AudioFileDecoder> Create(const char* data, size_t size,
+                                                    uint32_t rawSampleRate, uint32_t rawChannels);
+
+    /**
+     * @brief Returns the name of the file format, for logging purposes.
+     * @return A short name of the file format.
+     */
+    virtual const char* FormatName() const = 0;
+
+    /**
+     * @brief Returns the sample rate of the decoded audio data.
+     * @return The sample rate in Hz.
+     */
+    virtual uint32_t SampleRate() const = 0;
+
+    /**
+     * @brief Returns the number of interleaved channels in the decoded audio data.
+     * @return The channel count.
+     */
+    virtual uint32_t Channels() const = 0;
+
+    /**
+     * @brief Decodes the next block of audio data.
+     * @param output Receives interleaved float samples. Must be able to hold frames times Channels() values.
+     * @param frames The maximum number of sample frames to decode.
+     * @return The number of frames decoded. Less than requested if the end of the file was reached.
+     */
+    virtual size_t Decode(float* output, size_t frames) = 0;
+
+    /**
+     * @brief Restarts decoding at the beginning of the audio data.
+     */
+    virtual void Rewind() = 0;
+};
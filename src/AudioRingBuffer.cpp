@@ -0,0 +1,81 @@
+#include "AudioRingBuffer.h"
+
+#include <algorithm>
+
+void AudioRingBuffer::Resize(size_t capacity)
+{
+    size_t size{1};
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    _buffer.assign(size, 0.0f);
+    _mask = size - 1;
+    _writeIndex.store(0, std::memory_order_relaxed);
+    _readIndex.store(0, std::memory_order_relaxed);
+}
+
+void AudioRingBuffer::Clear()
+{
+    _readIndex.store(_writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+bool AudioRingBuffer::Write(const float* samples, size_t count)
+{
+    auto writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    auto readIndex = _readIndex.load(std::memory_order_acquire);
+
+    if (count > _buffer.size() - (writeIndex - readIndex))
+    {
+        return false;
+    }
+
+    auto offset = writeIndex & _mask;
+    auto firstPart = std::min(count, _buffer.size() - offset);
+    std::copy(samples, samples + firstPart, _buffer.begin() + offset);
+    std::copy(samples + firstPart, samples + count, _buffer.begin());
+
+    _writeIndex.store(writeIndex + count, std::memory_order_release);
+
+    return true;
+}
+
+size_t AudioRingBuffer::Read(float* samples, size_t count)
+{
+    auto readIndex = _readIndex.load(std::memory_order_relaxed);
+    auto writeIndex = _writeIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, writeIndex - readIndex);
+
+    auto offset = readIndex & _mask;
+    auto firstPart = std::min(count, _buffer.size() - offset);
+    std::copy(_buffer.begin() + offset, _buffer.begin() + offset + firstPart, samples);
+    std::copy(_buffer.begin(), _buffer.begin() + (count - firstPart), samples + firstPart);
+
+    _readIndex.store(readIndex + count, std::memory_order_release);
+
+    return count;
+}
+
+size_t AudioRingBuffer::Discard(size_t count)
+{
+    auto readIndex = _readIndex.load(std::memory_order_relaxed);
+    auto writeIndex = _writeIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, writeIndex - readIndex);
+
+    _readIndex.store(readIndex + count, std::memory_order_release);
+
+    return count;
+}
+
+size_t AudioRingBuffer::Available() const
+{
+    return _writeIndex.load(std::memory_order_acquire) - _readIndex.load(std::memory_order_acquire);
+}
+
+size_t AudioRingBuffer::Capacity() const
+{
+    return _buffer.size();
+}
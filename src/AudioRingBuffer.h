@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring buffer for interleaved PCM samples.
+ *
+ * The producer (the audio driver's callback thread) only modifies the write index, while the consumer (the render
+ * thread) only modifies the read index. Neither side ever blocks or allocates memory, so it's safe to use from a
+ * real-time audio callback.
+ *
+ * Writes are all-or-nothing. If there's not enough free space, the new samples are dropped instead of partially
+ * written, which keeps the buffer aligned to whole sample frames.
+ */
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer() = default;
+
+    /**
+     * @brief Resizes the buffer and discards its contents.
+     *
+     * Must not be called while the producer or consumer are accessing the buffer.
+     *
+     * @param capacity Minimum number of samples the buffer should hold. Rounded up to the next power of two.
+     */
+    void Resize(size_t capacity);
+
+    /**
+     * @brief Discards all samples currently stored in the buffer.
+     *
+     * Only to be called from the consumer side.
+     */
+    void Clear();
+
+    /**
+     * @brief Appends samples to the buffer.
+     *
+     * Only to be called from the producer side.
+     *
+     * @param samples Pointer to the samples to store.
+     * @param count Number of samples to store.
+     * @return True if the samples were stored, false if there wasn't enough free space and the samples were dropped.
+     */
+    bool Write(const float* samples, size_t count);
+
+    /**
+     * @brief Removes samples from the buffer and copies them to the given location.
+     *
+     * Only to be called from the consumer side.
+     *
+     * @param samples Pointer to the destination buffer.
+     * @param count Maximum number of samples to read.
+     * @return The actual number of samples read, which may be less than the requested count.
+     */
+    size_t Read(float* samples, size_t count);
+
+    /**
+     * @brief Removes samples from the buffer without copying them anywhere.
+     *
+     * Only to be called from the consumer side.
+     *
+     * @param count Maximum number of samples to discard.
+     * @return The actual number of samples discarded.
+     */
+    size_t Discard(size_t count);
+
+    /**
+     * @brief Returns the number of samples available for reading.
+     * @return The number of samples that can currently be read.
+     */
+    size_t Available() const;
+
+    /**
+     * @brief Returns the maximum number of samples the buffer can hold.
+     * @return The buffer capacity in samples.
+     */
+    size_t Capacity() const;
+
+private:
+    std::vector<float> _buffer; //!< Sample storage, size is always a power of two.
+    size_t _mask{0}; //!< Bit mask to wrap the free-running indices into the sample storage.
+
+    std::atomic<size_t> _writeIndex{0}; //!< Free-running write position, only modified by the producer.
+    std::atomic<size_t> _readIndex{0}; //!< Free-running read position, only modified by the consumer.
+};
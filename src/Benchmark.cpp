@@ -0,0 +1,286 @@
+#include "Benchmark.h"
+
+#include "AudioCapture.h"
+#include "ProjectMWrapper.h"
+#include "SDLRenderingWindow.h"
+#include "TimingHistogram.h"
+
+#include <Poco/Clock.h>
+#include <Poco/Path.h>
+#include <Poco/String.h>
+
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+
+#include <Poco/Util/Application.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Quotes a string for use in a CSV file.
+ */
+std::string CsvQuote(const std::string& value)
+{
+    return "\"" + Poco::replace(value, "\"", "\"\"") + "\"";
+}
+
+} // namespace
+
+Benchmark::Benchmark()
+    : _audioCapture(Poco::Util::Application::instance().getSubsystem<AudioCapture>())
+    , _projectMWrapper(Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>())
+    , _sdlRenderingWindow(Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>())
+    , _projectMHandle(_projectMWrapper.ProjectM())
+    , _playlistHandle(_projectMWrapper.Playlist())
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _reportFileName = config.getString("benchmark.report", "benchmark.csv");
+    _presetDuration = std::max(config.getDouble("benchmark.presetDuration", 5.0), 0.1);
+    _firstPreset = config.getUInt("benchmark.firstPreset", 0);
+    _presetCount = config.getUInt("benchmark.presetCount", 0);
+
+    _jsonReport = Poco::icompare(Poco::Path(_reportFileName).getExtension(), "json") == 0;
+}
+
+void Benchmark::Run()
+{
+    // The benchmark needs the complete, sorted playlist.
+    _projectMWrapper.FinishPresetScan();
+
+    StartReport();
+
+    // Don't skip to the next preset on errors, as we need to know which one failed.
+    projectm_playlist_set_retry_count(_playlistHandle, 0);
+    projectm_playlist_set_preset_switch_failed_event_callback(_playlistHandle, &Benchmark::PresetSwitchFailedEvent, this);
+
+    uint32_t playlistSize = projectm_playlist_size(_playlistHandle);
+    uint32_t lastPreset = playlistSize;
+    if (_presetCount > 0)
+    {
+        lastPreset = std::min(playlistSize, _firstPreset + _presetCount);
+    }
+
+    uint32_t totalPresets = lastPreset > _firstPreset ? lastPreset - _firstPreset : 0;
+    poco_information_f3(_logger, "Benchmarking %?u of %?u presets for %.1f seconds each.",
+                        totalPresets, playlistSize, _presetDuration);
+
+    for (uint32_t index = _firstPreset; index < lastPreset && !_aborted; index++)
+    {
+        PresetResult result;
+        MeasurePreset(index, result);
+
+        if (_aborted)
+        {
+            break;
+        }
+
+        ReportPreset(result);
+
+        if (result.error.empty())
+        {
+            poco_information_f4(_logger, R"([%?u/%?u] "%s": mean %.2f ms)",
+                                index - _firstPreset + 1, totalPresets, Poco::Path(result.fileName).getFileName(),
+                                result.meanFrameTime);
+            poco_debug_f4(_logger, "Load %.2f ms, first frame %.2f ms, p99 %.2f ms, max %.2f ms.",
+                          result.loadTime, result.firstFrameTime, result.p99FrameTime, result.maxFrameTime);
+        }
+        else
+        {
+            poco_warning_f4(_logger, R"([%?u/%?u] "%s" failed to load: %s)",
+                            index - _firstPreset + 1, totalPresets, Poco::Path(result.fileName).getFileName(),
+                            result.error);
+        }
+    }
+
+    if (_aborted)
+    {
+        poco_information(_logger, "Benchmark aborted by user.");
+    }
+
+    projectm_playlist_set_preset_switch_failed_event_callback(_playlistHandle, nullptr, nullptr);
+
+    FinishReport();
+}
+
+void Benchmark::MeasurePreset(uint32_t index, PresetResult& result)
+{
+    result.index = index;
+
+    auto fileName = projectm_playlist_item(_playlistHandle, index);
+    if (fileName != nullptr)
+    {
+        result.fileName = fileName;
+        projectm_playlist_free_string(fileName);
+    }
+
+    _lastError.clear();
+
+    Poco::Clock loadStart;
+    projectm_playlist_set_position(_playlistHandle, index, true);
+    result.loadTime = static_cast<double>(loadStart.elapsed()) / 1000.0;
+
+    if (!_lastError.empty())
+    {
+        result.error = _lastError;
+        return;
+    }
+
+    Poco::Clock frameStart;
+    RenderFrame();
+    result.firstFrameTime = static_cast<double>(frameStart.elapsed()) / 1000.0;
+
+    TimingHistogram frameTimes;
+    Poco::Clock presetStart;
+    auto presetDuration = static_cast<Poco::Clock::ClockDiff>(_presetDuration * 1000000.0);
+
+    while (!presetStart.isElapsed(presetDuration))
+    {
+        if (AbortRequested())
+        {
+            return;
+        }
+
+        frameStart.update();
+        RenderFrame();
+        frameTimes.Record(static_cast<uint64_t>(frameStart.elapsed()));
+    }
+
+    result.frames = frameTimes.Count();
+    result.meanFrameTime = frameTimes.Mean() / 1000.0;
+    result.p50FrameTime = static_cast<double>(frameTimes.Percentile(50.0)) / 1000.0;
+    result.p95FrameTime = static_cast<double>(frameTimes.Percentile(95.0)) / 1000.0;
+    result.p99FrameTime = static_cast<double>(frameTimes.Percentile(99.0)) / 1000.0;
+    result.maxFrameTime = static_cast<double>(frameTimes.Max()) / 1000.0;
+}
+
+void Benchmark::RenderFrame()
+{
+    _audioCapture.FillBuffer();
+    _projectMWrapper.RenderFrame(_sdlRenderingWindow.Framebuffer());
+    _sdlRenderingWindow.Swap();
+
+    // Wait for the GPU, so the time of this frame isn't accounted to a later one.
+    glFinish();
+}
+
+bool Benchmark::AbortRequested()
+{
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event))
+    {
+        if (event.type == SDL_QUIT ||
+            (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE))
+        {
+            _aborted = true;
+        }
+    }
+
+    return _aborted;
+}
+
+void Benchmark::StartReport()
+{
+    _reportStream.open(_reportFileName, std::ios::out | std::ios::trunc);
+    if (!_reportStream.is_open())
+    {
+        poco_error_f1(_logger, R"(Could not open benchmark report file "%s" for writing.)", _reportFileName);
+        return;
+    }
+
+    if (!_jsonReport)
+    {
+        _reportStream << "index,preset,loadMs,firstFrameMs,frames,meanMs,p50Ms,p95Ms,p99Ms,maxMs,error" << std::endl;
+    }
+}
+
+void Benchmark::ReportPreset(const PresetResult& result)
+{
+    _reportedPresets++;
+
+    if (_jsonReport)
+    {
+        _results.push_back(result);
+        return;
+    }
+
+    if (!_reportStream.is_open())
+    {
+        return;
+    }
+
+    _reportStream << result.index << ","
+                  << CsvQuote(result.fileName) << ","
+                  << result.loadTime << ","
+                  << result.firstFrameTime << ","
+                  << result.frames << ","
+                  << result.meanFrameTime << ","
+                  << result.p50FrameTime << ","
+                  << result.p95FrameTime << ","
+                  << result.p99FrameTime << ","
+                  << result.maxFrameTime << ","
+                  << CsvQuote(result.error) << std::endl;
+}
+
+void Benchmark::FinishReport()
+{
+    if (!_reportStream.is_open())
+    {
+        return;
+    }
+
+    if (_jsonReport)
+    {
+        Poco::JSON::Object root(Poco::JSON_PRESERVE_KEY_ORDER);
+        root.set("presetDurationSeconds", _presetDuration);
+        root.set("aborted", _aborted);
+
+        // All times in milliseconds.
+        Poco::JSON::Array::Ptr presets = new Poco::JSON::Array;
+        for (const auto& result : _results)
+        {
+            Poco::JSON::Object::Ptr preset = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+            preset->set("index", result.index);
+            preset->set("preset", result.fileName);
+            preset->set("load", result.loadTime);
+            if (result.error.empty())
+            {
+                preset->set("firstFrame", result.firstFrameTime);
+                preset->set("frames", result.frames);
+                preset->set("mean", result.meanFrameTime);
+                preset->set("p50", result.p50FrameTime);
+                preset->set("p95", result.p95FrameTime);
+                preset->set("p99", result.p99FrameTime);
+                preset->set("max", result.maxFrameTime);
+            }
+            else
+            {
+                preset->set("error", result.error);
+            }
+            presets->add(preset);
+        }
+        root.set("presets", presets);
+
+        root.stringify(_reportStream, 2);
+        _reportStream << std::endl;
+    }
+
+    _reportStream.close();
+
+    poco_information_f2(_logger, R"(Wrote benchmark results for %?u presets to "%s".)",
+                        _reportedPresets, _reportFileName);
+}
+
+void Benchmark::PresetSwitchFailedEvent(const char* presetFilename, const char* message, void* context)
+{
+    auto that = reinterpret_cast<Benchmark*>(context);
+    that->_lastError = message != nullptr ? message : "Unknown error";
+
+    poco_debug_f2(that->_logger, R"(Failed to load preset "%s": %s)",
+                  std::string(presetFilename != nullptr ? presetFilename : ""), that->_lastError);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <projectM-4/projectM.h>
+#include <projectM-4/playlist.h>
+
+#include <Poco/Logger.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class AudioCapture;
+class ProjectMWrapper;
+class SDLRenderingWindow;
+
+/**
+ * @brief Renders each playlist preset for a fixed time and reports its frame cost.
+ *
+ * Replaces the regular render loop if the application was started with --benchmark. The application then renders
+ * with unlimited FPS and vsync disabled, receives audio from the deterministic synthetic audio backend and never
+ * switches presets on its own, so results are comparable between runs and machines.
+ *
+ * For each preset, the time to load it, the time of the first frame (which includes shader compilation) and the
+ * distribution of all subsequent frame times are reported. Each frame is finished with glFinish(), so the GPU time
+ * is attributed to the preset which caused it.
+ *
+ * The report is written as JSON if the file name ends with ".json", and as CSV otherwise. CSV rows are written as
+ * soon as a preset is done, so partial results survive a crash caused by a broken preset.
+ */
+class Benchmark
+{
+public:
+    Benchmark();
+
+    /**
+     * @brief Runs the benchmark and writes the report.
+     *
+     * Returns early if the window is closed or the escape key is pressed. The report then contains all presets
+     * measured so far.
+     */
+    void Run();
+
+protected:
+    /**
+     * @brief Results of a single preset.
+     */
+    struct PresetResult
+    {
+        uint32_t index{0}; //!< Playlist index of the preset.
+        std::string fileName; //!< Full path of the preset file.
+        double loadTime{0.0}; //!< Time to load and switch to the preset, in milliseconds.
+        double firstFrameTime{0.0}; //!< Time of the first frame, including shader compilation, in milliseconds.
+        uint64_t frames{0}; //!< Number of measured frames, excluding the first one.
+        double meanFrameTime{0.0}; //!< Mean frame time in milliseconds.
+        double p50FrameTime{0.0}; //!< Median frame time in milliseconds.
+        double p95FrameTime{0.0}; //!< 95th percentile frame time in milliseconds.
+        double p99FrameTime{0.0}; //!< 99th percentile frame time in milliseconds.
+        double maxFrameTime{0.0}; //!< Longest frame time in milliseconds.
+        std::string error; //!< Error message if the preset failed to load, empty otherwise.
+    };
+
+    /**
+     * @brief Loads and renders a single preset.
+     * @param index The playlist index of the preset.
+     * @param result Receives the measured timings.
+     */
+    void MeasurePreset(uint32_t index, PresetResult& result);
+
+    /**
+     * @brief Renders a single frame and waits until the GPU has finished it.
+     */
+    void RenderFrame();
+
+    /**
+     * @brief Polls SDL events and checks if the benchmark should be aborted.
+     *
+     * Called every frame to keep the window responsive.
+     *
+     * @return True if the user closed the window or pressed escape.
+     */
+    bool AbortRequested();
+
+    /**
+     * @brief Opens the report file and writes the CSV header if required.
+     */
+    void StartReport();
+
+    /**
+     * @brief Adds a single preset to the report.
+     * @param result The preset result.
+     */
+    void ReportPreset(const PresetResult& result);
+
+    /**
+     * @brief Writes the JSON report, if JSON is used, and closes the report file.
+     */
+    void FinishReport();
+
+    /**
+     * @brief projectM playlist callback. Called if a preset couldn't be loaded.
+     * @param presetFilename The file name of the failed preset.
+     * @param message The error message.
+     * @param context Callback context, e.g. "this" pointer.
+     */
+    static void PresetSwitchFailedEvent(const char* presetFilename, const char* message, void* context);
+
+    AudioCapture& _audioCapture;
+    ProjectMWrapper& _projectMWrapper;
+    SDLRenderingWindow& _sdlRenderingWindow;
+
+    projectm_handle _projectMHandle{nullptr};
+    projectm_playlist_handle _playlistHandle{nullptr};
+
+    std::string _reportFileName; //!< File name of the report.
+    bool _jsonReport{false}; //!< If true, the report is written as JSON, otherwise as CSV.
+    std::ofstream _reportStream; //!< The report file.
+    std::vector<PresetResult> _results; //!< Results of all presets, only kept for the JSON report.
+    uint32_t _reportedPresets{0}; //!< Number of presets added to the report.
+
+    double _presetDuration{5.0}; //!< Time to render each preset, in seconds.
+    uint32_t _firstPreset{0}; //!< Playlist index of the first preset to measure.
+    uint32_t _presetCount{0}; //!< Number of presets to measure. 0 measures all remaining presets.
+
+    std::string _lastError; //!< Error message of the last failed preset switch.
+    bool _aborted{false}; //!< True if the user requested to abort the benchmark.
+
+    Poco::Logger& _logger{Poco::Logger::get("Benchmark")}; //!< The class logger.
+};
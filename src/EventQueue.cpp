@@ -0,0 +1,104 @@
+#include "EventQueue.h"
+
+EventQueue::EventQueue(size_t capacity)
+{
+    size_t size{1};
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    _buffer.resize(size);
+    _mask = size - 1;
+}
+
+void EventQueue::Push(const SDL_Event& event)
+{
+    // Keep the order: once events are waiting in the overflow list, new events have to queue up behind them.
+    if (Flush() && PushToRing(event))
+    {
+        return;
+    }
+
+    if (event.type == SDL_MOUSEMOTION && !_overflow.empty() && _overflow.back().type == SDL_MOUSEMOTION &&
+        _overflow.back().motion.windowID == event.motion.windowID && _overflow.back().motion.which == event.motion.which)
+    {
+        auto& motion = _overflow.back().motion;
+        motion.timestamp = event.motion.timestamp;
+        motion.state = event.motion.state;
+        motion.x = event.motion.x;
+        motion.y = event.motion.y;
+        motion.xrel += event.motion.xrel;
+        motion.yrel += event.motion.yrel;
+        return;
+    }
+
+    _overflow.push_back(event);
+}
+
+bool EventQueue::Flush()
+{
+    while (!_overflow.empty())
+    {
+        if (!PushToRing(_overflow.front()))
+        {
+            return false;
+        }
+        _overflow.pop_front();
+    }
+
+    return true;
+}
+
+bool EventQueue::Pop(SDL_Event& event)
+{
+    auto readIndex = _readIndex.load(std::memory_order_relaxed);
+    auto writeIndex = _writeIndex.load(std::memory_order_acquire);
+
+    if (readIndex == writeIndex)
+    {
+        return false;
+    }
+
+    event = _buffer[readIndex & _mask];
+    _readIndex.store(readIndex + 1, std::memory_order_release);
+
+    return true;
+}
+
+void EventQueue::PublishWindowState(const WindowState& windowState)
+{
+    std::lock_guard<std::mutex> lock(_windowStateMutex);
+    _windowState = windowState;
+    _windowStateChanged = true;
+}
+
+bool EventQueue::TakeWindowState(WindowState& windowState)
+{
+    std::lock_guard<std::mutex> lock(_windowStateMutex);
+    if (!_windowStateChanged)
+    {
+        return false;
+    }
+
+    windowState = _windowState;
+    _windowStateChanged = false;
+
+    return true;
+}
+
+bool EventQueue::PushToRing(const SDL_Event& event)
+{
+    auto writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    auto readIndex = _readIndex.load(std::memory_order_acquire);
+
+    if (writeIndex - readIndex >= _buffer.size())
+    {
+        return false;
+    }
+
+    _buffer[writeIndex & _mask] = event;
+    _writeIndex.store(writeIndex + 1, std::memory_order_release);
+
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "WindowState.h"
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Lock-free single-producer/single-consumer queue passing SDL events to the render thread.
+ *
+ * The producer (the main thread running the SDL event loop) only modifies the write index, while the consumer (the
+ * render thread) only modifies the read index. Neither side ever waits for the other, so a busy window manager can't
+ * stall rendering and a slow frame can't stall event processing.
+ *
+ * Events are never dropped. If the render thread falls behind and the ring is full, the producer keeps further events
+ * in an overflow list and moves them into the ring as soon as there's space again. Consecutive mouse motion events in
+ * the overflow list are coalesced into one, so a stalled render thread doesn't accumulate thousands of them.
+ *
+ * Besides events, the queue passes the latest WindowState from the main thread to the render thread.
+ */
+class EventQueue
+{
+public:
+    /**
+     * @brief Creates the queue.
+     * @param capacity Minimum number of events the queue can hold. Rounded up to the next power of two.
+     */
+    explicit EventQueue(size_t capacity = 1024);
+
+    /**
+     * @brief Appends an event to the queue.
+     *
+     * Only to be called from the producer side. If the ring is full, the event is stored in the overflow list.
+     *
+     * @param event The event to store.
+     */
+    void Push(const SDL_Event& event);
+
+    /**
+     * @brief Moves as many events from the overflow list into the ring as possible.
+     *
+     * Only to be called from the producer side.
+     *
+     * @return True if all events are in the ring, false if some are still waiting in the overflow list.
+     */
+    bool Flush();
+
+    /**
+     * @brief Removes the oldest event from the queue.
+     *
+     * Only to be called from the consumer side.
+     *
+     * @param event Receives the event.
+     * @return True if an event was returned, false if the queue is empty.
+     */
+    bool Pop(SDL_Event& event);
+
+    /**
+     * @brief Stores a new window state for the consumer.
+     *
+     * Only to be called from the producer side.
+     *
+     * @param windowState The current window state.
+     */
+    void PublishWindowState(const WindowState& windowState);
+
+    /**
+     * @brief Returns the latest window state if it was changed since the last call.
+     *
+     * Only to be called from the consumer side.
+     *
+     * @param windowState Receives the window state.
+     * @return True if a new window state was returned, false if it's unchanged.
+     */
+    bool TakeWindowState(WindowState& windowState);
+
+private:
+    /**
+     * @brief Writes an event into the ring if there's space.
+     * @param event The event to store.
+     * @return True if the event was stored, false if the ring is full.
+     */
+    bool PushToRing(const SDL_Event& event);
+
+    std::vector<SDL_Event> _buffer; //!< Event storage, size is always a power of two.
+    size_t _mask{0}; //!< Bit mask to wrap the free-running indices into the event storage.
+
+    std::atomic<size_t> _writeIndex{0}; //!< Free-running write position, only modified by the producer.
+    std::atomic<size_t> _readIndex{0}; //!< Free-running read position, only modified by the consumer.
+
+    std::deque<SDL_Event> _overflow; //!< Events which didn't fit into the ring, only accessed by the producer.
+
+    std::mutex _windowStateMutex; //!< Protects the window state. Only held while copying it.
+    WindowState _windowState; //!< The latest window state published by the producer.
+    bool _windowStateChanged{false}; //!< True if the window state was published, but not taken yet.
+};
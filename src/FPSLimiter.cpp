@@ -2,21 +2,48 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+
+namespace {
+
+constexpr uint64_t NanosecondsPerSecond{ 1000000000 };
+constexpr uint64_t NanosecondsPerMillisecond{ 1000000 };
+
+constexpr uint64_t MinSpinThreshold{ 200000 }; //!< Always spin for at least 0.2 ms.
+constexpr uint64_t MaxSpinThreshold{ 4000000 }; //!< Never spin for more than 4 ms, even if the scheduler is very coarse.
+
+} // namespace
+
+FPSLimiter::FPSLimiter()
+    : _counterFrequency(std::max<uint64_t>(SDL_GetPerformanceFrequency(), 1))
+{
+}
+
 void FPSLimiter::TargetFPS(int fps)
 {
-    if (fps)
+    if (fps == _targetFps)
     {
-        _targetFrameTime = 1000 / fps;
+        return;
+    }
+
+    _targetFps = fps;
+
+    if (fps > 0)
+    {
+        _targetFrameTime = NanosecondsPerSecond / static_cast<uint64_t>(fps);
     }
     else
     {
         _targetFrameTime = 0;
     }
+
+    // Start a new schedule with the next frame.
+    _nextFrameDeadline = 0;
 }
 
 float FPSLimiter::FPS() const
 {
-    uint32_t frameTimeSum{ 0 };
+    uint64_t frameTimeSum{ 0 };
     uint32_t frameTimeCount{ 0 };
 
     for (auto _lastFrameTime : _lastFrameTimes)
@@ -33,24 +60,108 @@ float FPSLimiter::FPS() const
         return 0.0f;
     }
 
-   return 1000.0f / (static_cast<float>(frameTimeSum) / static_cast<float>(frameTimeCount));
+    return static_cast<float>(static_cast<double>(NanosecondsPerSecond) * frameTimeCount / static_cast<double>(frameTimeSum));
 }
 
 void FPSLimiter::StartFrame()
 {
-    _lastTickCount = SDL_GetTicks();
+    auto now = Now();
+
+    // Measure from frame start to frame start, so the time spent outside of the frame is included.
+    if (_frameStartTime > 0)
+    {
+        _lastFrameTimes[_nextFrameTimesOffset] = now - _frameStartTime;
+        _nextFrameTimesOffset = (_nextFrameTimesOffset + 1) % 10;
+    }
+
+    _frameStartTime = now;
+
+    if (_targetFrameTime == 0)
+    {
+        _nextFrameDeadline = 0;
+        return;
+    }
+
+    // If the last frame took more than a whole frame longer than targeted, start a new schedule instead of
+    // rendering several frames as fast as possible to catch up.
+    if (_nextFrameDeadline == 0 || now > _nextFrameDeadline + _targetFrameTime)
+    {
+        _nextFrameDeadline = now;
+    }
+
+    _nextFrameDeadline += _targetFrameTime;
 }
 
 void FPSLimiter::EndFrame()
 {
-    uint32_t frameTime = SDL_GetTicks() - _lastTickCount;
+    if (_nextFrameDeadline > 0)
+    {
+        WaitUntil(_nextFrameDeadline);
+    }
+}
 
-    if (_targetFrameTime && frameTime < _targetFrameTime)
+void FPSLimiter::EndWork()
+{
+    _lastWorkTime = Now() - _frameStartTime;
+}
+
+uint64_t FPSLimiter::LastWorkTime() const
+{
+    return _lastWorkTime;
+}
+
+uint64_t FPSLimiter::LastFrameTime() const
+{
+    return _lastFrameTimes[(_nextFrameTimesOffset + 9) % 10];
+}
+
+uint64_t FPSLimiter::TargetFrameTime() const
+{
+    return _targetFrameTime;
+}
+
+uint64_t FPSLimiter::Now() const
+{
+    // Split the conversion to prevent overflows with high counter frequencies.
+    uint64_t counter = SDL_GetPerformanceCounter();
+    return (counter / _counterFrequency) * NanosecondsPerSecond +
+           (counter % _counterFrequency) * NanosecondsPerSecond / _counterFrequency;
+}
+
+void FPSLimiter::WaitUntil(uint64_t deadline)
+{
+    auto now = Now();
+
+    while (now < deadline && deadline - now > _spinThreshold)
     {
-        SDL_Delay(_targetFrameTime - frameTime);
-        frameTime = SDL_GetTicks() - _lastTickCount;
+        auto sleepTime = (deadline - now - _spinThreshold) / NanosecondsPerMillisecond;
+        if (sleepTime == 0)
+        {
+            break;
+        }
+
+        SDL_Delay(static_cast<uint32_t>(sleepTime));
+
+        auto afterSleep = Now();
+        auto requested = sleepTime * NanosecondsPerMillisecond;
+        auto overshoot = afterSleep - now > requested ? afterSleep - now - requested : 0;
+        now = afterSleep;
+
+        // Adapt quickly if the scheduler oversleeps more than expected, and slowly approach the typical overshoot
+        // otherwise, so a single outlier doesn't cause spinning for a long time.
+        if (overshoot > _spinThreshold)
+        {
+            _spinThreshold = overshoot;
+        }
+        else
+        {
+            _spinThreshold -= (_spinThreshold - overshoot) / 16;
+        }
+        _spinThreshold = std::min(std::max(_spinThreshold, MinSpinThreshold), MaxSpinThreshold);
     }
 
-    _lastFrameTimes[_nextFrameTimesOffset] = frameTime;
-    _nextFrameTimesOffset = (_nextFrameTimesOffset + 1) % 10;
+    while (now < deadline)
+    {
+        now = Now();
+    }
 }
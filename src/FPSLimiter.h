@@ -4,10 +4,18 @@
 
 /**
  * @brief Limits FPS by adding a delay if necessary. Also keeps track of actual FPS.
+ *
+ * Uses SDL's high-resolution performance counter with nanosecond frame deadlines. Each deadline is derived from the
+ * previous one, not from the time the frame actually ended, so rounding errors and oversleeping don't accumulate.
+ *
+ * To wait for the deadline, the limiter first sleeps for most of the remaining time, then spins for the last part.
+ * The spin duration is calibrated by measuring how much the OS scheduler oversleeps.
  */
 class FPSLimiter
 {
 public:
+    FPSLimiter();
+
     /**
      * @brief Sets the target frames per second value.
      * @param fps The targeted frames per second. Set to 0 for unlimited FPS.
@@ -26,24 +34,67 @@ public:
     /**
      * @brief Marks the start of a new frame.
      *
-     * Should be the first call in the render loop.
+     * Should be the first call in the render loop. Also records the time since the previous frame was started
+     * for FPS calculation.
      */
     void StartFrame();
 
     /**
      * @brief Marks the end of a frame.
      *
-     * Will pause if required to lower FPS to target value. Also records the last frame time for FPS calculation.
+     * Will pause until the frame's deadline if required to lower FPS to target value.
      */
     void EndFrame();
 
+    /**
+     * @brief Marks the end of the rendering work in the current frame.
+     *
+     * Should be called before swapping buffers, as the swap may block until the next vertical blank.
+     */
+    void EndWork();
+
+    /**
+     * @brief Returns the time spent rendering the last frame.
+     * @return The time between StartFrame() and EndWork() of the last frame in nanoseconds.
+     */
+    uint64_t LastWorkTime() const;
+
+    /**
+     * @brief Returns the actual duration of the last frame.
+     * @return The time between the starts of the last two frames in nanoseconds, including the limiting delay.
+     */
+    uint64_t LastFrameTime() const;
+
+    /**
+     * @brief Returns the targeted time per frame.
+     * @return The targeted time per frame in nanoseconds, or 0 if FPS are unlimited.
+     */
+    uint64_t TargetFrameTime() const;
+
 protected:
+    /**
+     * @brief Returns the current performance counter value in nanoseconds.
+     * @return A monotonic timestamp in nanoseconds.
+     */
+    uint64_t Now() const;
 
-    uint32_t _lastTickCount{ 0 }; //!< Last SDL tick count, when a new frame was started.
-    uint32_t _targetFrameTime{ 0 }; //!< Targeted time per frame in milliseconds.
-    uint32_t _lastFrameTimes[10]{}; //!< Actual tick time of the last ten frames, including limiting delay.
+    /**
+     * @brief Waits until the given deadline.
+     *
+     * Sleeps until the remaining time is below the calibrated spin threshold, then spins until the deadline.
+     *
+     * @param deadline The timestamp to wait for, in nanoseconds.
+     */
+    void WaitUntil(uint64_t deadline);
+
+    uint64_t _counterFrequency{ 1 }; //!< Performance counter ticks per second.
+    int _targetFps{ 0 }; //!< Currently targeted FPS value.
+    uint64_t _targetFrameTime{ 0 }; //!< Targeted time per frame in nanoseconds.
+    uint64_t _frameStartTime{ 0 }; //!< Timestamp when the current frame was started, in nanoseconds.
+    uint64_t _lastWorkTime{ 0 }; //!< Time between frame start and EndWork() in the last frame, in nanoseconds.
+    uint64_t _nextFrameDeadline{ 0 }; //!< Timestamp when the current frame should end, in nanoseconds. 0 if not yet scheduled.
+    uint64_t _spinThreshold{ 2000000 }; //!< Remaining time in nanoseconds below which the limiter spins instead of sleeping.
+    uint64_t _lastFrameTimes[10]{}; //!< Actual time between the starts of the last ten frames in nanoseconds, including limiting delay.
     int _nextFrameTimesOffset{ 0 }; //!< Next offset to overwrite the _lastFrameTimes ring buffer.
 
 };
-
-
@@ -0,0 +1,559 @@
+#include "FlacFileDecoder.h"
+
+#include <Poco/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Reads big-endian bit fields from a FLAC stream.
+ */
+class BitReader
+{
+public:
+    BitReader(const uint8_t* data, size_t size, size_t byteOffset)
+        : _data(data)
+        , _bitCount(size * 8)
+        , _bitPosition(byteOffset * 8)
+    {
+    }
+
+    /**
+     * @brief Reads an unsigned value.
+     * @param count Number of bits to read, 0 to 56.
+     * @return The value.
+     */
+    uint64_t ReadBits(uint32_t count)
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        if (_bitPosition + count > _bitCount)
+        {
+            throw Poco::DataFormatException("Unexpected end of FLAC stream");
+        }
+
+        auto bytePosition = _bitPosition >> 3;
+        auto bitOffset = static_cast<uint32_t>(_bitPosition & 7);
+        auto byteCount = (bitOffset + count + 7) / 8;
+
+        uint64_t value{0};
+        for (uint32_t byte = 0; byte < byteCount; byte++)
+        {
+            value = (value << 8) | _data[bytePosition + byte];
+        }
+
+        value >>= byteCount * 8 - bitOffset - count;
+        value &= (uint64_t(1) << count) - 1;
+
+        _bitPosition += count;
+
+        return value;
+    }
+
+    /**
+     * @brief Reads a two's complement signed value.
+     * @param count Number of bits to read, 1 to 56.
+     * @return The sign-extended value.
+     */
+    int64_t ReadSigned(uint32_t count)
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        auto value = ReadBits(count);
+        if (value & (uint64_t(1) << (count - 1)))
+        {
+            return static_cast<int64_t>(value) - (int64_t(1) << count);
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    /**
+     * @brief Reads a unary coded value, e.g. the number of zero bits before the next one bit.
+     * @return The number of zero bits.
+     */
+    uint32_t ReadUnary()
+    {
+        uint32_t count{0};
+        while (ReadBits(1) == 0)
+        {
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Reads a zig-zag encoded Rice code with the given parameter.
+     * @param parameter The Rice parameter.
+     * @return The decoded signed value.
+     */
+    int64_t ReadRice(uint32_t parameter)
+    {
+        uint64_t value = (static_cast<uint64_t>(ReadUnary()) << parameter) | ReadBits(parameter);
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    void AlignToByte()
+    {
+        _bitPosition = (_bitPosition + 7) & ~size_t(7);
+    }
+
+    size_t BytePosition() const
+    {
+        return _bitPosition >> 3;
+    }
+
+private:
+    const uint8_t* _data; //!< Stream data.
+    size_t _bitCount; //!< Stream size in bits.
+    size_t _bitPosition; //!< Current read position in bits.
+};
+
+void DecodeResidual(BitReader& reader, int64_t* samples, uint32_t blockSize, uint32_t order)
+{
+    auto codingMethod = reader.ReadBits(2);
+    if (codingMethod > 1)
+    {
+        throw Poco::DataFormatException("Reserved FLAC residual coding method");
+    }
+
+    uint32_t parameterBits = codingMethod == 0 ? 4 : 5;
+    uint32_t escapeCode = codingMethod == 0 ? 15 : 31;
+
+    auto partitionOrder = static_cast<uint32_t>(reader.ReadBits(4));
+    uint32_t partitionSamples = blockSize >> partitionOrder;
+    if ((partitionSamples << partitionOrder) != blockSize || partitionSamples < order)
+    {
+        throw Poco::DataFormatException("Invalid FLAC residual partition order");
+    }
+
+    uint32_t sampleIndex{order};
+    for (uint32_t partition = 0; partition < (1U << partitionOrder); partition++)
+    {
+        uint32_t count = partition == 0 ? partitionSamples - order : partitionSamples;
+        auto parameter = static_cast<uint32_t>(reader.ReadBits(parameterBits));
+
+        if (parameter == escapeCode)
+        {
+            auto bits = static_cast<uint32_t>(reader.ReadBits(5));
+            for (uint32_t sample = 0; sample < count; sample++)
+            {
+                samples[sampleIndex++] = reader.ReadSigned(bits);
+            }
+        }
+        else
+        {
+            for (uint32_t sample = 0; sample < count; sample++)
+            {
+                samples[sampleIndex++] = reader.ReadRice(parameter);
+            }
+        }
+    }
+}
+
+void DecodeSubframe(BitReader& reader, int64_t* samples, uint32_t blockSize, uint32_t bitsPerSample)
+{
+    if (reader.ReadBits(1) != 0)
+    {
+        throw Poco::DataFormatException("Invalid FLAC subframe padding");
+    }
+
+    auto type = static_cast<uint32_t>(reader.ReadBits(6));
+
+    uint32_t wastedBits{0};
+    if (reader.ReadBits(1) != 0)
+    {
+        wastedBits = reader.ReadUnary() + 1;
+        if (wastedBits >= bitsPerSample)
+        {
+            throw Poco::DataFormatException("Invalid FLAC wasted bits count");
+        }
+        bitsPerSample -= wastedBits;
+    }
+
+    if (type == 0)
+    {
+        // Constant
+        auto value = reader.ReadSigned(bitsPerSample);
+        for (uint32_t sample = 0; sample < blockSize; sample++)
+        {
+            samples[sample] = value;
+        }
+    }
+    else if (type == 1)
+    {
+        // Verbatim
+        for (uint32_t sample = 0; sample < blockSize; sample++)
+        {
+            samples[sample] = reader.ReadSigned(bitsPerSample);
+        }
+    }
+    else if (type >= 8 && type <= 12)
+    {
+        // Fixed linear predictor
+        uint32_t order = type - 8;
+        if (order > blockSize)
+        {
+            throw Poco::DataFormatException("FLAC predictor order exceeds block size");
+        }
+
+        for (uint32_t sample = 0; sample < order; sample++)
+        {
+            samples[sample] = reader.ReadSigned(bitsPerSample);
+        }
+
+        DecodeResidual(reader, samples, blockSize, order);
+
+        for (uint32_t sample = order; sample < blockSize; sample++)
+        {
+            switch (order)
+            {
+                case 1:
+                    samples[sample] += samples[sample - 1];
+                    break;
+                case 2:
+                    samples[sample] += 2 * samples[sample - 1] - samples[sample - 2];
+                    break;
+                case 3:
+                    samples[sample] += 3 * samples[sample - 1] - 3 * samples[sample - 2] + samples[sample - 3];
+                    break;
+                case 4:
+                    samples[sample] += 4 * samples[sample - 1] - 6 * samples[sample - 2] + 4 * samples[sample - 3] - samples[sample - 4];
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    else if (type >= 32)
+    {
+        // Linear predictive coding
+        uint32_t order = (type & 31) + 1;
+        if (order > blockSize)
+        {
+            throw Poco::DataFormatException("FLAC predictor order exceeds block size");
+        }
+
+        for (uint32_t sample = 0; sample < order; sample++)
+        {
+            samples[sample] = reader.ReadSigned(bitsPerSample);
+        }
+
+        auto precision = static_cast<uint32_t>(reader.ReadBits(4));
+        if (precision == 15)
+        {
+            throw Poco::DataFormatException("Invalid FLAC LPC coefficient precision");
+        }
+        precision++;
+
+        auto shift = reader.ReadSigned(5);
+        if (shift < 0)
+        {
+            throw Poco::DataFormatException("Negative FLAC LPC shift");
+        }
+
+        int64_t coefficients[32];
+        for (uint32_t coefficient = 0; coefficient < order; coefficient++)
+        {
+            coefficients[coefficient] = reader.ReadSigned(precision);
+        }
+
+        DecodeResidual(reader, samples, blockSize, order);
+
+        for (uint32_t sample = order; sample < blockSize; sample++)
+        {
+            int64_t prediction{0};
+            for (uint32_t coefficient = 0; coefficient < order; coefficient++)
+            {
+                prediction += coefficients[coefficient] * samples[sample - 1 - coefficient];
+            }
+            samples[sample] += prediction >> shift;
+        }
+    }
+    else
+    {
+        throw Poco::DataFormatException("Reserved FLAC subframe type");
+    }
+
+    if (wastedBits > 0)
+    {
+        for (uint32_t sample = 0; sample < blockSize; sample++)
+        {
+            samples[sample] *= int64_t(1) << wastedBits;
+        }
+    }
+}
+
+} // namespace
+
+FlacFileDecoder::FlacFileDecoder(const char* data, size_t size)
+    : _data(reinterpret_cast<const uint8_t*>(data))
+    , _size(size)
+{
+    if (size < 4 || std::memcmp(data, "fLaC", 4) != 0)
+    {
+        throw Poco::DataFormatException("Not a FLAC file");
+    }
+
+    size_t offset{4};
+    bool lastBlock{false};
+    bool streamInfoFound{false};
+    uint32_t maxBlockSize{0};
+
+    while (!lastBlock)
+    {
+        if (offset + 4 > size)
+        {
+            throw Poco::DataFormatException("Unexpected end of FLAC metadata");
+        }
+
+        lastBlock = (_data[offset] & 0x80) != 0;
+        auto blockType = _data[offset] & 0x7F;
+        size_t blockLength = (static_cast<size_t>(_data[offset + 1]) << 16) | (static_cast<size_t>(_data[offset + 2]) << 8) | _data[offset + 3];
+
+        if (blockType == 0 && blockLength >= 18 && offset + 4 + 18 <= size)
+        {
+            BitReader reader(_data, size, offset + 4);
+            reader.ReadBits(16); // Minimum block size
+            maxBlockSize = static_cast<uint32_t>(reader.ReadBits(16));
+            reader.ReadBits(24); // Minimum frame size
+            reader.ReadBits(24); // Maximum frame size
+            _sampleRate = static_cast<uint32_t>(reader.ReadBits(20));
+            _channels = static_cast<uint32_t>(reader.ReadBits(3)) + 1;
+            _bitsPerSample = static_cast<uint32_t>(reader.ReadBits(5)) + 1;
+            streamInfoFound = true;
+        }
+
+        offset += 4 + blockLength;
+    }
+
+    if (!streamInfoFound || _sampleRate == 0)
+    {
+        throw Poco::DataFormatException("FLAC file has no valid stream info");
+    }
+
+    _firstFrameOffset = offset;
+    _nextFrameOffset = offset;
+
+    _subframeSamples.resize(static_cast<size_t>(maxBlockSize) * _channels);
+    _frameBuffer.resize(static_cast<size_t>(maxBlockSize) * _channels);
+}
+
+const char* FlacFileDecoder::FormatName() const
+{
+    return "FLAC";
+}
+
+uint32_t FlacFileDecoder::SampleRate() const
+{
+    return _sampleRate;
+}
+
+uint32_t FlacFileDecoder::Channels() const
+{
+    return _channels;
+}
+
+size_t FlacFileDecoder::Decode(float* output, size_t frames)
+{
+    size_t framesDecoded{0};
+
+    while (framesDecoded < frames)
+    {
+        if (_frameBufferPosition >= _frameBufferFrames && !DecodeFrame())
+        {
+            break;
+        }
+
+        size_t count = std::min(frames - framesDecoded, _frameBufferFrames - _frameBufferPosition);
+        std::memcpy(output + framesDecoded * _channels,
+                    _frameBuffer.data() + _frameBufferPosition * _channels,
+                    count * _channels * sizeof(float));
+
+        framesDecoded += count;
+        _frameBufferPosition += count;
+    }
+
+    return framesDecoded;
+}
+
+void FlacFileDecoder::Rewind()
+{
+    _nextFrameOffset = _firstFrameOffset;
+    _frameBufferFrames = 0;
+    _frameBufferPosition = 0;
+}
+
+bool FlacFileDecoder::DecodeFrame()
+{
+    while (true)
+    {
+        // Find the next frame sync code (14 bits set, followed by a zero bit).
+        while (_nextFrameOffset + 2 <= _size &&
+               !(_data[_nextFrameOffset] == 0xFF && (_data[_nextFrameOffset + 1] & 0xFE) == 0xF8))
+        {
+            _nextFrameOffset++;
+        }
+
+        if (_nextFrameOffset + 2 > _size)
+        {
+            return false;
+        }
+
+        try
+        {
+            BitReader reader(_data, _size, _nextFrameOffset);
+
+            reader.ReadBits(16); // Sync code, reserved bit and blocking strategy
+
+            auto blockSizeCode = static_cast<uint32_t>(reader.ReadBits(4));
+            auto sampleRateCode = static_cast<uint32_t>(reader.ReadBits(4));
+            auto channelAssignment = static_cast<uint32_t>(reader.ReadBits(4));
+            auto sampleSizeCode = static_cast<uint32_t>(reader.ReadBits(3));
+            reader.ReadBits(1); // Reserved
+
+            // Skip the UTF-8 coded frame or sample number.
+            auto firstByte = static_cast<uint32_t>(reader.ReadBits(8));
+            uint32_t additionalBytes{0};
+            while (additionalBytes < 7 && (firstByte & (0x80 >> additionalBytes)) != 0)
+            {
+                additionalBytes++;
+            }
+            for (uint32_t byte = 1; byte < additionalBytes; byte++)
+            {
+                reader.ReadBits(8);
+            }
+
+            uint32_t blockSize{0};
+            if (blockSizeCode == 1)
+            {
+                blockSize = 192;
+            }
+            else if (blockSizeCode >= 2 && blockSizeCode <= 5)
+            {
+                blockSize = 576U << (blockSizeCode - 2);
+            }
+            else if (blockSizeCode == 6)
+            {
+                blockSize = static_cast<uint32_t>(reader.ReadBits(8)) + 1;
+            }
+            else if (blockSizeCode == 7)
+            {
+                blockSize = static_cast<uint32_t>(reader.ReadBits(16)) + 1;
+            }
+            else if (blockSizeCode >= 8)
+            {
+                blockSize = 256U << (blockSizeCode - 8);
+            }
+            else
+            {
+                throw Poco::DataFormatException("Reserved FLAC block size");
+            }
+
+            if (sampleRateCode == 12)
+            {
+                reader.ReadBits(8);
+            }
+            else if (sampleRateCode == 13 || sampleRateCode == 14)
+            {
+                reader.ReadBits(16);
+            }
+            else if (sampleRateCode == 15)
+            {
+                throw Poco::DataFormatException("Invalid FLAC sample rate code");
+            }
+
+            reader.ReadBits(8); // Header CRC-8
+
+            static const uint32_t sampleSizes[8]{0, 8, 12, 0, 16, 20, 24, 32};
+            uint32_t bitsPerSample = sampleSizeCode == 0 ? _bitsPerSample : sampleSizes[sampleSizeCode];
+            if (bitsPerSample == 0)
+            {
+                throw Poco::DataFormatException("Reserved FLAC sample size");
+            }
+
+            uint32_t channels = channelAssignment < 8 ? channelAssignment + 1 : 2;
+            if (channelAssignment > 10 || channels != _channels)
+            {
+                throw Poco::DataFormatException("Invalid FLAC channel assignment");
+            }
+
+            size_t requiredSize = static_cast<size_t>(blockSize) * channels;
+            if (_subframeSamples.size() < requiredSize)
+            {
+                _subframeSamples.resize(requiredSize);
+                _frameBuffer.resize(requiredSize);
+            }
+
+            for (uint32_t channel = 0; channel < channels; channel++)
+            {
+                // The side channel in stereo decorrelation modes needs an extra bit.
+                bool isSideChannel = (channelAssignment == 8 && channel == 1) ||
+                                     (channelAssignment == 9 && channel == 0) ||
+                                     (channelAssignment == 10 && channel == 1);
+
+                DecodeSubframe(reader, &_subframeSamples[static_cast<size_t>(channel) * blockSize],
+                               blockSize, bitsPerSample + (isSideChannel ? 1 : 0));
+            }
+
+            reader.AlignToByte();
+            reader.ReadBits(16); // Frame CRC-16
+
+            _nextFrameOffset = reader.BytePosition();
+
+            int64_t* left = &_subframeSamples[0];
+            int64_t* right = &_subframeSamples[blockSize];
+            for (uint32_t sample = 0; sample < blockSize && channelAssignment >= 8; sample++)
+            {
+                switch (channelAssignment)
+                {
+                    case 8: // Left/side
+                        right[sample] = left[sample] - right[sample];
+                        break;
+
+                    case 9: // Side/right
+                        left[sample] += right[sample];
+                        break;
+
+                    case 10: { // Mid/side
+                        int64_t mid = (left[sample] * 2) | (right[sample] & 1);
+                        int64_t side = right[sample];
+                        left[sample] = (mid + side) >> 1;
+                        right[sample] = (mid - side) >> 1;
+                        break;
+                    }
+
+                    default:
+                        break;
+                }
+            }
+
+            float scale = 1.0f / static_cast<float>(int64_t(1) << (bitsPerSample - 1));
+            for (uint32_t channel = 0; channel < channels; channel++)
+            {
+                const int64_t* channelSamples = &_subframeSamples[static_cast<size_t>(channel) * blockSize];
+                for (uint32_t sample = 0; sample < blockSize; sample++)
+                {
+                    _frameBuffer[static_cast<size_t>(sample) * channels + channel] = static_cast<float>(channelSamples[sample]) * scale;
+                }
+            }
+
+            _frameBufferFrames = blockSize;
+            _frameBufferPosition = 0;
+
+            return true;
+        }
+        catch (Poco::DataFormatException&)
+        {
+            // Either a corrupted frame or a false sync code. Continue searching for the next frame.
+            _nextFrameOffset++;
+        }
+    }
+}
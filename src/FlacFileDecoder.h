@@ -0,0 +1,54 @@
+#pragma once
+
+#include "AudioFileDecoder.h"
+
+#include <vector>
+
+/**
+ * @brief Native decoder for FLAC files.
+ *
+ * Decodes one FLAC frame at a time from the in-memory file image and hands out the samples as requested, so memory
+ * usage is independent of the file size. Supports all subframe types and stereo decorrelation modes with up to
+ * 32 bits per sample. Frame checksums and the MD5 signature are not verified.
+ */
+class FlacFileDecoder : public AudioFileDecoder
+{
+public:
+    /**
+     * @brief Parses the FLAC stream info and locates the first audio frame.
+     * @param data Pointer to the file contents.
+     * @param size Size of the file contents in bytes.
+     */
+    FlacFileDecoder(const char* data, size_t size);
+
+    const char* FormatName() const override;
+
+    uint32_t SampleRate() const override;
+
+    uint32_t Channels() const override;
+
+    size_t Decode(float* output, size_t frames) override;
+
+    void Rewind() override;
+
+private:
+    /**
+     * @brief Decodes the next FLAC frame into the frame buffer.
+     * @return True if a frame was decoded, false if the end of the stream was reached.
+     */
+    bool DecodeFrame();
+
+    const uint8_t* _data{nullptr}; //!< File contents.
+    size_t _size{0}; //!< File size in bytes.
+    size_t _firstFrameOffset{0}; //!< Byte offset of the first audio frame.
+    size_t _nextFrameOffset{0}; //!< Byte offset of the next audio frame to decode.
+
+    uint32_t _sampleRate{0}; //!< Sample rate in Hz from the stream info.
+    uint32_t _channels{0}; //!< Number of channels from the stream info.
+    uint32_t _bitsPerSample{0}; //!< Sample resolution from the stream info.
+
+    std::vector<int64_t> _subframeSamples; //!< Decoded samples of each channel, planar.
+    std::vector<float> _frameBuffer; //!< Decoded, interleaved samples of the current frame.
+    size_t _frameBufferFrames{0}; //!< Number of sample frames in the frame buffer.
+    size_t _frameBufferPosition{0}; //!< Next frame to hand out from the frame buffer.
+};
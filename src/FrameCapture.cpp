@@ -0,0 +1,242 @@
+#include "FrameCapture.h"
+
+#ifdef USE_GLEW
+#include <GL/glew.h>
+#endif
+
+#include <SDL2/SDL_opengl.h>
+
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief OpenGL 3.2 buffer mapping and sync functions.
+ */
+struct CaptureFunctions
+{
+    void(APIENTRY* genBuffers)(GLsizei, GLuint*){nullptr};
+    void(APIENTRY* deleteBuffers)(GLsizei, const GLuint*){nullptr};
+    void(APIENTRY* bindBuffer)(GLenum, GLuint){nullptr};
+    void(APIENTRY* bufferData)(GLenum, GLsizeiptr, const void*, GLenum){nullptr};
+    void*(APIENTRY* mapBufferRange)(GLenum, GLintptr, GLsizeiptr, GLbitfield){nullptr};
+    GLboolean(APIENTRY* unmapBuffer)(GLenum){nullptr};
+    GLsync(APIENTRY* fenceSync)(GLenum, GLbitfield){nullptr};
+    GLenum(APIENTRY* clientWaitSync)(GLsync, GLbitfield, GLuint64){nullptr};
+    void(APIENTRY* deleteSync)(GLsync){nullptr};
+
+    bool loaded{false};
+};
+
+CaptureFunctions functions;
+
+template<typename Function>
+bool LoadFunction(OffscreenFramebuffer::ProcAddressFunction getProcAddress, Function& function, const char* name)
+{
+    function = reinterpret_cast<Function>(getProcAddress(name));
+    return function != nullptr;
+}
+
+} // namespace
+
+FrameCapture::FrameCapture(size_t bufferCount)
+    : _buffers(std::max<size_t>(bufferCount, 2))
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    if (!functions.loaded)
+    {
+        return;
+    }
+
+    // Frames still in flight are dropped, as the consumers may not exist anymore.
+    for (auto& buffer : _buffers)
+    {
+        if (buffer.fence != nullptr)
+        {
+            functions.deleteSync(static_cast<GLsync>(buffer.fence));
+        }
+
+        if (buffer.name != 0)
+        {
+            functions.deleteBuffers(1, &buffer.name);
+        }
+    }
+}
+
+bool FrameCapture::LoadFunctions(OffscreenFramebuffer::ProcAddressFunction getProcAddress)
+{
+    functions.loaded = LoadFunction(getProcAddress, functions.genBuffers, "glGenBuffers") &&
+                       LoadFunction(getProcAddress, functions.deleteBuffers, "glDeleteBuffers") &&
+                       LoadFunction(getProcAddress, functions.bindBuffer, "glBindBuffer") &&
+                       LoadFunction(getProcAddress, functions.bufferData, "glBufferData") &&
+                       LoadFunction(getProcAddress, functions.mapBufferRange, "glMapBufferRange") &&
+                       LoadFunction(getProcAddress, functions.unmapBuffer, "glUnmapBuffer") &&
+                       LoadFunction(getProcAddress, functions.fenceSync, "glFenceSync") &&
+                       LoadFunction(getProcAddress, functions.clientWaitSync, "glClientWaitSync") &&
+                       LoadFunction(getProcAddress, functions.deleteSync, "glDeleteSync");
+
+    return functions.loaded;
+}
+
+bool FrameCapture::Asynchronous()
+{
+    return functions.loaded;
+}
+
+int FrameCapture::AddConsumer(Consumer consumer)
+{
+    auto consumerId = _nextConsumerId++;
+    _consumers.emplace(consumerId, std::move(consumer));
+    return consumerId;
+}
+
+void FrameCapture::RemoveConsumer(int consumerId)
+{
+    _consumers.erase(consumerId);
+}
+
+bool FrameCapture::HasConsumers() const
+{
+    return !_consumers.empty();
+}
+
+void FrameCapture::Capture(uint32_t framebuffer, int width, int height)
+{
+    if (_consumers.empty() || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    Frame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.sequence = _sequence++;
+    frame.timestamp = Poco::Timestamp().epochMicroseconds();
+
+    if (OffscreenFramebuffer::Available())
+    {
+        OffscreenFramebuffer::Bind(framebuffer);
+    }
+
+    // Rows are tightly packed in the capture buffers. The previous alignment is restored afterwards, so other code
+    // reading pixels, e.g. projectM or the GUI, isn't affected.
+    GLint previousPackAlignment{4};
+    glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    auto size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+
+    if (!functions.loaded)
+    {
+        _pixels.resize(size);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, _pixels.data());
+        glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+
+        frame.pixels = _pixels.data();
+        Consume(frame);
+        return;
+    }
+
+    Poll();
+
+    // All buffers in flight: the GPU is too far behind, so wait for the oldest one.
+    auto& buffer = _buffers[_nextBuffer];
+    if (buffer.fence != nullptr)
+    {
+        Deliver(buffer, true);
+    }
+
+    if (buffer.name == 0)
+    {
+        functions.genBuffers(1, &buffer.name);
+    }
+
+    functions.bindBuffer(GL_PIXEL_PACK_BUFFER, buffer.name);
+    if (buffer.size != size)
+    {
+        functions.bufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        buffer.size = size;
+    }
+
+    // With a pack buffer bound, this only queues the copy and returns immediately.
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    functions.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+
+    buffer.fence = functions.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer.frame = frame;
+
+    _nextBuffer = (_nextBuffer + 1) % _buffers.size();
+    _buffersInFlight++;
+}
+
+void FrameCapture::Poll()
+{
+    while (_buffersInFlight > 0 && Deliver(_buffers[_oldestBuffer], false))
+    {
+    }
+}
+
+void FrameCapture::Flush()
+{
+    while (_buffersInFlight > 0)
+    {
+        Deliver(_buffers[_oldestBuffer], true);
+    }
+}
+
+bool FrameCapture::Deliver(Buffer& buffer, bool wait)
+{
+    poco_assert_dbg(&buffer == &_buffers[_oldestBuffer]);
+
+    auto fence = static_cast<GLsync>(buffer.fence);
+
+    // The flush bit makes sure the fence is actually submitted, otherwise waiting on it could block forever.
+    GLuint64 timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+    auto result = functions.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        return false;
+    }
+
+    if (result == GL_WAIT_FAILED)
+    {
+        poco_error_f1(_logger, "Waiting for the readback of frame %?u failed, dropping it.", buffer.frame.sequence);
+    }
+
+    functions.deleteSync(fence);
+    buffer.fence = nullptr;
+    _oldestBuffer = (_oldestBuffer + 1) % _buffers.size();
+    _buffersInFlight--;
+
+    if (result == GL_WAIT_FAILED)
+    {
+        return true;
+    }
+
+    functions.bindBuffer(GL_PIXEL_PACK_BUFFER, buffer.name);
+    auto pixels = functions.mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(buffer.size), GL_MAP_READ_BIT);
+    if (pixels != nullptr)
+    {
+        Frame frame = buffer.frame;
+        frame.pixels = static_cast<const uint8_t*>(pixels);
+        Consume(frame);
+        functions.unmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    functions.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return true;
+}
+
+void FrameCapture::Consume(const Frame& frame)
+{
+    for (const auto& consumer : _consumers)
+    {
+        consumer.second(frame);
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "OffscreenFramebuffer.h"
+
+#include <Poco/Logger.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+/**
+ * @brief Reads rendered frames back from the GPU without stalling the render pipeline.
+ *
+ * Capture() only queues an asynchronous glReadPixels() into one of several pixel buffer objects and inserts a fence.
+ * The buffer is mapped a few frames later, once the fence has signaled, and the pixels are passed to all registered
+ * consumers, e.g. video recording or streaming outputs. All consumers share the same readback, so adding another
+ * output doesn't add another GPU round trip.
+ *
+ * If pixel buffer objects or fences aren't available, frames are read synchronously and passed on immediately.
+ *
+ * All methods must be called on the thread owning the OpenGL context.
+ */
+class FrameCapture
+{
+public:
+    /**
+     * @brief A captured frame, as passed to consumers.
+     *
+     * The pixel data is only valid during the consumer call.
+     */
+    struct Frame
+    {
+        const uint8_t* pixels{nullptr}; //!< Tightly packed RGBA pixels, bottom row first.
+        int width{0}; //!< Frame width in pixels.
+        int height{0}; //!< Frame height in pixels.
+        uint64_t sequence{0}; //!< Number of the frame since the capture was created, starting at 1. 0 is never used.
+        int64_t timestamp{0}; //!< Time the frame was rendered, in microseconds since the Unix epoch.
+    };
+
+    /**
+     * @brief Consumer callback, called once for each captured frame in rendering order.
+     */
+    using Consumer = std::function<void(const Frame&)>;
+
+    explicit FrameCapture(size_t bufferCount = 3);
+
+    FrameCapture(const FrameCapture&) = delete;
+
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    ~FrameCapture();
+
+    /**
+     * @brief Loads the OpenGL buffer and sync functions required for asynchronous readback.
+     * @param getProcAddress The function used to look up OpenGL functions in the current context.
+     * @return True if all functions are available.
+     */
+    static bool LoadFunctions(OffscreenFramebuffer::ProcAddressFunction getProcAddress);
+
+    /**
+     * @brief Returns whether frames are read back asynchronously.
+     * @return True if LoadFunctions() was called successfully.
+     */
+    static bool Asynchronous();
+
+    /**
+     * @brief Registers a frame consumer.
+     * @param consumer The callback receiving the frames.
+     * @return An ID which can be passed to RemoveConsumer().
+     */
+    int AddConsumer(Consumer consumer);
+
+    /**
+     * @brief Unregisters a frame consumer.
+     * @param consumerId The ID returned by AddConsumer().
+     */
+    void RemoveConsumer(int consumerId);
+
+    /**
+     * @brief Returns whether any consumers are registered.
+     *
+     * Capture() doesn't do anything without consumers, so there's no cost if nobody is interested in the frames.
+     *
+     * @return True if at least one consumer is registered.
+     */
+    bool HasConsumers() const;
+
+    /**
+     * @brief Queues the readback of the given framebuffer and passes all completed frames to the consumers.
+     *
+     * Only waits for the GPU if all buffers are still in flight, i.e. the GPU is more than the buffer count behind.
+     * Leaves the captured framebuffer bound.
+     *
+     * @param framebuffer The framebuffer to read, 0 for the window.
+     * @param width The width of the area to read.
+     * @param height The height of the area to read.
+     */
+    void Capture(uint32_t framebuffer, int width, int height);
+
+    /**
+     * @brief Passes all frames whose readback has completed to the consumers, without waiting for the GPU.
+     */
+    void Poll();
+
+    /**
+     * @brief Waits for all pending readbacks and passes the frames to the consumers.
+     *
+     * Call before the consumers are removed or the capture is destroyed, so no frames are lost.
+     */
+    void Flush();
+
+protected:
+    /**
+     * @brief A pixel buffer object with its readback state.
+     */
+    struct Buffer
+    {
+        uint32_t name{0}; //!< Pixel buffer object name.
+        size_t size{0}; //!< Allocated buffer size in bytes.
+        void* fence{nullptr}; //!< Fence inserted after the readback, nullptr if the buffer isn't in flight.
+        Frame frame; //!< Frame properties, without the pixel pointer.
+    };
+
+    /**
+     * @brief Maps a buffer, passes its pixels to the consumers and marks it as free.
+     * @param buffer The buffer to deliver.
+     * @param wait If true, waits until the readback has finished. Otherwise, returns false if it hasn't.
+     * @return True if the buffer was delivered.
+     */
+    bool Deliver(Buffer& buffer, bool wait);
+
+    /**
+     * @brief Passes a frame to all consumers.
+     * @param frame The frame to pass on.
+     */
+    void Consume(const Frame& frame);
+
+    std::vector<Buffer> _buffers; //!< The buffer ring.
+    size_t _nextBuffer{0}; //!< Index of the buffer used by the next capture.
+    size_t _oldestBuffer{0}; //!< Index of the oldest buffer in flight.
+    size_t _buffersInFlight{0}; //!< Number of buffers waiting to be delivered.
+
+    std::vector<uint8_t> _pixels; //!< Pixel data for synchronous readback.
+    uint64_t _sequence{1}; //!< Sequence number of the next captured frame.
+
+    std::map<int, Consumer> _consumers; //!< Registered consumers by ID.
+    int _nextConsumerId{1}; //!< ID of the next registered consumer.
+
+    Poco::Logger& _logger{Poco::Logger::get("FrameCapture")}; //!< The class logger.
+};
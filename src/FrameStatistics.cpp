@@ -0,0 +1,201 @@
+#include "FrameStatistics.h"
+
+#include <Poco/Exception.h>
+#include <Poco/FileStream.h>
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Object.h>
+
+#include <Poco/Util/Application.h>
+
+#include <atomic>
+#include <csignal>
+#include <sstream>
+
+namespace {
+
+std::atomic_bool dumpRequested{false}; //!< Set by the signal handler if the statistics should be written.
+
+} // namespace
+
+FrameStatistics::FrameStatistics()
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _fileName = config.getString("statistics.file", "");
+
+#ifdef SIGUSR1
+    if (!_fileName.empty())
+    {
+        std::signal(SIGUSR1, &FrameStatistics::DumpSignalHandler);
+    }
+#endif
+}
+
+void FrameStatistics::TargetFPS(int fps)
+{
+    if (fps == _targetFps)
+    {
+        return;
+    }
+
+    _targetFps = fps;
+    _targetFrameTime = fps > 0 ? 1000000 / static_cast<uint64_t>(fps) : 0;
+}
+
+void FrameStatistics::StartFrame()
+{
+    if (_frameStarted)
+    {
+        auto frameTime = static_cast<uint64_t>(_frameStartTime.elapsed());
+        _histograms[static_cast<int>(Phase::Frame)].Record(frameTime);
+
+        if (_targetFrameTime > 0 && frameTime * 2 > _targetFrameTime * 3)
+        {
+            _missedDeadlines++;
+        }
+    }
+
+    _frameStarted = true;
+    _frameStartTime.update();
+    _phaseStartTime = _frameStartTime;
+}
+
+void FrameStatistics::EndPhase(Phase phase)
+{
+    poco_assert_dbg(phase < Phase::Work);
+
+    Poco::Clock now;
+    _histograms[static_cast<int>(phase)].Record(static_cast<uint64_t>(now - _phaseStartTime));
+    _phaseStartTime = now;
+
+    // The last phase of a frame determines the total work time.
+    if (phase == Phase::Swap)
+    {
+        _histograms[static_cast<int>(Phase::Work)].Record(static_cast<uint64_t>(now - _frameStartTime));
+    }
+}
+
+void FrameStatistics::Reset()
+{
+    for (auto& histogram : _histograms)
+    {
+        histogram.Reset();
+    }
+
+    _missedDeadlines = 0;
+    _frameStarted = false;
+    _recordingStartTime.update();
+}
+
+const TimingHistogram& FrameStatistics::Histogram(Phase phase) const
+{
+    return _histograms[static_cast<int>(phase)];
+}
+
+uint64_t FrameStatistics::MissedDeadlines() const
+{
+    return _missedDeadlines;
+}
+
+std::string FrameStatistics::ToJSON() const
+{
+    Poco::JSON::Object root(Poco::JSON_PRESERVE_KEY_ORDER);
+
+    const auto& frames = Histogram(Phase::Frame);
+    root.set("frames", frames.Count());
+    root.set("durationSeconds", static_cast<double>(_recordingStartTime.elapsed()) / 1000000.0);
+    root.set("targetFps", _targetFps);
+    root.set("missedDeadlines", _missedDeadlines);
+    root.set("averageFps", frames.Mean() > 0.0 ? 1000000.0 / frames.Mean() : 0.0);
+
+    Poco::JSON::Object::Ptr phases = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+    for (int phaseIndex = 0; phaseIndex < static_cast<int>(Phase::Count); phaseIndex++)
+    {
+        const auto& histogram = _histograms[phaseIndex];
+
+        // All times in microseconds.
+        Poco::JSON::Object::Ptr phase = new Poco::JSON::Object(Poco::JSON_PRESERVE_KEY_ORDER);
+        phase->set("count", histogram.Count());
+        phase->set("min", histogram.Min());
+        phase->set("mean", histogram.Mean());
+        phase->set("p50", histogram.Percentile(50.0));
+        phase->set("p95", histogram.Percentile(95.0));
+        phase->set("p99", histogram.Percentile(99.0));
+        phase->set("max", histogram.Max());
+
+        Poco::JSON::Array::Ptr buckets = new Poco::JSON::Array;
+        for (const auto& bucket : histogram.Buckets())
+        {
+            Poco::JSON::Array::Ptr entry = new Poco::JSON::Array;
+            entry->add(bucket.upperBound);
+            entry->add(bucket.count);
+            buckets->add(entry);
+        }
+        phase->set("histogram", buckets);
+
+        phases->set(PhaseName(static_cast<Phase>(phaseIndex)), phase);
+    }
+    root.set("phases", phases);
+
+    std::ostringstream json;
+    root.stringify(json, 2);
+    return json.str();
+}
+
+void FrameStatistics::Dump() const
+{
+    if (_fileName.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        Poco::FileOutputStream output(_fileName);
+        output << ToJSON() << std::endl;
+        output.close();
+
+        const auto& frames = Histogram(Phase::Frame);
+        poco_information_f4(_logger, R"(Wrote frame statistics to "%s": p99 frame time %?u us, max %?u us, %?u missed deadlines.)",
+                            _fileName, frames.Percentile(99.0), frames.Max(), _missedDeadlines);
+    }
+    catch (Poco::Exception& ex)
+    {
+        poco_error_f2(_logger, R"(Failed to write frame statistics to "%s": %s)", _fileName, ex.displayText());
+    }
+}
+
+void FrameStatistics::DumpIfRequested() const
+{
+    if (dumpRequested.exchange(false))
+    {
+        Dump();
+    }
+}
+
+const char* FrameStatistics::PhaseName(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::Events:
+            return "events";
+        case Phase::AudioFill:
+            return "audioFill";
+        case Phase::Render:
+            return "render";
+        case Phase::GuiDraw:
+            return "guiDraw";
+        case Phase::Swap:
+            return "swap";
+        case Phase::Work:
+            return "work";
+        case Phase::Frame:
+            return "frame";
+        default:
+            return "unknown";
+    }
+}
+
+void FrameStatistics::DumpSignalHandler(int)
+{
+    dumpRequested = true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "TimingHistogram.h"
+
+#include <Poco/Clock.h>
+#include <Poco/Logger.h>
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Records per-phase render loop timings and reports percentiles and missed frame deadlines.
+ *
+ * Each phase of a render loop iteration is recorded in its own fixed-size histogram, so the statistics can run
+ * for hours without growing. Unlike FPSLimiter::FPS(), which averages the last ten frames, this keeps rare stutters
+ * visible.
+ *
+ * The statistics are written as JSON to the file set in statistics.file when the application exits, and on POSIX
+ * systems also when receiving SIGUSR1.
+ */
+class FrameStatistics
+{
+public:
+    /**
+     * Render loop phases which are recorded separately.
+     */
+    enum class Phase
+    {
+        Events, //!< Polling and handling SDL events.
+        AudioFill, //!< Passing audio data to projectM.
+        Render, //!< Rendering the projectM frame.
+        GuiDraw, //!< Drawing the ImGui user interface.
+        Swap, //!< Swapping the window buffers, possibly waiting for vsync.
+        Work, //!< All of the above, e.g. the time between StartFrame() and the last phase.
+        Frame, //!< Time between the start of two frames, including any limiting delay.
+        Count //!< Number of phases, not an actual phase.
+    };
+
+    FrameStatistics();
+
+    /**
+     * @brief Sets the target frames per second value used to count missed deadlines.
+     * @param fps The targeted frames per second. 0 disables deadline checks.
+     */
+    void TargetFPS(int fps);
+
+    /**
+     * @brief Marks the start of a new frame and records the time since the previous frame was started.
+     *
+     * If the previous frame took more than one and a half target frame times, it is counted as a missed deadline,
+     * as the frame was most likely displayed one refresh later than it should have been.
+     */
+    void StartFrame();
+
+    /**
+     * @brief Records the time since the last phase ended or the frame was started.
+     * @param phase The phase that just ended. Must not be Work, Frame or Count.
+     */
+    void EndPhase(Phase phase);
+
+    /**
+     * @brief Discards all recorded timings.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the histogram of a phase.
+     * @param phase The phase.
+     * @return The timing histogram of the given phase.
+     */
+    const TimingHistogram& Histogram(Phase phase) const;
+
+    /**
+     * @brief Returns the number of frames which missed their deadline.
+     * @return The number of missed deadlines since the last reset.
+     */
+    uint64_t MissedDeadlines() const;
+
+    /**
+     * @brief Returns the statistics as a JSON document.
+     * @return A JSON string with percentiles, missed deadlines and histograms of all phases.
+     */
+    std::string ToJSON() const;
+
+    /**
+     * @brief Writes the statistics to the file set in statistics.file.
+     *
+     * Does nothing if no file is configured.
+     */
+    void Dump() const;
+
+    /**
+     * @brief Writes the statistics if a dump was requested via signal since the last call.
+     *
+     * Should be called once per frame from the render loop, as files can't be written from a signal handler.
+     */
+    void DumpIfRequested() const;
+
+    /**
+     * @brief Returns the name of a phase as used in the JSON output.
+     * @param phase The phase.
+     * @return The phase name.
+     */
+    static const char* PhaseName(Phase phase);
+
+private:
+    /**
+     * @brief Signal handler which requests a statistics dump.
+     * @param signal The signal number.
+     */
+    static void DumpSignalHandler(int signal);
+
+    std::string _fileName; //!< File the statistics are written to. Empty to disable writing.
+    int _targetFps{0}; //!< Currently targeted FPS value.
+    uint64_t _targetFrameTime{0}; //!< Targeted time per frame in microseconds. 0 if unlimited.
+    uint64_t _missedDeadlines{0}; //!< Number of frames which took longer than 1.5 target frame times.
+
+    Poco::Clock _frameStartTime; //!< Time the current frame was started.
+    Poco::Clock _phaseStartTime; //!< Time the current phase was started.
+    bool _frameStarted{false}; //!< True if StartFrame() was called at least once.
+    Poco::Clock _recordingStartTime; //!< Time recording was started or last reset.
+
+    TimingHistogram _histograms[static_cast<int>(Phase::Count)]; //!< Timing histograms for each phase.
+
+    Poco::Logger& _logger{Poco::Logger::get("FrameStatistics")}; //!< The class logger.
+};
@@ -0,0 +1,145 @@
+#include "FrameWriter.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/Path.h>
+#include <Poco/String.h>
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+FrameWriter::Format FrameWriter::ParseFormat(const std::string& name, const std::string& fileName)
+{
+    if (name.empty())
+    {
+        auto extension = Poco::toLower(Poco::Path(fileName).getExtension());
+        return extension == "rgba" || extension == "raw" ? Format::RGBA : Format::Y4M;
+    }
+
+    if (Poco::icompare(name, "y4m") == 0)
+    {
+        return Format::Y4M;
+    }
+
+    if (Poco::icompare(name, "rgba") == 0)
+    {
+        return Format::RGBA;
+    }
+
+    throw Poco::InvalidArgumentException("Unknown video output format", name);
+}
+
+void FrameWriter::Open(const std::string& fileName, Format format, int width, int height, int fps)
+{
+    _format = format;
+    _width = width;
+    _height = height;
+
+    if (fileName == "-")
+    {
+#ifdef _WIN32
+        // Prevent line ending conversion from corrupting the binary stream.
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        _stream = &std::cout;
+    }
+    else
+    {
+        _fileStream.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!_fileStream.is_open())
+        {
+            throw Poco::OpenFileException("Could not open video output file for writing", fileName);
+        }
+        _stream = &_fileStream;
+    }
+
+    _frameBuffer.resize(static_cast<size_t>(_width) * static_cast<size_t>(_height) * 4);
+
+    if (_format == Format::Y4M)
+    {
+        // Square pixels, progressive, 4:4:4 chroma, so no subsampling is required.
+        *_stream << Poco::format("YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444 XCOLORRANGE=LIMITED\n", _width, _height, fps);
+    }
+
+    poco_information_f4(_logger, R"(Writing %dx%d %s video to "%s".)", _width, _height,
+                        std::string(_format == Format::Y4M ? "Y4M" : "raw RGBA"),
+                        fileName == "-" ? std::string("standard output") : fileName);
+}
+
+bool FrameWriter::WriteFrame(const uint8_t* rgbaPixels)
+{
+    if (_stream == nullptr)
+    {
+        return false;
+    }
+
+    if (_format == Format::Y4M)
+    {
+        ConvertToYCbCr(rgbaPixels);
+        *_stream << "FRAME\n";
+        _stream->write(reinterpret_cast<const char*>(_frameBuffer.data()), static_cast<std::streamsize>(_width) * _height * 3);
+    }
+    else
+    {
+        FlipRows(rgbaPixels);
+        _stream->write(reinterpret_cast<const char*>(_frameBuffer.data()), static_cast<std::streamsize>(_frameBuffer.size()));
+    }
+
+    return _stream->good();
+}
+
+void FrameWriter::Close()
+{
+    if (_stream == nullptr)
+    {
+        return;
+    }
+
+    _stream->flush();
+    if (_fileStream.is_open())
+    {
+        _fileStream.close();
+    }
+    _stream = nullptr;
+}
+
+void FrameWriter::ConvertToYCbCr(const uint8_t* rgbaPixels)
+{
+    const size_t planeSize = static_cast<size_t>(_width) * static_cast<size_t>(_height);
+    uint8_t* yPlane = _frameBuffer.data();
+    uint8_t* cbPlane = yPlane + planeSize;
+    uint8_t* crPlane = cbPlane + planeSize;
+
+    for (int row = 0; row < _height; row++)
+    {
+        const uint8_t* source = rgbaPixels + static_cast<size_t>(_height - 1 - row) * _width * 4;
+        const size_t offset = static_cast<size_t>(row) * _width;
+
+        for (int column = 0; column < _width; column++, source += 4)
+        {
+            int red = source[0];
+            int green = source[1];
+            int blue = source[2];
+
+            // BT.601 limited range in 8-bit fixed point, the default ffmpeg assumes for Y4M input.
+            yPlane[offset + column] = static_cast<uint8_t>(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+            cbPlane[offset + column] = static_cast<uint8_t>(((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128);
+            crPlane[offset + column] = static_cast<uint8_t>(((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128);
+        }
+    }
+}
+
+void FrameWriter::FlipRows(const uint8_t* rgbaPixels)
+{
+    const size_t rowSize = static_cast<size_t>(_width) * 4;
+
+    for (int row = 0; row < _height; row++)
+    {
+        std::memcpy(_frameBuffer.data() + row * rowSize, rgbaPixels + static_cast<size_t>(_height - 1 - row) * rowSize, rowSize);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Poco/Logger.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Writes rendered frames as an uncompressed video stream.
+ *
+ * Two formats are supported:
+ * - Y4M (YUV4MPEG2) with 4:4:4 chroma, which ffmpeg and most other encoders read without further parameters.
+ * - Raw, tightly packed RGBA pixels. The receiver must be told the size and frame rate, e.g. with
+ *   "ffmpeg -f rawvideo -pix_fmt rgba -s <width>x<height> -r <fps> -i <file>".
+ *
+ * Frames are passed in OpenGL's bottom-up row order, as returned by glReadPixels(), and written top-down. The file
+ * name "-" writes to standard output, so the stream can be piped directly into an encoder.
+ */
+class FrameWriter
+{
+public:
+    /**
+     * @brief Output formats.
+     */
+    enum class Format
+    {
+        Y4M, //!< YUV4MPEG2 stream with BT.601 limited range 4:4:4 YCbCr data.
+        RGBA //!< Raw RGBA pixels without any header.
+    };
+
+    /**
+     * @brief Parses a format name.
+     *
+     * If the name is empty, the format is selected by the file extension: ".rgba" and ".raw" select raw RGBA, anything
+     * else, including standard output, selects Y4M.
+     *
+     * @param name The format name, "y4m", "rgba" or empty.
+     * @param fileName The output file name.
+     * @return The selected format.
+     * @throws Poco::InvalidArgumentException if the format name is unknown.
+     */
+    static Format ParseFormat(const std::string& name, const std::string& fileName);
+
+    /**
+     * @brief Opens the output and writes the stream header, if the format has one.
+     * @param fileName The output file name, or "-" for standard output.
+     * @param format The output format.
+     * @param width The frame width in pixels.
+     * @param height The frame height in pixels.
+     * @param fps The frame rate written to the stream header.
+     * @throws Poco::OpenFileException if the file can't be opened.
+     */
+    void Open(const std::string& fileName, Format format, int width, int height, int fps);
+
+    /**
+     * @brief Converts and writes a single frame.
+     * @param rgbaPixels width * height RGBA pixels, bottom row first.
+     * @return False if the output couldn't be written, e.g. because the receiving end of a pipe was closed.
+     */
+    bool WriteFrame(const uint8_t* rgbaPixels);
+
+    /**
+     * @brief Flushes and closes the output.
+     */
+    void Close();
+
+protected:
+    /**
+     * @brief Converts an RGBA frame to planar Y4M data in the conversion buffer.
+     * @param rgbaPixels The bottom-up RGBA frame.
+     */
+    void ConvertToYCbCr(const uint8_t* rgbaPixels);
+
+    /**
+     * @brief Copies an RGBA frame into the conversion buffer, flipping it vertically.
+     * @param rgbaPixels The bottom-up RGBA frame.
+     */
+    void FlipRows(const uint8_t* rgbaPixels);
+
+    Format _format{Format::Y4M}; //!< The output format.
+    int _width{0}; //!< Frame width in pixels.
+    int _height{0}; //!< Frame height in pixels.
+
+    std::ofstream _fileStream; //!< The output file, if not writing to standard output.
+    std::ostream* _stream{nullptr}; //!< The stream frames are written to, either the file or std::cout.
+
+    std::vector<uint8_t> _frameBuffer; //!< Converted frame data of the frame being written.
+
+    Poco::Logger& _logger{Poco::Logger::get("FrameWriter")}; //!< The class logger.
+};
@@ -0,0 +1,154 @@
+#include "MeshGovernor.h"
+
+#include "FPSLimiter.h"
+#include "ProjectMWrapper.h"
+
+namespace {
+
+constexpr float QualityLevels[]{1.0f, 0.8f, 0.65f, 0.5f, 0.4f, 0.3f}; //!< Mesh size scale factors, from best to worst.
+constexpr int LevelCount{sizeof(QualityLevels) / sizeof(QualityLevels[0])};
+
+constexpr uint32_t WindowFrames{30}; //!< Number of frames averaged before a decision is made.
+constexpr uint32_t SettleWindowsAfterSwitch{2}; //!< Windows ignored after a preset switch.
+constexpr uint32_t SettleWindowsAfterChange{1}; //!< Windows ignored after a quality change.
+constexpr uint32_t StepUpWindows{4}; //!< Consecutive comfortable windows required to raise the quality.
+
+constexpr double StepDownLoad{0.9}; //!< Lower quality if the average rendering time exceeds this share of the budget.
+constexpr uint32_t StepDownMissedFrames{WindowFrames / 6}; //!< Lower quality if more frames than this exceed the budget.
+constexpr double StepUpLoad{0.75}; //!< Raise quality if the estimated rendering time on the next level stays below this share.
+
+} // namespace
+
+MeshGovernor::MeshGovernor(ProjectMWrapper& projectMWrapper, const FPSLimiter& limiter)
+    : _projectMWrapper(projectMWrapper)
+    , _limiter(limiter)
+    , _presetSwitchCount(projectMWrapper.PresetSwitchCount())
+{
+}
+
+void MeshGovernor::Update()
+{
+    auto targetFrameTime = _limiter.TargetFrameTime();
+
+    // Without a frame budget, there's nothing to govern.
+    if (!_projectMWrapper.Settings()->adaptiveMeshSize || targetFrameTime == 0)
+    {
+        if (_level != 0)
+        {
+            SetLevel(0);
+        }
+        ResetWindow();
+        return;
+    }
+
+    auto presetSwitchCount = _projectMWrapper.PresetSwitchCount();
+    if (presetSwitchCount != _presetSwitchCount)
+    {
+        _presetSwitchCount = presetSwitchCount;
+        PresetSwitched();
+        return;
+    }
+
+    auto workTime = _limiter.LastWorkTime();
+    _windowWorkTime += workTime;
+    _windowFrames++;
+    if (workTime > targetFrameTime)
+    {
+        _windowMissedFrames++;
+    }
+
+    if (_windowFrames < WindowFrames)
+    {
+        return;
+    }
+
+    double load = static_cast<double>(_windowWorkTime) / static_cast<double>(_windowFrames) / static_cast<double>(targetFrameTime);
+    auto missedFrames = _windowMissedFrames;
+    ResetWindow();
+
+    if (_settleWindows > 0)
+    {
+        _settleWindows--;
+        return;
+    }
+
+    if ((load > StepDownLoad || missedFrames > StepDownMissedFrames) && _level < LevelCount - 1)
+    {
+        poco_debug_f3(_logger, "Rendering uses %.0f%% of the frame budget, %?u frames missed. Lowering mesh quality to %.0f%%.",
+                      load * 100.0, missedFrames, static_cast<double>(QualityLevels[_level + 1]) * 100.0);
+        SetLevel(_level + 1);
+        return;
+    }
+
+    if (_level == 0)
+    {
+        return;
+    }
+
+    // Per-pixel cost grows with the number of mesh cells, i.e. with the square of the scale factor.
+    double scale = static_cast<double>(QualityLevels[_level - 1]) / static_cast<double>(QualityLevels[_level]);
+    if (missedFrames == 0 && load * scale * scale < StepUpLoad)
+    {
+        _comfortableWindows++;
+        if (_comfortableWindows >= StepUpWindows)
+        {
+            poco_debug_f2(_logger, "Rendering uses %.0f%% of the frame budget. Raising mesh quality to %.0f%%.",
+                          load * 100.0, static_cast<double>(QualityLevels[_level - 1]) * 100.0);
+            SetLevel(_level - 1);
+        }
+    }
+    else
+    {
+        _comfortableWindows = 0;
+    }
+}
+
+void MeshGovernor::SetLevel(int level)
+{
+    _level = level;
+    _comfortableWindows = 0;
+    _settleWindows = SettleWindowsAfterChange;
+    ResetWindow();
+
+    _projectMWrapper.MeshQuality(QualityLevels[level]);
+}
+
+void MeshGovernor::PresetSwitched()
+{
+    // Only reduced levels are stored, so the map doesn't grow with every preset displayed.
+    if (!_presetFile.empty())
+    {
+        if (_level > 0)
+        {
+            _presetLevels[_presetFile] = _level;
+        }
+        else
+        {
+            _presetLevels.erase(_presetFile);
+        }
+    }
+
+    _presetFile = _projectMWrapper.CurrentPresetFile();
+
+    auto presetLevel = _presetLevels.find(_presetFile);
+    if (presetLevel != _presetLevels.end() && presetLevel->second != _level)
+    {
+        poco_debug_f1(_logger, "Restoring mesh quality of %.0f%% for this preset.",
+                      static_cast<double>(QualityLevels[presetLevel->second]) * 100.0);
+        SetLevel(presetLevel->second);
+    }
+    else
+    {
+        _comfortableWindows = 0;
+        ResetWindow();
+    }
+
+    _settleWindows = SettleWindowsAfterSwitch;
+}
+
+void MeshGovernor::ResetWindow()
+{
+    _windowFrames = 0;
+    _windowMissedFrames = 0;
+    _windowWorkTime = 0;
+}
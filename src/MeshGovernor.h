@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Poco/Logger.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+class FPSLimiter;
+class ProjectMWrapper;
+
+/**
+ * @brief Adapts the per-pixel mesh size to the frame budget.
+ *
+ * The per-pixel equations are evaluated once per mesh cell on the CPU, so the mesh size is the most effective quality
+ * setting to trade for speed on heavy presets. If enabled via "projectM.adaptiveMeshSize", the governor averages the
+ * rendering time measured by the FPSLimiter over windows of frames and lowers the mesh quality by one step if a window
+ * uses most of the frame budget. The quality is raised again only if the preset would comfortably fit into the budget
+ * with the next higher level for several consecutive windows, so the mesh size doesn't oscillate.
+ *
+ * The quality level reached for each preset is remembered and restored when the preset is displayed again, so heavy
+ * presets don't miss frames each time until they've been stepped down again. Presets without a remembered level keep
+ * the current level and are stepped up with the usual hysteresis if they're lighter. The first frames after a preset
+ * switch or a quality change are ignored, as they include shader compilation and mesh reallocation.
+ */
+class MeshGovernor
+{
+public:
+    MeshGovernor(ProjectMWrapper& projectMWrapper, const FPSLimiter& limiter);
+
+    /**
+     * @brief Records the last frame and changes the mesh quality if required.
+     *
+     * Should be called once per frame, after FPSLimiter::EndWork().
+     */
+    void Update();
+
+protected:
+    /**
+     * @brief Sets a new quality level and starts a new measurement.
+     * @param level The new index into the quality level table.
+     */
+    void SetLevel(int level);
+
+    /**
+     * @brief Remembers the level of the previous preset and restores the level of the new one.
+     */
+    void PresetSwitched();
+
+    /**
+     * @brief Discards the frames recorded in the current window.
+     */
+    void ResetWindow();
+
+    ProjectMWrapper& _projectMWrapper; //!< The projectM wrapper to set the mesh quality in.
+    const FPSLimiter& _limiter; //!< The FPS limiter which measures the rendering time.
+
+    int _level{0}; //!< Current quality level, 0 is full quality.
+    uint32_t _presetSwitchCount{0}; //!< Preset switch count seen in the last frame.
+    std::string _presetFile; //!< File name of the currently displayed preset.
+    std::unordered_map<std::string, int> _presetLevels; //!< Last quality levels below full quality, by preset file name.
+    uint32_t _settleWindows{0}; //!< Number of windows to ignore before evaluating frame times again.
+    uint32_t _comfortableWindows{0}; //!< Consecutive windows which would have fit into the budget with higher quality.
+
+    uint32_t _windowFrames{0}; //!< Number of frames recorded in the current window.
+    uint32_t _windowMissedFrames{0}; //!< Number of frames in the current window which exceeded the frame budget.
+    uint64_t _windowWorkTime{0}; //!< Sum of rendering times in the current window, in nanoseconds.
+
+    Poco::Logger& _logger{Poco::Logger::get("MeshGovernor")}; //!< The class logger.
+};
@@ -0,0 +1,159 @@
+#include "OfflineRenderer.h"
+
+#include "AudioCapture.h"
+#include "ProjectMWrapper.h"
+#include "SDLRenderingWindow.h"
+
+#include <Poco/Clock.h>
+
+#include <Poco/Util/Application.h>
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+OfflineRenderer::OfflineRenderer()
+    : _audioCapture(Poco::Util::Application::instance().getSubsystem<AudioCapture>())
+    , _projectMWrapper(Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>())
+    , _sdlRenderingWindow(Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>())
+    , _projectMHandle(_projectMWrapper.ProjectM())
+{
+    auto& config = Poco::Util::Application::instance().config();
+    _outputFileName = config.getString("render.output", "-");
+    _format = FrameWriter::ParseFormat(config.getString("render.format", ""), _outputFileName);
+    _seed = config.getUInt("render.seed", 0);
+    _duration = std::max(config.getDouble("render.duration", 0.0), 0.0);
+
+    // Unlimited FPS has no fixed frame duration, so use the same 60 FPS default as the file audio backend.
+    _fps = _projectMWrapper.TargetFPS();
+    if (_fps <= 0)
+    {
+        _fps = 60;
+    }
+}
+
+void OfflineRenderer::Run()
+{
+    _sdlRenderingWindow.GetDrawableSize(_width, _height);
+
+    _frameWriter.Open(_outputFileName, _format, _width, _height, _fps);
+    auto consumerId = _frameCapture.AddConsumer([this](const FrameCapture::Frame& frame) {
+        WriteFrame(frame);
+    });
+
+#if PROJECTM_VERSION_MAJOR < 4 || (PROJECTM_VERSION_MAJOR == 4 && PROJECTM_VERSION_MINOR < 1)
+    poco_warning(_logger, "libprojectM 4.1 or later is required for a virtual clock. Preset timing will follow the wall clock and the output isn't reproducible.");
+#endif
+
+    projectm_set_window_size(_projectMHandle, _width, _height);
+    projectm_set_fps(_projectMHandle, _fps);
+
+    // The playlist must be complete and sorted for reproducible preset selection.
+    _projectMWrapper.FinishPresetScan();
+    SeedRandomGenerators();
+    SetFrameTime(0);
+    _projectMWrapper.DisplayInitialPreset();
+
+    auto maxFrames = static_cast<uint64_t>(_duration * _fps);
+    uint64_t frame{0};
+    Poco::Clock startTime;
+
+    poco_information_f2(_logger, "Rendering at %d FPS with seed %?u.", _fps, _seed);
+
+    while (maxFrames == 0 || frame < maxFrames)
+    {
+        if (AbortRequested())
+        {
+            poco_information(_logger, "Rendering aborted by user.");
+            break;
+        }
+
+        SetFrameTime(frame);
+        _audioCapture.FillBuffer();
+        _projectMWrapper.RenderFrame(_sdlRenderingWindow.Framebuffer());
+        _frameCapture.Capture(_sdlRenderingWindow.Framebuffer(), _width, _height);
+
+        if (_writeFailed)
+        {
+            poco_error(_logger, "Could not write to the video output, stopping.");
+            break;
+        }
+
+        // Headless swaps wait for the GPU, which would defeat the asynchronous readback.
+        if (!_sdlRenderingWindow.Headless())
+        {
+            _sdlRenderingWindow.Swap();
+        }
+        frame++;
+
+        if (frame % (static_cast<uint64_t>(_fps) * 10) == 0)
+        {
+            double videoSeconds = static_cast<double>(frame) / _fps;
+            double elapsedSeconds = static_cast<double>(startTime.elapsed()) / 1000000.0;
+            poco_information_f3(_logger, "Rendered %?u frames (%.1f seconds), %.2fx real time.",
+                                frame, videoSeconds, videoSeconds / std::max(elapsedSeconds, 0.001));
+        }
+
+        // The frame with the last samples was still rendered, as it contains the end of the audio.
+        if (_audioCapture.EndOfInput())
+        {
+            break;
+        }
+    }
+
+    _frameCapture.Flush();
+    _frameCapture.RemoveConsumer(consumerId);
+    _frameWriter.Close();
+
+    double elapsedSeconds = static_cast<double>(startTime.elapsed()) / 1000000.0;
+    poco_information_f3(_logger, "Rendered %?u frames in %.1f seconds (%.1f FPS).",
+                        _writtenFrames, elapsedSeconds, static_cast<double>(_writtenFrames) / std::max(elapsedSeconds, 0.001));
+}
+
+void OfflineRenderer::SeedRandomGenerators()
+{
+    // projectM itself uses the C library's generator, e.g. for random preset values and hard cuts.
+    std::srand(_seed);
+
+    _projectMWrapper.SeedShuffle(_seed);
+}
+
+void OfflineRenderer::SetFrameTime(uint64_t frame)
+{
+#if PROJECTM_VERSION_MAJOR > 4 || (PROJECTM_VERSION_MAJOR == 4 && PROJECTM_VERSION_MINOR >= 1)
+    projectm_set_frame_time(_projectMHandle, static_cast<double>(frame) / _fps);
+#endif
+}
+
+void OfflineRenderer::WriteFrame(const FrameCapture::Frame& frame)
+{
+    if (_writeFailed || frame.width != _width || frame.height != _height)
+    {
+        return;
+    }
+
+    if (!_frameWriter.WriteFrame(frame.pixels))
+    {
+        _writeFailed = true;
+        return;
+    }
+
+    _writtenFrames++;
+}
+
+bool OfflineRenderer::AbortRequested()
+{
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event))
+    {
+        if (event.type == SDL_QUIT ||
+            (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE))
+        {
+            _aborted = true;
+        }
+    }
+
+    return _aborted;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "FrameCapture.h"
+#include "FrameWriter.h"
+
+#include <projectM-4/projectM.h>
+
+#include <Poco/Logger.h>
+
+#include <string>
+
+class AudioCapture;
+class ProjectMWrapper;
+class SDLRenderingWindow;
+
+/**
+ * @brief Renders the visualization of an audio file into a video stream as fast as possible.
+ *
+ * Replaces the regular render loop if the application was started with --renderOutput. Instead of the wall clock,
+ * a virtual clock advances by exactly 1/fps seconds per frame, and each frame receives exactly that amount of audio
+ * from the non-realtime file backend. Frames are rendered without any limiter or vsync and read back asynchronously
+ * by a FrameCapture, so the GPU keeps working on the next frames while the previous ones are written by the
+ * FrameWriter. Rendering stops when the audio file ends or the configured duration is reached.
+ *
+ * With the same audio file, presets, settings and seed, the output is identical between runs. Both the random
+ * preset selection and the C library's generator used by projectM are seeded. The virtual clock requires
+ * libprojectM 4.1 or later. With older versions, preset timing still follows the wall clock and isn't reproducible.
+ *
+ * Rendering in headless mode is recommended, as the output size is fixed to the drawable size on startup.
+ */
+class OfflineRenderer
+{
+public:
+    OfflineRenderer();
+
+    /**
+     * @brief Renders all frames and writes them to the output.
+     *
+     * Returns early if the window is closed, the escape key is pressed or the output can't be written anymore.
+     *
+     * @throws Poco::OpenFileException if the output file can't be opened.
+     */
+    void Run();
+
+protected:
+    /**
+     * @brief Seeds projectM's and the preset shuffle's random generators with the configured seed.
+     */
+    void SeedRandomGenerators();
+
+    /**
+     * @brief Sets projectM's virtual clock to the time of the given frame.
+     * @param frame The frame index, starting at 0.
+     */
+    void SetFrameTime(uint64_t frame);
+
+    /**
+     * @brief Frame consumer, writes a captured frame to the output.
+     * @param frame The captured frame.
+     */
+    void WriteFrame(const FrameCapture::Frame& frame);
+
+    /**
+     * @brief Polls SDL events and checks if rendering should be aborted.
+     * @return True if the user closed the window or pressed escape.
+     */
+    bool AbortRequested();
+
+    AudioCapture& _audioCapture;
+    ProjectMWrapper& _projectMWrapper;
+    SDLRenderingWindow& _sdlRenderingWindow;
+
+    projectm_handle _projectMHandle{nullptr};
+
+    std::string _outputFileName; //!< Output file name, or "-" for standard output.
+    FrameWriter::Format _format{FrameWriter::Format::Y4M}; //!< The output video format.
+    uint32_t _seed{0}; //!< Seed for all random decisions.
+    double _duration{0.0}; //!< Maximum video duration in seconds. 0 renders until the audio ends.
+    int _fps{60}; //!< Output frame rate.
+
+    int _width{0}; //!< Output frame width.
+    int _height{0}; //!< Output frame height.
+
+    FrameCapture _frameCapture; //!< Reads the rendered frames back from the GPU.
+    FrameWriter _frameWriter; //!< Converts and writes the frames.
+    uint64_t _writtenFrames{0}; //!< Number of frames written to the output.
+
+    bool _aborted{false}; //!< True if the user requested to abort rendering.
+    bool _writeFailed{false}; //!< True if the output couldn't be written.
+
+    Poco::Logger& _logger{Poco::Logger::get("OfflineRenderer")}; //!< The class logger.
+};
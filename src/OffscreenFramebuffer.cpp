@@ -0,0 +1,134 @@
+#include "OffscreenFramebuffer.h"
+
+#ifdef USE_GLEW
+#include <GL/glew.h>
+#endif
+
+#include <SDL2/SDL_opengl.h>
+
+namespace {
+
+/**
+ * @brief OpenGL 3.0 framebuffer functions.
+ */
+struct FramebufferFunctions
+{
+    void(APIENTRY* genFramebuffers)(GLsizei, GLuint*){nullptr};
+    void(APIENTRY* deleteFramebuffers)(GLsizei, const GLuint*){nullptr};
+    void(APIENTRY* bindFramebuffer)(GLenum, GLuint){nullptr};
+    GLenum(APIENTRY* checkFramebufferStatus)(GLenum){nullptr};
+    void(APIENTRY* blitFramebuffer)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum){nullptr};
+    void(APIENTRY* genRenderbuffers)(GLsizei, GLuint*){nullptr};
+    void(APIENTRY* deleteRenderbuffers)(GLsizei, const GLuint*){nullptr};
+    void(APIENTRY* bindRenderbuffer)(GLenum, GLuint){nullptr};
+    void(APIENTRY* renderbufferStorage)(GLenum, GLenum, GLsizei, GLsizei){nullptr};
+    void(APIENTRY* framebufferRenderbuffer)(GLenum, GLenum, GLenum, GLuint){nullptr};
+
+    bool loaded{false};
+};
+
+FramebufferFunctions functions;
+
+template<typename Function>
+bool LoadFunction(OffscreenFramebuffer::ProcAddressFunction getProcAddress, Function& function, const char* name)
+{
+    function = reinterpret_cast<Function>(getProcAddress(name));
+    return function != nullptr;
+}
+
+} // namespace
+
+OffscreenFramebuffer::~OffscreenFramebuffer()
+{
+    Destroy();
+}
+
+bool OffscreenFramebuffer::LoadFunctions(ProcAddressFunction getProcAddress)
+{
+    functions.loaded = LoadFunction(getProcAddress, functions.genFramebuffers, "glGenFramebuffers") &&
+                       LoadFunction(getProcAddress, functions.deleteFramebuffers, "glDeleteFramebuffers") &&
+                       LoadFunction(getProcAddress, functions.bindFramebuffer, "glBindFramebuffer") &&
+                       LoadFunction(getProcAddress, functions.checkFramebufferStatus, "glCheckFramebufferStatus") &&
+                       LoadFunction(getProcAddress, functions.blitFramebuffer, "glBlitFramebuffer") &&
+                       LoadFunction(getProcAddress, functions.genRenderbuffers, "glGenRenderbuffers") &&
+                       LoadFunction(getProcAddress, functions.deleteRenderbuffers, "glDeleteRenderbuffers") &&
+                       LoadFunction(getProcAddress, functions.bindRenderbuffer, "glBindRenderbuffer") &&
+                       LoadFunction(getProcAddress, functions.renderbufferStorage, "glRenderbufferStorage") &&
+                       LoadFunction(getProcAddress, functions.framebufferRenderbuffer, "glFramebufferRenderbuffer");
+
+    return functions.loaded;
+}
+
+bool OffscreenFramebuffer::Available()
+{
+    return functions.loaded;
+}
+
+void OffscreenFramebuffer::Bind(uint32_t framebuffer)
+{
+    functions.bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+bool OffscreenFramebuffer::Create(int width, int height)
+{
+    Destroy();
+
+    _width = width;
+    _height = height;
+
+    functions.genRenderbuffers(1, &_colorBuffer);
+    functions.bindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+    functions.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    functions.bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    functions.genFramebuffers(1, &_framebuffer);
+    functions.bindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    functions.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+    auto status = functions.checkFramebufferStatus(GL_FRAMEBUFFER);
+    functions.bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void OffscreenFramebuffer::Destroy()
+{
+    if (_framebuffer != 0)
+    {
+        functions.deleteFramebuffers(1, &_framebuffer);
+        _framebuffer = 0;
+    }
+
+    if (_colorBuffer != 0)
+    {
+        functions.deleteRenderbuffers(1, &_colorBuffer);
+        _colorBuffer = 0;
+    }
+
+    _width = 0;
+    _height = 0;
+}
+
+void OffscreenFramebuffer::BlitTo(uint32_t target, int width, int height) const
+{
+    functions.bindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+    functions.bindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    functions.blitFramebuffer(0, 0, _width, _height,
+                              0, 0, width, height,
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    functions.bindFramebuffer(GL_FRAMEBUFFER, target);
+}
+
+uint32_t OffscreenFramebuffer::Name() const
+{
+    return _framebuffer;
+}
+
+int OffscreenFramebuffer::Width() const
+{
+    return _width;
+}
+
+int OffscreenFramebuffer::Height() const
+{
+    return _height;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief An OpenGL framebuffer object with a single RGBA color renderbuffer.
+ *
+ * The OpenGL 3.0 framebuffer functions are loaded at runtime via LoadFunctions(), as not all platforms' OpenGL
+ * libraries export them and GLEW isn't always in use. The functions must be loaded once after the OpenGL context
+ * was created and before any framebuffer is used.
+ */
+class OffscreenFramebuffer
+{
+public:
+    /**
+     * @brief Function returning the address of an OpenGL function, e.g. SDL_GL_GetProcAddress.
+     */
+    using ProcAddressFunction = void* (*)(const char*);
+
+    OffscreenFramebuffer() = default;
+
+    OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+
+    OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+
+    ~OffscreenFramebuffer();
+
+    /**
+     * @brief Loads the required OpenGL framebuffer functions.
+     * @param getProcAddress The function used to look up OpenGL functions in the current context.
+     * @return True if all functions are available.
+     */
+    static bool LoadFunctions(ProcAddressFunction getProcAddress);
+
+    /**
+     * @brief Returns whether framebuffers can be used.
+     * @return True if LoadFunctions() was called successfully.
+     */
+    static bool Available();
+
+    /**
+     * @brief Binds the given framebuffer for reading and drawing.
+     * @param framebuffer The framebuffer name. 0 binds the window's default framebuffer.
+     */
+    static void Bind(uint32_t framebuffer);
+
+    /**
+     * @brief (Re)creates the framebuffer with the given size.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @return True if the framebuffer is complete and can be rendered to.
+     */
+    bool Create(int width, int height);
+
+    /**
+     * @brief Deletes the framebuffer, if one was created.
+     */
+    void Destroy();
+
+    /**
+     * @brief Stretches the framebuffer's contents into another framebuffer using linear filtering.
+     * @param target The framebuffer to draw into.
+     * @param width The width of the target framebuffer.
+     * @param height The height of the target framebuffer.
+     */
+    void BlitTo(uint32_t target, int width, int height) const;
+
+    /**
+     * @brief Returns the OpenGL name of the framebuffer.
+     * @return The framebuffer name, or 0 if no framebuffer was created.
+     */
+    uint32_t Name() const;
+
+    int Width() const;
+
+    int Height() const;
+
+private:
+    uint32_t _framebuffer{0}; //!< Framebuffer object name.
+    uint32_t _colorBuffer{0}; //!< Color renderbuffer attached to the framebuffer.
+    int _width{0}; //!< Width of the color buffer.
+    int _height{0}; //!< Height of the color buffer.
+};
@@ -0,0 +1,107 @@
+#include "PresetCache.h"
+
+void PresetCache::Budget(size_t bytes)
+{
+    _budget = bytes;
+    Evict();
+}
+
+const std::string* PresetCache::Find(const std::string& fileName, const Poco::Timestamp& lastModified)
+{
+    auto it = _index.find(fileName);
+    if (it == _index.end())
+    {
+        _misses++;
+        return nullptr;
+    }
+
+    if (it->second->lastModified != lastModified)
+    {
+        Remove(fileName);
+        _misses++;
+        return nullptr;
+    }
+
+    _hits++;
+    _entries.splice(_entries.begin(), _entries, it->second);
+
+    return &it->second->data;
+}
+
+bool PresetCache::Contains(const std::string& fileName, const Poco::Timestamp& lastModified) const
+{
+    auto it = _index.find(fileName);
+    return it != _index.end() && it->second->lastModified == lastModified;
+}
+
+void PresetCache::Insert(const std::string& fileName, const Poco::Timestamp& lastModified, std::string data)
+{
+    Remove(fileName);
+
+    _size += data.size();
+    _entries.push_front({fileName, lastModified, std::move(data)});
+    _index.emplace(fileName, _entries.begin());
+
+    Evict();
+}
+
+void PresetCache::Remove(const std::string& fileName)
+{
+    auto it = _index.find(fileName);
+    if (it == _index.end())
+    {
+        return;
+    }
+
+    _size -= it->second->data.size();
+    _entries.erase(it->second);
+    _index.erase(it);
+}
+
+void PresetCache::Pin(const std::vector<std::string>& fileNames)
+{
+    _pinned.clear();
+    _pinned.insert(fileNames.begin(), fileNames.end());
+
+    // Previously pinned entries may now exceed the budget.
+    Evict();
+}
+
+void PresetCache::Clear()
+{
+    _entries.clear();
+    _index.clear();
+    _size = 0;
+}
+
+PresetCache::Statistics PresetCache::GetStatistics() const
+{
+    Statistics statistics;
+    statistics.hits = _hits;
+    statistics.misses = _misses;
+    statistics.evictions = _evictions;
+    statistics.entries = _entries.size();
+    statistics.size = _size;
+    statistics.budget = _budget;
+
+    return statistics;
+}
+
+void PresetCache::Evict()
+{
+    // Pinned entries count towards the size, so the budget may be exceeded while many presets are pinned.
+    auto it = _entries.end();
+    while (_size > _budget && it != _entries.begin())
+    {
+        --it;
+        if (_pinned.find(it->fileName) != _pinned.end())
+        {
+            continue;
+        }
+
+        _size -= it->data.size();
+        _index.erase(it->fileName);
+        it = _entries.erase(it);
+        _evictions++;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Poco/Timestamp.h>
+
+#include <cstdint>
+#include <list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Least-recently-used cache of preset file contents with a memory budget.
+ *
+ * Entries are keyed by file name and store the file's modification time. Lookups pass the file's current modification
+ * time, so outdated contents are never returned.
+ * If the total size exceeds the budget, the least recently used entries are evicted. Pinned entries, e.g. the
+ * presets predicted to be displayed next, are never evicted, so they may exceed the budget.
+ *
+ * The cache isn't thread-safe, the owner has to synchronize access.
+ */
+class PresetCache
+{
+public:
+    /**
+     * @brief Cache usage counters for tuning the budget.
+     */
+    struct Statistics
+    {
+        uint64_t hits{0}; //!< Number of lookups which found the preset in memory.
+        uint64_t misses{0}; //!< Number of lookups which had to fall back to loading the preset from disk.
+        uint64_t evictions{0}; //!< Number of entries removed to stay within the budget.
+        size_t entries{0}; //!< Number of cached presets.
+        size_t size{0}; //!< Total size of all cached presets in bytes.
+        size_t budget{0}; //!< The configured memory budget in bytes.
+    };
+
+    /**
+     * @brief Sets the memory budget and evicts entries if it's exceeded.
+     * @param bytes The maximum total size of all unpinned entries in bytes.
+     */
+    void Budget(size_t bytes);
+
+    /**
+     * @brief Looks up a preset, marks it as most recently used and counts a hit or miss.
+     *
+     * If the file was modified since it was cached, the outdated entry is removed and the lookup counts as a miss.
+     *
+     * @param fileName The preset file name.
+     * @param lastModified The file's current modification time.
+     * @return A pointer to the file contents, valid until the cache is modified, or nullptr on a miss.
+     */
+    const std::string* Find(const std::string& fileName, const Poco::Timestamp& lastModified);
+
+    /**
+     * @brief Checks if the cached contents of a file are up to date, without affecting the usage order or counters.
+     * @param fileName The preset file name.
+     * @param lastModified The file's current modification time.
+     * @return True if the file is cached with the given modification time.
+     */
+    bool Contains(const std::string& fileName, const Poco::Timestamp& lastModified) const;
+
+    /**
+     * @brief Adds or replaces a preset as the most recently used entry, then evicts entries as needed.
+     * @param fileName The preset file name.
+     * @param lastModified The file's modification time when it was read.
+     * @param data The file contents.
+     */
+    void Insert(const std::string& fileName, const Poco::Timestamp& lastModified, std::string data);
+
+    /**
+     * @brief Removes a single entry, e.g. after the file was changed or deleted.
+     * @param fileName The preset file name. Nothing happens if it isn't cached.
+     */
+    void Remove(const std::string& fileName);
+
+    /**
+     * @brief Replaces the set of entries which must not be evicted.
+     * @param fileNames The file names to pin. Files don't need to be cached yet.
+     */
+    void Pin(const std::vector<std::string>& fileNames);
+
+    /**
+     * @brief Removes all entries. Counters are kept.
+     */
+    void Clear();
+
+    /**
+     * @brief Returns the current usage counters.
+     * @return The cache statistics.
+     */
+    Statistics GetStatistics() const;
+
+protected:
+    /**
+     * @brief A cached preset file.
+     */
+    struct Entry
+    {
+        std::string fileName; //!< The preset file name.
+        Poco::Timestamp lastModified; //!< Modification time of the file when it was read.
+        std::string data; //!< The file contents.
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /**
+     * @brief Removes least recently used, unpinned entries until the size is within the budget.
+     */
+    void Evict();
+
+    EntryList _entries; //!< Cached presets, most recently used first.
+    std::unordered_map<std::string, EntryList::iterator> _index; //!< Maps file names to their entries.
+    std::set<std::string> _pinned; //!< File names which must not be evicted.
+
+    size_t _budget{0}; //!< Memory budget in bytes.
+    size_t _size{0}; //!< Total size of all cached file contents in bytes.
+
+    uint64_t _hits{0}; //!< Number of successful lookups.
+    uint64_t _misses{0}; //!< Number of failed lookups.
+    uint64_t _evictions{0}; //!< Number of evicted entries.
+};
@@ -0,0 +1,426 @@
+#include "PresetDirectoryWatcher.h"
+
+#include "PresetScanner.h"
+
+#include <Poco/DirectoryIterator.h>
+#include <Poco/Exception.h>
+#include <Poco/Path.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::chrono::milliseconds QuietPeriod{500}; //!< A batch is published after no event was received for this long.
+constexpr std::chrono::milliseconds MaximumDelay{5000}; //!< A batch is published at the latest after this time.
+
+constexpr uint32_t WatchMask{IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE |
+                             IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR};
+
+/**
+ * @brief Checks if a path is inside a directory or the directory itself.
+ */
+bool StartsWith(const std::string& path, const std::string& directory)
+{
+    return path.compare(0, directory.size(), directory) == 0;
+}
+
+} // namespace
+
+PresetDirectoryWatcher::~PresetDirectoryWatcher()
+{
+    if (_watchThread.joinable())
+    {
+        char wake{0};
+        if (write(_wakePipe[1], &wake, 1) < 0)
+        {
+            poco_error_f1(_logger, "Could not stop the preset directory watcher: %s", std::string(std::strerror(errno)));
+        }
+        _watchThread.join();
+    }
+
+    for (auto fd : {_inotifyFd, _wakePipe[0], _wakePipe[1]})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+void PresetDirectoryWatcher::Start(const std::vector<std::string>& directories)
+{
+    _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyFd < 0)
+    {
+        throw Poco::SystemException("Could not create inotify instance", std::strerror(errno));
+    }
+
+    if (pipe2(_wakePipe, O_CLOEXEC) < 0)
+    {
+        throw Poco::SystemException("Could not create wake-up pipe", std::strerror(errno));
+    }
+
+    _watchThread = std::thread(&PresetDirectoryWatcher::Watch, this, directories);
+}
+
+bool PresetDirectoryWatcher::TakeChanges(Changes& changes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_changes.empty())
+    {
+        return false;
+    }
+
+    changes = std::move(_changes.front());
+    _changes.pop_front();
+
+    return true;
+}
+
+void PresetDirectoryWatcher::Watch(std::vector<std::string> directories)
+{
+    // Adding thousands of watches takes a moment, so it's not done on the render thread.
+    for (const auto& directory : directories)
+    {
+        AddWatch(directory);
+    }
+
+    poco_information_f1(_logger, "Watching %?u preset directories for changes.", _watchDescriptors.size());
+
+    while (true)
+    {
+        int timeout{-1};
+        if (HasPendingChanges())
+        {
+            auto deadline = std::min(_lastPendingChange + QuietPeriod, _firstPendingChange + MaximumDelay);
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            timeout = static_cast<int>(std::max(remaining.count(), static_cast<std::chrono::milliseconds::rep>(0)));
+        }
+
+        pollfd fds[2]{{_inotifyFd, POLLIN, 0}, {_wakePipe[0], POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            poco_error_f1(_logger, "Stopped watching preset directories: %s", std::string(std::strerror(errno)));
+            break;
+        }
+
+        if (fds[1].revents != 0)
+        {
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            bool hadPendingChanges = HasPendingChanges();
+            ReadEvents();
+
+            if (_resyncRequired)
+            {
+                Resync();
+            }
+
+            // Any event extends the quiet period, as long as the maximum delay isn't exceeded.
+            if (HasPendingChanges())
+            {
+                _lastPendingChange = Clock::now();
+                if (!hadPendingChanges)
+                {
+                    _firstPendingChange = _lastPendingChange;
+                }
+            }
+        }
+
+        if (HasPendingChanges())
+        {
+            auto now = Clock::now();
+            if (now - _lastPendingChange >= QuietPeriod || now - _firstPendingChange >= MaximumDelay)
+            {
+                PublishChanges();
+            }
+        }
+    }
+}
+
+void PresetDirectoryWatcher::ReadEvents()
+{
+    alignas(inotify_event) char buffer[16384];
+
+    while (true)
+    {
+        auto length = read(_inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            if (length < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                poco_error_f1(_logger, "Could not read inotify events: %s", std::string(std::strerror(errno)));
+            }
+            return;
+        }
+
+        for (char* position = buffer; position < buffer + length;)
+        {
+            auto event = reinterpret_cast<const inotify_event*>(position);
+            position += sizeof(inotify_event) + event->len;
+
+            if ((event->mask & IN_Q_OVERFLOW) != 0)
+            {
+                poco_warning(_logger, "Preset directory events were lost, listing all preset directories again.");
+                _resyncRequired = true;
+                continue;
+            }
+
+            auto watchedDirectory = _watchedDirectories.find(event->wd);
+            if (watchedDirectory == _watchedDirectories.end())
+            {
+                continue;
+            }
+
+            // Copy, the directory entry may be erased below.
+            std::string directory = watchedDirectory->second;
+
+            if ((event->mask & IN_IGNORED) != 0)
+            {
+                // The watch was removed, either explicitly or because the directory is gone.
+                _watchDescriptors.erase(directory);
+                _watchedDirectories.erase(watchedDirectory);
+                continue;
+            }
+
+            if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+            {
+                // Subdirectories are handled by their parent's events, only root directories need this.
+                auto parent = Poco::Path(directory).parent().toString();
+                if (_watchDescriptors.find(parent) == _watchDescriptors.end())
+                {
+                    RemoveDirectoryTree(directory);
+                }
+                continue;
+            }
+
+            if (event->len == 0)
+            {
+                continue;
+            }
+
+            std::string path = directory + event->name;
+
+            if ((event->mask & IN_ISDIR) != 0)
+            {
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                {
+                    AddDirectoryTree(path + "/");
+                }
+                else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                {
+                    RemoveDirectoryTree(path + "/");
+                }
+            }
+            else if (PresetScanner::IsPresetFile(event->name))
+            {
+                if ((event->mask & IN_CREATE) != 0)
+                {
+                    // Reported once closed after writing.
+                    _createdPresets.insert(path);
+                }
+                else if ((event->mask & IN_CLOSE_WRITE) != 0)
+                {
+                    // A file created in this batch stays added, no matter how often it's written.
+                    auto pendingPreset = _pendingPresets.find(path);
+                    bool added = _createdPresets.erase(path) > 0 ||
+                                 (pendingPreset != _pendingPresets.end() && pendingPreset->second == PresetChange::Added);
+                    _pendingPresets[path] = added ? PresetChange::Added : PresetChange::Modified;
+                }
+                else if ((event->mask & IN_MOVED_TO) != 0)
+                {
+                    _pendingPresets[path] = PresetChange::Added;
+                }
+                else if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0)
+                {
+                    _createdPresets.erase(path);
+                    _pendingPresets[path] = PresetChange::Removed;
+                }
+            }
+        }
+    }
+}
+
+bool PresetDirectoryWatcher::AddWatch(const std::string& path)
+{
+    auto watchDescriptor = inotify_add_watch(_inotifyFd, path.c_str(), WatchMask);
+    if (watchDescriptor < 0)
+    {
+        if (errno == ENOSPC && !_watchLimitReached)
+        {
+            _watchLimitReached = true;
+            poco_warning(_logger, "The inotify watch limit was reached, not all preset directories are watched. "
+                                  "Increase fs.inotify.max_user_watches to watch all of them.");
+        }
+        else if (errno != ENOSPC)
+        {
+            poco_debug_f2(_logger, R"(Could not watch preset directory "%s": %s)", path, std::string(std::strerror(errno)));
+        }
+        return false;
+    }
+
+    _watchedDirectories.emplace(watchDescriptor, path);
+    _watchDescriptors[path] = watchDescriptor;
+
+    return true;
+}
+
+void PresetDirectoryWatcher::AddDirectoryTree(const std::string& path)
+{
+    if (AddWatch(path))
+    {
+        // The directory may already be gone again, which is reported by a separate event.
+        ListDirectory(path);
+    }
+}
+
+bool PresetDirectoryWatcher::ListDirectory(const std::string& path)
+{
+    try
+    {
+        Poco::DirectoryIterator end;
+        for (Poco::DirectoryIterator it(path); it != end; ++it)
+        {
+            try
+            {
+                if (PresetScanner::IsPresetFile(it.name()) && it->isFile())
+                {
+                    _pendingPresets[path + it.name()] = PresetChange::Added;
+                }
+                else if (it->isDirectory() && !it->isLink())
+                {
+                    auto subdirectory = path + it.name() + "/";
+                    if (_watchDescriptors.find(subdirectory) == _watchDescriptors.end())
+                    {
+                        AddDirectoryTree(subdirectory);
+                    }
+                }
+            }
+            catch (const Poco::Exception& ex)
+            {
+                poco_debug_f2(_logger, R"(Skipping "%s": %s)", it.path().toString(), ex.displayText());
+            }
+        }
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_debug_f2(_logger, R"(Could not list preset directory "%s": %s)", path, ex.displayText());
+        return false;
+    }
+
+    return true;
+}
+
+void PresetDirectoryWatcher::Resync()
+{
+    _resyncRequired = false;
+    _pendingPresets.clear();
+
+    std::vector<std::string> directories;
+    directories.reserve(_watchDescriptors.size());
+    for (const auto& watchDescriptor : _watchDescriptors)
+    {
+        directories.push_back(watchDescriptor.first);
+    }
+
+    for (const auto& directory : directories)
+    {
+        // Skip subdirectories of a tree which was removed in an earlier iteration.
+        if (_watchDescriptors.find(directory) != _watchDescriptors.end() && !ListDirectory(directory))
+        {
+            RemoveDirectoryTree(directory);
+        }
+    }
+
+    // Everything not listed is gone, so removed directories don't have to be reported separately.
+    _pendingRemovedDirectories.clear();
+
+    Changes changes;
+    changes.resync = true;
+    for (const auto& preset : _pendingPresets)
+    {
+        changes.addedPresets.push_back(preset.first);
+    }
+    _pendingPresets.clear();
+
+    poco_information_f2(_logger, "Resynchronized %?u presets in %?u watched directories.",
+                        changes.addedPresets.size(), _watchDescriptors.size());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _changes.push_back(std::move(changes));
+}
+
+void PresetDirectoryWatcher::RemoveDirectoryTree(const std::string& path)
+{
+    for (auto it = _watchDescriptors.lower_bound(path); it != _watchDescriptors.end() && StartsWith(it->first, path);)
+    {
+        // Fails harmlessly if the kernel already removed the watch with the directory.
+        inotify_rm_watch(_inotifyFd, it->second);
+        _watchedDirectories.erase(it->second);
+        it = _watchDescriptors.erase(it);
+    }
+
+    // Earlier changes inside the directory are superseded by its removal.
+    for (auto it = _pendingPresets.lower_bound(path); it != _pendingPresets.end() && StartsWith(it->first, path);)
+    {
+        it = _pendingPresets.erase(it);
+    }
+    for (auto it = _createdPresets.lower_bound(path); it != _createdPresets.end() && StartsWith(*it, path);)
+    {
+        it = _createdPresets.erase(it);
+    }
+
+    _pendingRemovedDirectories.push_back(path);
+}
+
+bool PresetDirectoryWatcher::HasPendingChanges() const
+{
+    return !_pendingPresets.empty() || !_pendingRemovedDirectories.empty();
+}
+
+void PresetDirectoryWatcher::PublishChanges()
+{
+    Changes changes;
+    changes.removedDirectories.swap(_pendingRemovedDirectories);
+    for (const auto& preset : _pendingPresets)
+    {
+        switch (preset.second)
+        {
+            case PresetChange::Added:
+                changes.addedPresets.push_back(preset.first);
+                break;
+
+            case PresetChange::Modified:
+                changes.modifiedPresets.push_back(preset.first);
+                break;
+
+            case PresetChange::Removed:
+                changes.removedPresets.push_back(preset.first);
+                break;
+        }
+    }
+    _pendingPresets.clear();
+
+    poco_debug_f4(_logger, "Publishing preset changes: %?u added, %?u modified, %?u removed, %?u directories removed.",
+                  changes.addedPresets.size(), changes.modifiedPresets.size(), changes.removedPresets.size(),
+                  changes.removedDirectories.size());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _changes.push_back(std::move(changes));
+}
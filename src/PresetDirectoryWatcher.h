@@ -0,0 +1,171 @@
+#pragma once
+
+#include <Poco/Logger.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Watches the preset directory trees with inotify and reports added, removed and renamed presets.
+ *
+ * Events are read on a background thread. As tools like rsync or unpacking an archive cause bursts of thousands of
+ * events, they're coalesced: changes are collected until no event was received for a short quiet period, or at most a
+ * few seconds, and then published as a single batch. Within a batch, only the final state of each preset counts, so
+ * a file which was created and deleted again doesn't show up at all.
+ *
+ * Preset files are reported as added once they were closed after writing or moved into a watched directory, so
+ * partially written files are never reported. Existing files which are written again are reported as modified.
+ * Temporary files written by rsync or editors don't have a preset file extension and are ignored until renamed to
+ * their final name. New subdirectories are watched and listed recursively when they appear, removed or moved away
+ * directories are reported as a whole.
+ *
+ * If the kernel event queue overflows, events are lost. In this case, all watched directories are listed again and a
+ * full resync is published, which contains all presets in the watched trees. Changes which happen between the
+ * directory scan and the start of the watcher are missed.
+ */
+class PresetDirectoryWatcher
+{
+public:
+    /**
+     * @brief A batch of changes to the preset library.
+     *
+     * Changes should be applied in member order: removed directories first, then removed, added and modified presets.
+     *
+     * If resync is true, events were lost. addedPresets then lists all presets in the watched trees, all other presets
+     * are gone, and any of them may have been modified.
+     */
+    struct Changes
+    {
+        bool resync{false}; //!< True if this is a full resync after lost events, see above.
+        std::vector<std::string> removedDirectories; //!< Removed directories, with a trailing separator. All presets below are gone.
+        std::vector<std::string> removedPresets; //!< Full paths of removed preset files.
+        std::vector<std::string> addedPresets; //!< Full paths of new preset files, or files moved over an existing one.
+        std::vector<std::string> modifiedPresets; //!< Full paths of existing preset files which were written again.
+    };
+
+    PresetDirectoryWatcher() = default;
+
+    PresetDirectoryWatcher(const PresetDirectoryWatcher&) = delete;
+
+    PresetDirectoryWatcher& operator=(const PresetDirectoryWatcher&) = delete;
+
+    /**
+     * @brief Stops watching and releases the inotify instance.
+     */
+    ~PresetDirectoryWatcher();
+
+    /**
+     * @brief Starts watching the given directories in the background.
+     *
+     * The directories aren't watched recursively by inotify, so every directory in the trees has to be passed.
+     *
+     * @throws Poco::SystemException if the inotify instance couldn't be created.
+     * @param directories The directories to watch, with a trailing separator.
+     */
+    void Start(const std::vector<std::string>& directories);
+
+    /**
+     * @brief Returns the oldest batch of changes which hasn't been taken yet.
+     * @param[out] changes Receives the changes.
+     * @return True if a batch was available.
+     */
+    bool TakeChanges(Changes& changes);
+
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief The final state of a preset file within a batch.
+     */
+    enum class PresetChange
+    {
+        Added,
+        Modified,
+        Removed
+    };
+
+    /**
+     * @brief Watch thread function, adds the initial watches and processes events until stopped.
+     * @param directories The directories to watch.
+     */
+    void Watch(std::vector<std::string> directories);
+
+    /**
+     * @brief Reads and handles all queued inotify events.
+     */
+    void ReadEvents();
+
+    /**
+     * @brief Adds a watch for a single directory.
+     * @param path The directory path, with a trailing separator.
+     * @return True if the directory is watched.
+     */
+    bool AddWatch(const std::string& path);
+
+    /**
+     * @brief Watches a new directory and its subdirectories and records all presets in them as added.
+     *
+     * The watch is added before listing the directory, so files created in the meantime aren't missed.
+     *
+     * @param path The directory path, with a trailing separator.
+     */
+    void AddDirectoryTree(const std::string& path);
+
+    /**
+     * @brief Records all presets in a watched directory as added and adds subdirectories which aren't watched yet.
+     * @param path The directory path, with a trailing separator.
+     * @return True if the directory could be listed.
+     */
+    bool ListDirectory(const std::string& path);
+
+    /**
+     * @brief Lists all watched directories again and publishes the result as a full resync.
+     *
+     * Called after the kernel event queue overflowed. Pending changes are superseded by the resync.
+     */
+    void Resync();
+
+    /**
+     * @brief Removes the watches of a directory and all its subdirectories and records it as removed.
+     * @param path The directory path, with a trailing separator.
+     */
+    void RemoveDirectoryTree(const std::string& path);
+
+    /**
+     * @brief Returns whether changes are waiting to be published.
+     * @return True if any preset or directory was added or removed since the last batch.
+     */
+    bool HasPendingChanges() const;
+
+    /**
+     * @brief Moves all pending changes into a new batch for TakeChanges().
+     */
+    void PublishChanges();
+
+    int _inotifyFd{-1}; //!< The inotify instance.
+    int _wakePipe[2]{-1, -1}; //!< Written to by the destructor to wake up the watch thread.
+    std::thread _watchThread; //!< Runs Watch().
+
+    // Only accessed by the watch thread.
+    std::unordered_map<int, std::string> _watchedDirectories; //!< Directory paths by watch descriptor.
+    std::map<std::string, int> _watchDescriptors; //!< Watch descriptors by directory path, sorted to find whole trees.
+    std::map<std::string, PresetChange> _pendingPresets; //!< Changed preset files and their final state in this batch.
+    std::set<std::string> _createdPresets; //!< Preset files which were created, but not closed after writing yet.
+    std::vector<std::string> _pendingRemovedDirectories; //!< Directories removed since the last batch.
+    Clock::time_point _firstPendingChange; //!< Time of the first event in the pending batch.
+    Clock::time_point _lastPendingChange; //!< Time of the last event in the pending batch.
+    bool _watchLimitReached{false}; //!< True after the warning about the inotify watch limit was logged.
+    bool _resyncRequired{false}; //!< True if events were lost and all directories have to be listed again.
+
+    std::mutex _mutex; //!< Protects _changes.
+    std::deque<Changes> _changes; //!< Published batches, not yet taken by TakeChanges().
+
+    Poco::Logger& _logger{Poco::Logger::get("PresetDirectoryWatcher")}; //!< The class logger.
+};
@@ -0,0 +1,177 @@
+#include "PresetPrefetcher.h"
+
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/StreamCopier.h>
+
+#include <algorithm>
+
+PresetPrefetcher::~PresetPrefetcher()
+{
+    Stop();
+}
+
+void PresetPrefetcher::Start(size_t cacheSize)
+{
+    if (_workerThread.joinable())
+    {
+        return;
+    }
+
+    _stop = false;
+    _cache.Budget(cacheSize);
+    _workerThread = std::thread(&PresetPrefetcher::Worker, this);
+}
+
+void PresetPrefetcher::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+        _wantedFiles.clear();
+        _checkedFiles.clear();
+        _cache.Clear();
+    }
+    _condition.notify_one();
+
+    if (_workerThread.joinable())
+    {
+        _workerThread.join();
+    }
+}
+
+void PresetPrefetcher::Prefetch(const std::vector<std::string>& fileNames)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _wantedFiles = fileNames;
+        _cache.Pin(_wantedFiles);
+
+        // Files which are predicted again later are checked for modifications again.
+        for (auto it = _checkedFiles.begin(); it != _checkedFiles.end();)
+        {
+            it = std::find(_wantedFiles.begin(), _wantedFiles.end(), *it) != _wantedFiles.end()
+                     ? std::next(it)
+                     : _checkedFiles.erase(it);
+        }
+    }
+    _condition.notify_one();
+}
+
+void PresetPrefetcher::Invalidate(const std::vector<std::string>& fileNames)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& fileName : fileNames)
+        {
+            _cache.Remove(fileName);
+            _checkedFiles.erase(fileName);
+        }
+    }
+    _condition.notify_one();
+}
+
+bool PresetPrefetcher::Get(const std::string& fileName, std::string& data)
+{
+    Poco::Timestamp lastModified{0};
+    try
+    {
+        lastModified = Poco::File(fileName).getLastModified();
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_debug_f2(_logger, R"(Could not check preset "%s": %s)", fileName, ex.displayText());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto cachedData = _cache.Find(fileName, lastModified);
+    if (cachedData == nullptr)
+    {
+        poco_debug_f1(_logger, R"(Preset "%s" isn't cached or was modified.)", fileName);
+
+        // A modified file is read again the next time it's predicted.
+        _checkedFiles.erase(fileName);
+        return false;
+    }
+
+    data = *cachedData;
+
+    return true;
+}
+
+PresetCache::Statistics PresetPrefetcher::CacheStatistics()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cache.GetStatistics();
+}
+
+void PresetPrefetcher::Worker()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_stop)
+    {
+        auto nextFile = std::find_if(_wantedFiles.begin(), _wantedFiles.end(), [this](const std::string& fileName) {
+            return _checkedFiles.find(fileName) == _checkedFiles.end();
+        });
+
+        if (nextFile == _wantedFiles.end())
+        {
+            _condition.wait(lock);
+            continue;
+        }
+
+        std::string fileName = *nextFile;
+
+        // Don't block the render thread while accessing the file, the list may change in the meantime.
+        lock.unlock();
+
+        Poco::Timestamp lastModified{0};
+        try
+        {
+            lastModified = Poco::File(fileName).getLastModified();
+        }
+        catch (const Poco::Exception& ex)
+        {
+            poco_debug_f2(_logger, R"(Could not check preset "%s": %s)", fileName, ex.displayText());
+        }
+
+        lock.lock();
+        if (_cache.Contains(fileName, lastModified))
+        {
+            _checkedFiles.insert(fileName);
+            continue;
+        }
+        lock.unlock();
+
+        std::string data;
+        bool success{false};
+        try
+        {
+            Poco::FileInputStream stream(fileName);
+            Poco::StreamCopier::copyToString(stream, data);
+            success = !stream.bad();
+        }
+        catch (const Poco::Exception& ex)
+        {
+            poco_debug_f2(_logger, R"(Could not prefetch preset "%s": %s)", fileName, ex.displayText());
+        }
+
+        lock.lock();
+
+        if (std::find(_wantedFiles.begin(), _wantedFiles.end(), fileName) == _wantedFiles.end())
+        {
+            continue;
+        }
+
+        // Failed files are marked as checked as well, so they're only retried after being predicted again.
+        _checkedFiles.insert(fileName);
+        if (success)
+        {
+            _cache.Insert(fileName, lastModified, std::move(data));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "PresetCache.h"
+
+#include <Poco/Logger.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Reads upcoming preset files into memory on a worker thread.
+ *
+ * The ProjectMWrapper predicts which presets will be displayed next and passes their file names to Prefetch().
+ * The worker thread reads these files in order into a PresetCache. Preset switches can then hand the data to projectM
+ * without touching the disk on the render thread, which avoids frame hitches with slow or network-mounted preset
+ * directories.
+ *
+ * Predicted files stay pinned in the cache. Other presets remain cached within the memory budget, so going back to
+ * recently displayed presets doesn't read them again. Whenever a file is predicted, the worker compares its
+ * modification time with the cached entry and reads it again if it has changed. Get() checks the modification time as
+ * well, so a file overwritten after it was cached is never served with its old contents.
+ */
+class PresetPrefetcher
+{
+public:
+    PresetPrefetcher() = default;
+
+    PresetPrefetcher(const PresetPrefetcher&) = delete;
+
+    PresetPrefetcher& operator=(const PresetPrefetcher&) = delete;
+
+    /**
+     * @brief Stops the worker thread.
+     */
+    ~PresetPrefetcher();
+
+    /**
+     * @brief Starts the worker thread.
+     * @param cacheSize The memory budget for presets which aren't predicted anymore, in bytes. With 0, only the
+     *                  predicted presets are kept.
+     */
+    void Start(size_t cacheSize);
+
+    /**
+     * @brief Stops the worker thread and discards all prefetched data.
+     */
+    void Stop();
+
+    /**
+     * @brief Replaces the list of files to keep in memory.
+     *
+     * Files which are no longer in the list are unpinned, new or modified files are read in the given order.
+     *
+     * @param fileNames The files which will most likely be displayed next, most likely first.
+     */
+    void Prefetch(const std::vector<std::string>& fileNames);
+
+    /**
+     * @brief Discards the cached contents of changed or removed files.
+     *
+     * Files which are still predicted are read again in the background.
+     *
+     * @param fileNames The preset file names. Files which aren't cached are ignored.
+     */
+    void Invalidate(const std::vector<std::string>& fileNames);
+
+    /**
+     * @brief Returns the cached contents of a preset file.
+     *
+     * Only reads the file's modification time, never its contents. If the file isn't cached or was modified since,
+     * returns false and the caller has to load it from disk. Each call counts as a cache hit or miss.
+     *
+     * @param fileName The preset file name.
+     * @param[out] data Receives the file contents.
+     * @return True if the file contents were available, false if not.
+     */
+    bool Get(const std::string& fileName, std::string& data);
+
+    /**
+     * @brief Returns the usage counters of the preset cache.
+     * @return The cache statistics.
+     */
+    PresetCache::Statistics CacheStatistics();
+
+protected:
+    /**
+     * @brief Worker thread function, reads all wanted files which aren't cached yet or have been modified.
+     */
+    void Worker();
+
+    std::thread _workerThread; //!< Thread reading the files.
+    std::mutex _mutex; //!< Protects all members below.
+    std::condition_variable _condition; //!< Signals a changed file list or stop request to the worker.
+    bool _stop{false}; //!< True if the worker should exit.
+
+    std::vector<std::string> _wantedFiles; //!< Files to prefetch, most likely first.
+    std::set<std::string> _checkedFiles; //!< Wanted files which are cached and up to date, or couldn't be read.
+    PresetCache _cache; //!< Contents of already read files.
+
+    Poco::Logger& _logger{Poco::Logger::get("PresetPrefetcher")}; //!< The class logger.
+};
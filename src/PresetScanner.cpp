@@ -0,0 +1,360 @@
+#include "PresetScanner.h"
+
+#include <Poco/BinaryReader.h>
+#include <Poco/BinaryWriter.h>
+#include <Poco/Clock.h>
+#include <Poco/DirectoryIterator.h>
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Path.h>
+#include <Poco/String.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+constexpr Poco::UInt32 IndexMagic{0x49504d50}; //!< "PMPI" in little endian byte order.
+constexpr Poco::UInt32 IndexVersion{1}; //!< Index format version, incremented on incompatible changes.
+
+} // namespace
+
+PresetScanner::PresetScanner(std::string indexFile)
+    : _indexFile(std::move(indexFile))
+{
+}
+
+PresetScanner::~PresetScanner()
+{
+    _stop = true;
+    Wait();
+}
+
+void PresetScanner::Start(const std::vector<std::string>& rootDirectories)
+{
+    for (const auto& rootDirectory : rootDirectories)
+    {
+        auto path = Poco::Path(rootDirectory).makeDirectory().toString();
+        if (_scannedDirectories.emplace(path, DirectoryEntry()).second)
+        {
+            _pendingDirectories.push_back(path);
+        }
+    }
+
+    _scanThread = std::thread(&PresetScanner::Scan, this);
+}
+
+bool PresetScanner::TakeFoundPresets(std::vector<std::string>& presetFiles)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    presetFiles.clear();
+    presetFiles.swap(_foundPresets);
+
+    return !presetFiles.empty();
+}
+
+bool PresetScanner::Finished() const
+{
+    return _finished;
+}
+
+void PresetScanner::Wait()
+{
+    if (_scanThread.joinable())
+    {
+        _scanThread.join();
+    }
+}
+
+std::vector<std::string> PresetScanner::Directories()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<std::string> directories;
+    directories.reserve(_scannedDirectories.size());
+    for (const auto& directory : _scannedDirectories)
+    {
+        directories.push_back(directory.first);
+    }
+
+    return directories;
+}
+
+bool PresetScanner::IsPresetFile(const std::string& fileName)
+{
+    auto extension = Poco::Path(fileName).getExtension();
+    return Poco::icompare(extension, "milk") == 0 || Poco::icompare(extension, "prjm") == 0;
+}
+
+void PresetScanner::Scan()
+{
+    Poco::Clock startTime;
+
+    ReadIndex();
+
+    // Many parallel requests also help on a single disk, as the I/O scheduler can reorder them.
+    auto threadCount = std::min(std::max(std::thread::hardware_concurrency(), 4u), 16u);
+    std::vector<std::thread> workers;
+    for (unsigned int thread = 0; thread < threadCount; thread++)
+    {
+        workers.emplace_back(&PresetScanner::Worker, this);
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (_stop)
+    {
+        poco_debug(_logger, "Preset scan aborted.");
+        return;
+    }
+
+    poco_information_f4(_logger, "Found %?u presets in %?u directories in %.2f seconds, %?u directories had to be listed.",
+                        _presetCount, _scannedDirectories.size(),
+                        static_cast<double>(startTime.elapsed()) / 1000000.0, _listedDirectories);
+
+    // Presets are already passed on while scanning. Write the index before reporting the scan as finished, so the
+    // owner can destroy the scanner right away without waiting for the file to be written.
+    if (_listedDirectories > 0 || _scannedDirectories.size() != _indexedDirectories.size())
+    {
+        WriteIndex();
+    }
+
+    _finished = true;
+}
+
+void PresetScanner::Worker()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        // The scan is done once no directories are left and no other worker can add new ones.
+        _condition.wait(lock, [this]() {
+            return !_pendingDirectories.empty() || _activeWorkers == 0;
+        });
+
+        if (_pendingDirectories.empty())
+        {
+            break;
+        }
+
+        if (_stop)
+        {
+            _pendingDirectories.clear();
+            _condition.notify_all();
+            break;
+        }
+
+        auto path = _pendingDirectories.front();
+        _pendingDirectories.pop_front();
+        _activeWorkers++;
+
+        lock.unlock();
+        DirectoryEntry entry;
+        bool success = ScanDirectory(path, entry);
+        lock.lock();
+
+        _activeWorkers--;
+
+        if (success)
+        {
+            for (const auto& subdirectory : entry.subdirectories)
+            {
+                auto subdirectoryPath = Poco::Path(path).pushDirectory(subdirectory).toString();
+                if (_scannedDirectories.emplace(subdirectoryPath, DirectoryEntry()).second)
+                {
+                    _pendingDirectories.push_back(subdirectoryPath);
+                }
+            }
+
+            for (const auto& preset : entry.presets)
+            {
+                _foundPresets.push_back(path + preset.name);
+            }
+            _presetCount += entry.presets.size();
+
+            _scannedDirectories[path] = std::move(entry);
+        }
+        else
+        {
+            _scannedDirectories.erase(path);
+        }
+
+        _condition.notify_all();
+    }
+}
+
+bool PresetScanner::ScanDirectory(const std::string& path, DirectoryEntry& entry)
+{
+    try
+    {
+        auto lastModified = Poco::File(path).getLastModified();
+
+        auto indexedDirectory = _indexedDirectories.find(path);
+        if (indexedDirectory != _indexedDirectories.end() && indexedDirectory->second.lastModified == lastModified)
+        {
+            entry = indexedDirectory->second;
+            return true;
+        }
+
+        entry.lastModified = lastModified;
+
+        Poco::DirectoryIterator end;
+        for (Poco::DirectoryIterator it(path); it != end; ++it)
+        {
+            try
+            {
+                if (IsPresetFile(it.name()) && it->isFile())
+                {
+                    entry.presets.push_back({it.name(), it->getSize(), it->getLastModified()});
+                }
+                else if (it->isDirectory() && !it->isLink())
+                {
+                    entry.subdirectories.push_back(it.name());
+                }
+            }
+            catch (const Poco::Exception& ex)
+            {
+                // E.g. broken symbolic links.
+                poco_debug_f2(_logger, R"(Skipping "%s": %s)", it.path().toString(), ex.displayText());
+            }
+        }
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_warning_f2(_logger, R"(Could not scan preset directory "%s": %s)", path, ex.displayText());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _listedDirectories++;
+
+    return true;
+}
+
+void PresetScanner::ReadIndex()
+{
+    if (_indexFile.empty() || !Poco::File(_indexFile).exists())
+    {
+        return;
+    }
+
+    try
+    {
+        Poco::FileInputStream stream(_indexFile);
+        Poco::BinaryReader reader(stream, Poco::BinaryReader::LITTLE_ENDIAN_BYTE_ORDER);
+
+        Poco::UInt32 magic{0};
+        Poco::UInt32 version{0};
+        reader >> magic >> version;
+        if (magic != IndexMagic || version != IndexVersion)
+        {
+            poco_information_f1(_logger, R"(Ignoring preset index "%s" with unknown format.)", _indexFile);
+            return;
+        }
+
+        Poco::UInt32 directoryCount{0};
+        reader.read7BitEncoded(directoryCount);
+        for (Poco::UInt32 directoryIndex = 0; directoryIndex < directoryCount && reader.good(); directoryIndex++)
+        {
+            std::string path;
+            Poco::Int64 directoryModified{0};
+            reader >> path >> directoryModified;
+
+            DirectoryEntry entry;
+            entry.lastModified = Poco::Timestamp(directoryModified);
+
+            Poco::UInt32 subdirectoryCount{0};
+            reader.read7BitEncoded(subdirectoryCount);
+            for (Poco::UInt32 subdirectoryIndex = 0; subdirectoryIndex < subdirectoryCount && reader.good(); subdirectoryIndex++)
+            {
+                std::string name;
+                reader >> name;
+                entry.subdirectories.push_back(std::move(name));
+            }
+
+            Poco::UInt32 presetCount{0};
+            reader.read7BitEncoded(presetCount);
+            for (Poco::UInt32 presetIndex = 0; presetIndex < presetCount && reader.good(); presetIndex++)
+            {
+                FileEntry preset;
+                Poco::UInt64 size{0};
+                Poco::Int64 presetModified{0};
+                reader >> preset.name >> size >> presetModified;
+                preset.size = size;
+                preset.lastModified = Poco::Timestamp(presetModified);
+                entry.presets.push_back(std::move(preset));
+            }
+
+            _indexedDirectories.emplace(std::move(path), std::move(entry));
+        }
+
+        if (!reader.good())
+        {
+            throw Poco::DataFormatException("Unexpected end of file");
+        }
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_warning_f2(_logger, R"(Could not read preset index "%s", rescanning all presets: %s)",
+                        _indexFile, ex.displayText());
+        _indexedDirectories.clear();
+    }
+}
+
+void PresetScanner::WriteIndex()
+{
+    if (_indexFile.empty())
+    {
+        return;
+    }
+
+    // Write to a temporary file first, so a crash never leaves a truncated index behind.
+    std::string temporaryFile = _indexFile + ".tmp";
+
+    try
+    {
+        Poco::File(Poco::Path(_indexFile).parent()).createDirectories();
+
+        {
+            Poco::FileOutputStream stream(temporaryFile);
+            Poco::BinaryWriter writer(stream, Poco::BinaryWriter::LITTLE_ENDIAN_BYTE_ORDER);
+
+            writer << IndexMagic << IndexVersion;
+            writer.write7BitEncoded(static_cast<Poco::UInt32>(_scannedDirectories.size()));
+            for (const auto& directory : _scannedDirectories)
+            {
+                writer << directory.first << static_cast<Poco::Int64>(directory.second.lastModified.epochMicroseconds());
+
+                writer.write7BitEncoded(static_cast<Poco::UInt32>(directory.second.subdirectories.size()));
+                for (const auto& subdirectory : directory.second.subdirectories)
+                {
+                    writer << subdirectory;
+                }
+
+                writer.write7BitEncoded(static_cast<Poco::UInt32>(directory.second.presets.size()));
+                for (const auto& preset : directory.second.presets)
+                {
+                    writer << preset.name << static_cast<Poco::UInt64>(preset.size)
+                           << static_cast<Poco::Int64>(preset.lastModified.epochMicroseconds());
+                }
+            }
+
+            writer.flush();
+            if (!writer.good())
+            {
+                throw Poco::WriteFileException(temporaryFile);
+            }
+        }
+
+        Poco::File(temporaryFile).renameTo(_indexFile);
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_warning_f2(_logger, R"(Could not write preset index "%s": %s)", _indexFile, ex.displayText());
+    }
+}
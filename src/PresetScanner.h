@@ -0,0 +1,164 @@
+#pragma once
+
+#include <Poco/Logger.h>
+#include <Poco/Timestamp.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Finds all preset files in directory trees using multiple threads, with an optional persistent index.
+ *
+ * Replaces projectm_playlist_add_path(), which walks the directories single-threaded and stats every file on each
+ * start. Directories are listed in parallel by a pool of worker threads, which keeps multiple requests in flight and
+ * greatly speeds up scanning on network shares and spinning disks.
+ *
+ * If an index file is used, the contents of each directory are stored together with the directory's modification
+ * time. On the next start, only the directories themselves are checked: if a directory's modification time didn't
+ * change, no files were added, removed or renamed in it, and its cached contents are used without listing it again.
+ *
+ * The scan runs in the background. Presets are made available in batches as soon as their directory was scanned, so
+ * the caller can fill the playlist progressively and start displaying presets before the scan has finished.
+ *
+ * Like the playlist library, only files with the .milk or .prjm extensions are returned, and symbolic links to
+ * directories are only followed if given as a root path.
+ */
+class PresetScanner
+{
+public:
+    /**
+     * @brief Creates a scanner.
+     * @param indexFile The index file to read and update. If empty, no index is used.
+     */
+    explicit PresetScanner(std::string indexFile);
+
+    PresetScanner(const PresetScanner&) = delete;
+
+    PresetScanner& operator=(const PresetScanner&) = delete;
+
+    /**
+     * @brief Aborts a running scan. The index isn't updated in this case.
+     */
+    ~PresetScanner();
+
+    /**
+     * @brief Starts scanning all given directories recursively in the background.
+     *
+     * The index file is updated when the scan has finished.
+     *
+     * @param rootDirectories The directories to scan.
+     */
+    void Start(const std::vector<std::string>& rootDirectories);
+
+    /**
+     * @brief Returns all presets found since the last call.
+     * @param[out] presetFiles Receives the full paths of the newly found preset files, in no particular order.
+     * @return True if new presets were found.
+     */
+    bool TakeFoundPresets(std::vector<std::string>& presetFiles);
+
+    /**
+     * @brief Returns whether the scan has finished.
+     *
+     * If true, all presets found are available via TakeFoundPresets() and the index file has been written, so
+     * destroying the scanner only joins an already finished thread.
+     *
+     * @return True if all directories have been scanned.
+     */
+    bool Finished() const;
+
+    /**
+     * @brief Blocks until the scan has finished.
+     */
+    void Wait();
+
+    /**
+     * @brief Returns all directories which have been scanned.
+     * @return The directory paths, with a trailing separator. Only complete after the scan has finished.
+     */
+    std::vector<std::string> Directories();
+
+    /**
+     * @brief Checks if a file has one of the preset file extensions the playlist library accepts.
+     * @param fileName The file name.
+     * @return True if the file has the .milk or .prjm extension.
+     */
+    static bool IsPresetFile(const std::string& fileName);
+
+protected:
+    /**
+     * @brief A preset file in the index.
+     */
+    struct FileEntry
+    {
+        std::string name; //!< The file name, without the directory.
+        uint64_t size{0}; //!< The file size in bytes.
+        Poco::Timestamp lastModified{0}; //!< Modification time of the file.
+    };
+
+    /**
+     * @brief Cached contents of a single directory.
+     */
+    struct DirectoryEntry
+    {
+        Poco::Timestamp lastModified{0}; //!< Modification time of the directory when it was listed.
+        std::vector<std::string> subdirectories; //!< Names of all subdirectories, excluding symbolic links.
+        std::vector<FileEntry> presets; //!< All preset files in the directory.
+    };
+
+    using DirectoryMap = std::map<std::string, DirectoryEntry>;
+
+    /**
+     * @brief Scan thread function, runs the workers and updates the index.
+     */
+    void Scan();
+
+    /**
+     * @brief Worker thread function, processes directories until all have been scanned.
+     */
+    void Worker();
+
+    /**
+     * @brief Returns the contents of a directory, either from the index or by listing it.
+     * @param path The directory path, with a trailing separator.
+     * @param[out] entry Receives the directory contents.
+     * @return True if the directory could be read.
+     */
+    bool ScanDirectory(const std::string& path, DirectoryEntry& entry);
+
+    /**
+     * @brief Reads the index file.
+     *
+     * An unreadable, outdated or corrupt index is ignored, so everything is scanned again.
+     */
+    void ReadIndex();
+
+    /**
+     * @brief Writes all directories scanned in this run to the index file.
+     */
+    void WriteIndex();
+
+    std::string _indexFile; //!< The index file name, empty if no index is used.
+    std::thread _scanThread; //!< Runs Scan().
+    std::atomic<bool> _finished{false}; //!< True after the scan has finished.
+    std::atomic<bool> _stop{false}; //!< If true, the workers abort the scan.
+    DirectoryMap _indexedDirectories; //!< Directories read from the index file. Read-only while scanning.
+
+    std::mutex _mutex; //!< Protects all members below.
+    std::condition_variable _condition; //!< Signals new directories in the queue or the end of the scan.
+    std::deque<std::string> _pendingDirectories; //!< Directories waiting to be scanned.
+    size_t _activeWorkers{0}; //!< Number of workers currently scanning a directory.
+    DirectoryMap _scannedDirectories; //!< Contents of all directories scanned in this run.
+    size_t _listedDirectories{0}; //!< Number of directories which had to be listed because the index was outdated.
+    size_t _presetCount{0}; //!< Total number of presets found.
+    std::vector<std::string> _foundPresets; //!< Presets found, but not yet taken by TakeFoundPresets().
+
+    Poco::Logger& _logger{Poco::Logger::get("PresetScanner")}; //!< The class logger.
+};
@@ -0,0 +1,155 @@
+#include "PresetWarmUp.h"
+
+#include "OffscreenFramebuffer.h"
+#include "ProjectMWrapper.h"
+#include "SDLRenderingWindow.h"
+
+#include "gui/ProjectMGUI.h"
+
+#include "notifications/DisplayToastNotification.h"
+
+#include <Poco/Clock.h>
+#include <Poco/Format.h>
+#include <Poco/NotificationCenter.h>
+#include <Poco/Path.h>
+#include <Poco/String.h>
+
+#include <Poco/Util/Application.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+#include <algorithm>
+#include <fstream>
+
+PresetWarmUp::PresetWarmUp()
+    : _projectMWrapper(Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>())
+    , _sdlRenderingWindow(Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>())
+    , _projectMGui(Poco::Util::Application::instance().getSubsystem<ProjectMGUI>())
+    , _projectMHandle(_projectMWrapper.ProjectM())
+    , _playlistHandle(_projectMWrapper.Playlist())
+{
+}
+
+void PresetWarmUp::Run()
+{
+    auto presets = PresetsToWarmUp();
+    if (presets.empty())
+    {
+        return;
+    }
+
+    poco_information_f1(_logger, "Warming up %?u presets.", presets.size());
+
+    // The playlist reports presets which fail to load, also if loaded directly via projectM. Without retries, it
+    // doesn't load another preset instead, which would change the current preset and the predicted upcoming ones.
+    auto retryCount = projectm_playlist_get_retry_count(_playlistHandle);
+    projectm_playlist_set_retry_count(_playlistHandle, 0);
+    projectm_playlist_set_preset_switch_failed_event_callback(_playlistHandle, &PresetWarmUp::PresetSwitchFailedEvent, this);
+
+    Poco::Clock startTime;
+    for (size_t index = 0; index < presets.size(); index++)
+    {
+        ShowProgress(index, presets.size());
+
+        projectm_load_preset_file(_projectMHandle, presets[index].c_str(), false);
+        _projectMWrapper.RenderFrame(_sdlRenderingWindow.Framebuffer());
+
+        // Keep the window responsive, events are handled afterwards by the render loop.
+        SDL_PumpEvents();
+    }
+
+    // Make sure the driver has actually finished compiling all shaders.
+    glFinish();
+
+    projectm_playlist_set_preset_switch_failed_event_callback(_playlistHandle, nullptr, nullptr);
+    projectm_playlist_set_retry_count(_playlistHandle, retryCount);
+
+    // Otherwise, the initial preset is displayed next.
+    if (Poco::Util::Application::instance().config().getBool("projectM.enableSplash", true))
+    {
+        projectm_load_preset_file(_projectMHandle, "idle://", false);
+    }
+
+    poco_information_f3(_logger, "Warmed up %?u presets in %.2f seconds, %?u failed to load.",
+                        presets.size() - std::min(_failedPresets, presets.size()), static_cast<double>(startTime.elapsed()) / 1000000.0,
+                        _failedPresets);
+
+    Poco::NotificationCenter::defaultCenter().postNotification(new DisplayToastNotification("Presets warmed up"));
+}
+
+std::vector<std::string> PresetWarmUp::PresetsToWarmUp()
+{
+    auto& config = Poco::Util::Application::instance().config();
+
+    auto setlistFile = config.getString("projectM.warmUpSetlist", "");
+    if (!setlistFile.empty())
+    {
+        return ReadSetlist(setlistFile);
+    }
+
+    auto presetCount = config.getInt("projectM.warmUpPresets", 0);
+    if (presetCount <= 0)
+    {
+        return {};
+    }
+
+    // The upcoming presets can only be predicted with the complete playlist.
+    _projectMWrapper.FinishPresetScan();
+
+    return _projectMWrapper.UpcomingPresets(static_cast<size_t>(presetCount));
+}
+
+std::vector<std::string> PresetWarmUp::ReadSetlist(const std::string& fileName)
+{
+    std::vector<std::string> presets;
+
+    std::ifstream setlistStream(fileName);
+    if (!setlistStream.is_open())
+    {
+        poco_error_f1(_logger, R"(Could not open preset setlist "%s", skipping warm-up.)", fileName);
+        return presets;
+    }
+
+    Poco::Path setlistDirectory = Poco::Path(fileName).makeAbsolute().parent();
+
+    std::string line;
+    while (std::getline(setlistStream, line))
+    {
+        Poco::trimInPlace(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        presets.push_back(Poco::Path(setlistDirectory).resolve(line).toString());
+    }
+
+    return presets;
+}
+
+void PresetWarmUp::ShowProgress(size_t current, size_t total)
+{
+    Poco::NotificationCenter::defaultCenter().postNotification(
+        new DisplayToastNotification(Poco::format("Warming up presets: %?u/%?u", current + 1, total)));
+
+    // Draw only the toast on black, the preset frames are discarded.
+    if (OffscreenFramebuffer::Available())
+    {
+        OffscreenFramebuffer::Bind(_sdlRenderingWindow.Framebuffer());
+    }
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    _projectMGui.Draw(_sdlRenderingWindow.QueryWindowState());
+    _sdlRenderingWindow.Swap();
+}
+
+void PresetWarmUp::PresetSwitchFailedEvent(const char* presetFilename, const char* message, void* context)
+{
+    auto that = reinterpret_cast<PresetWarmUp*>(context);
+    that->_failedPresets++;
+
+    poco_warning_f2(that->_logger, R"(Failed to warm up preset "%s": %s)",
+                    std::string(presetFilename != nullptr ? presetFilename : ""),
+                    std::string(message != nullptr ? message : "Unknown error"));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <projectM-4/projectM.h>
+#include <projectM-4/playlist.h>
+
+#include <Poco/Logger.h>
+
+#include <string>
+#include <vector>
+
+class ProjectMGUI;
+class ProjectMWrapper;
+class SDLRenderingWindow;
+
+/**
+ * @brief Loads and renders the first presets once before the visualization starts.
+ *
+ * The first time a preset is displayed, projectM compiles its shaders, and many drivers finish compilation only on the
+ * first draw call. This causes a visible hitch at the transition. The warm-up loads each of the presets which will be
+ * displayed next, or the presets listed in a setlist file, renders a single frame of each into the back buffer and
+ * discards it. The driver's shader cache is then hot before the first real transition.
+ *
+ * Only a black screen with a progress toast is shown while warming up. Afterwards, projectM shows the idle preset again
+ * if the splash screen is enabled. Otherwise, the initial preset is loaded as usual.
+ */
+class PresetWarmUp
+{
+public:
+    PresetWarmUp();
+
+    /**
+     * @brief Warms up all configured presets. Does nothing if warm-up is disabled.
+     */
+    void Run();
+
+protected:
+    /**
+     * @brief Returns the presets to warm up.
+     * @return The setlist entries if a setlist is configured, otherwise the upcoming playlist presets.
+     */
+    std::vector<std::string> PresetsToWarmUp();
+
+    /**
+     * @brief Reads a setlist file.
+     *
+     * The file contains one preset path per line. Empty lines and lines starting with "#" are ignored. Relative
+     * paths are relative to the setlist file.
+     *
+     * @param fileName The setlist file name.
+     * @return The preset file names.
+     */
+    std::vector<std::string> ReadSetlist(const std::string& fileName);
+
+    /**
+     * @brief Displays the warm-up progress in a toast.
+     * @param current The number of presets warmed up so far.
+     * @param total The total number of presets to warm up.
+     */
+    void ShowProgress(size_t current, size_t total);
+
+    /**
+     * @brief projectM playlist callback. Called if a preset couldn't be loaded.
+     * @param presetFilename The file name of the failed preset.
+     * @param message The error message.
+     * @param context Callback context, e.g. "this" pointer.
+     */
+    static void PresetSwitchFailedEvent(const char* presetFilename, const char* message, void* context);
+
+    ProjectMWrapper& _projectMWrapper;
+    SDLRenderingWindow& _sdlRenderingWindow;
+    ProjectMGUI& _projectMGui;
+
+    projectm_handle _projectMHandle{nullptr};
+    projectm_playlist_handle _playlistHandle{nullptr};
+
+    size_t _failedPresets{0}; //!< Number of presets which couldn't be loaded.
+
+    Poco::Logger& _logger{Poco::Logger::get("PresetWarmUp")}; //!< The class logger.
+};
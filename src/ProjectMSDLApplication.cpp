@@ -4,7 +4,10 @@
 
 #include "ProjectMSDLApplication.h"
 
+#include "AudioBackendRegistry.h"
 #include "AudioCapture.h"
+#include "Benchmark.h"
+#include "OfflineRenderer.h"
 #include "ProjectMWrapper.h"
 #include "RenderLoop.h"
 #include "SDLRenderingWindow.h"
@@ -128,12 +131,87 @@ void ProjectMSDLApplication::defineOptions(Poco::Util::OptionSet& options)
                           .callback(
                               OptionCallback<ProjectMSDLApplication>(this, &ProjectMSDLApplication::ListAudioDevices)));
 
+    std::string audioBackends;
+    for (const auto& backend : AudioBackendRegistry::Backends())
+    {
+        audioBackends += (audioBackends.empty() ? "" : ", ") + backend.name;
+    }
+
+    options.addOption(Option("audioBackend", "",
+                             "Select the audio capture backend. Available backends: " + audioBackends +
+                                 ". Default is " + AudioBackendRegistry::DefaultBackend() + ".",
+                             false, "<name>", true)
+                          .binding("audio.backend", _commandLineOverrides));
+
     options.addOption(Option("audioDevice", "d",
                              "Select an audio device to record from initially. Can be the numerical ID or the full device name. "
                              "If the device is not found, the default device will be used instead.",
                              false, "<id or name>", true)
                           .binding("audio.device", _commandLineOverrides));
 
+    options.addOption(Option("audioFile", "",
+                             "Play back a WAV, FLAC or raw 32-bit float PCM file instead of recording from an audio device.",
+                             false, "<path>", true)
+                          .binding("audio.file", _commandLineOverrides));
+
+    options.addOption(Option("audioFileRealtime", "",
+                             "If true, plays the audio file in real time. If false, passes exactly 1/fps seconds of audio per frame, regardless of actual rendering speed.",
+                             false, "<0/1>", true)
+                          .binding("audio.file.realtime", _commandLineOverrides));
+
+    options.addOption(Option("frameStatistics", "",
+                             "Write frame time statistics as JSON to the given file on exit. On POSIX systems, also written when receiving SIGUSR1.",
+                             false, "<path>", true)
+                          .binding("statistics.file", _commandLineOverrides));
+
+#ifdef FRAME_OUTPUT_SHARED_MEMORY
+    options.addOption(Option("sharedMemoryOutput", "",
+                             "Publish rendered frames in a POSIX shared memory ring buffer with the given name, e.g. /projectm-frames, "
+                             "so local applications can read them without grabbing the window.",
+                             false, "<name>", true)
+                          .binding("output.sharedMemory.name", _commandLineOverrides));
+
+#endif
+    options.addOption(Option("benchmark", "",
+                             "Run a benchmark instead of the visualizer. Renders each preset for a fixed time with unlimited FPS and "
+                             "synthetic audio, then writes load and frame times of each preset to the given file. "
+                             "The report is written as JSON if the file name ends with .json, otherwise as CSV.",
+                             false, "<path>", true)
+                          .callback(
+                              OptionCallback<ProjectMSDLApplication>(this, &ProjectMSDLApplication::EnableBenchmark)));
+
+    options.addOption(Option("benchmarkDuration", "", "Time in seconds each preset is rendered in benchmark mode. Default 5.",
+                             false, "<seconds>", true)
+                          .binding("benchmark.presetDuration", _commandLineOverrides));
+
+    options.addOption(Option("benchmarkFirstPreset", "", "Playlist index of the first preset to benchmark. Default 0.",
+                             false, "<number>", true)
+                          .binding("benchmark.firstPreset", _commandLineOverrides));
+
+    options.addOption(Option("benchmarkPresetCount", "", "Number of presets to benchmark. Default 0, which benchmarks all remaining presets.",
+                             false, "<number>", true)
+                          .binding("benchmark.presetCount", _commandLineOverrides));
+
+    options.addOption(Option("renderOutput", "",
+                             "Render a video of the audio file set with --audioFile instead of running the visualizer. Each frame advances "
+                             "by exactly 1/fps seconds and is rendered as fast as possible. Writes a Y4M stream, or raw RGBA pixels if the "
+                             "file name ends with .rgba or .raw. Use - to write to standard output, e.g. to pipe into ffmpeg.",
+                             false, "<path>", true)
+                          .callback(
+                              OptionCallback<ProjectMSDLApplication>(this, &ProjectMSDLApplication::EnableOfflineRendering)));
+
+    options.addOption(Option("renderFormat", "", "Video output format, either y4m or rgba. Default is selected by the file extension.",
+                             false, "<format>", true)
+                          .binding("render.format", _commandLineOverrides));
+
+    options.addOption(Option("renderSeed", "", "Seed for preset shuffling and other random decisions when rendering a video. Default 0.",
+                             false, "<number>", true)
+                          .binding("render.seed", _commandLineOverrides));
+
+    options.addOption(Option("renderDuration", "", "Maximum video length in seconds. Default 0, which renders until the audio file ends.",
+                             false, "<seconds>", true)
+                          .binding("render.duration", _commandLineOverrides));
+
     options.addOption(Option("presetPath", "p", "Base directory to search for presets.",
                              false, "<path>", true)
                           .binding("projectM.presetPath", _commandLineOverrides));
@@ -146,6 +224,17 @@ void ProjectMSDLApplication::defineOptions(Poco::Util::OptionSet& options)
                              false, "<0/1>", true)
                           .binding("projectM.enableSplash", _commandLineOverrides));
 
+    options.addOption(Option("headless", "",
+                             "Render without a window or display server into an offscreen framebuffer of the given width and height. "
+                             "Requires EGL, e.g. Mesa's surfaceless platform, which also renders in software if no GPU is available.",
+                             false, "<0/1>", true)
+                          .binding("window.headless", _commandLineOverrides));
+
+    options.addOption(Option("renderThread", "",
+                             "If true, renders on a dedicated thread, so window management and event processing can't delay frames.",
+                             false, "<0/1>", true)
+                          .binding("window.renderThread", _commandLineOverrides));
+
     options.addOption(Option("fullscreen", "f", "Start in fullscreen mode.",
                              false, "<0/1>", true)
                           .binding("window.fullscreen", _commandLineOverrides));
@@ -229,6 +318,22 @@ void ProjectMSDLApplication::defineOptions(Poco::Util::OptionSet& options)
 
 int ProjectMSDLApplication::main(POCO_UNUSED const std::vector<std::string>& args)
 {
+    if (config().has("benchmark.report"))
+    {
+        Benchmark benchmark;
+        benchmark.Run();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (config().has("render.output"))
+    {
+        OfflineRenderer offlineRenderer;
+        offlineRenderer.Run();
+
+        return EXIT_SUCCESS;
+    }
+
     RenderLoop renderLoop;
     renderLoop.Run();
 
@@ -274,3 +379,26 @@ void ProjectMSDLApplication::ListAudioDevices(POCO_UNUSED const std::string& nam
     _commandLineOverrides->setBool("audio.listDevices", true);
 }
 
+void ProjectMSDLApplication::EnableBenchmark(POCO_UNUSED const std::string& name, const std::string& value)
+{
+    _commandLineOverrides->setString("benchmark.report", value);
+
+    // Deterministic audio, no frame limiting and no automatic preset switches.
+    _commandLineOverrides->setString("audio.backend", "synthetic");
+    _commandLineOverrides->setInt("projectM.fps", 0);
+    _commandLineOverrides->setBool("window.waitForVerticalSync", false);
+    _commandLineOverrides->setBool("projectM.shuffleEnabled", false);
+    _commandLineOverrides->setBool("projectM.presetLocked", true);
+    _commandLineOverrides->setBool("projectM.hardCutsEnabled", false);
+    _commandLineOverrides->setDouble("projectM.transitionDuration", 0.0);
+}
+
+void ProjectMSDLApplication::EnableOfflineRendering(POCO_UNUSED const std::string& name, const std::string& value)
+{
+    _commandLineOverrides->setString("render.output", value);
+
+    // Pace audio by frames instead of the wall clock, render the file once and never wait for the display.
+    _commandLineOverrides->setBool("audio.file.realtime", false);
+    _commandLineOverrides->setBool("audio.file.loop", false);
+    _commandLineOverrides->setBool("window.waitForVerticalSync", false);
+}
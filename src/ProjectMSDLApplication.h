@@ -47,6 +47,20 @@ protected:
 
     void ListAudioDevices(const std::string& name, const std::string& value);
 
+    /**
+     * @brief Enables benchmark mode and overrides all settings which would affect the results.
+     * @param name Unused.
+     * @param value The benchmark report file name.
+     */
+    void EnableBenchmark(const std::string& name, const std::string& value);
+
+    /**
+     * @brief Enables offline video rendering and overrides the settings required for a fixed timestep.
+     * @param name Unused.
+     * @param value The video output file name, or "-" for standard output.
+     */
+    void EnableOfflineRendering(const std::string& name, const std::string& value);
+
     Poco::AutoPtr<Poco::Util::PropertyFileConfiguration> _userConfiguration{
         new Poco::Util::PropertyFileConfiguration()}; //!< The current user's configuration, used to store/reset changes made in the UI's settings dialog.
     Poco::AutoPtr<Poco::Util::MapConfiguration> _commandLineOverrides{
@@ -1,17 +1,42 @@
 #include "ProjectMWrapper.h"
 
+#include "PresetScanner.h"
 #include "ProjectMSDLApplication.h"
 #include "SDLRenderingWindow.h"
 
 #include "notifications/DisplayToastNotification.h"
 
 #include <Poco/Delegate.h>
+#include <Poco/Exception.h>
 #include <Poco/File.h>
 #include <Poco/NotificationCenter.h>
+#include <Poco/Path.h>
+#include <Poco/String.h>
 
 #include <SDL2/SDL_opengl.h>
 
+#include <algorithm>
 #include <cmath>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * @brief Checks if a preset can be loaded from memory.
+ *
+ * projectm_load_preset_data() only parses Milkdrop presets, others are always loaded from disk.
+ *
+ * @param fileName The preset file name.
+ * @return True if the file has the .milk extension.
+ */
+bool CanLoadFromMemory(const std::string& fileName)
+{
+    return Poco::icompare(Poco::Path(fileName).getExtension(), "milk") == 0;
+}
+
+} // namespace
+
+constexpr uint32_t ProjectMWrapper::NoPresetIndex;
 
 const char* ProjectMWrapper::name() const
 {
@@ -23,6 +48,7 @@ void ProjectMWrapper::initialize(Poco::Util::Application& app)
     auto& projectMSDLApp = dynamic_cast<ProjectMSDLApplication&>(app);
     _projectMConfigView = projectMSDLApp.config().createView("projectM");
     _userConfig = projectMSDLApp.UserConfiguration();
+    UpdateSettings();
     poco_information_f1(_logger, "Events enabled: %?d", _projectMConfigView->eventsEnabled());
 
     if (!_projectM)
@@ -53,7 +79,8 @@ void ProjectMWrapper::initialize(Poco::Util::Application& app)
 
         projectm_set_window_size(_projectM, canvasWidth, canvasHeight);
         projectm_set_fps(_projectM, fps);
-        projectm_set_mesh_size(_projectM, _projectMConfigView->getInt("meshX", 48), _projectMConfigView->getInt("meshY", 32));
+        auto settings = Settings();
+        projectm_set_mesh_size(_projectM, settings->meshX, settings->meshY);
         projectm_set_aspect_correction(_projectM, _projectMConfigView->getBool("aspectCorrectionEnabled", true));
         projectm_set_preset_locked(_projectM, _projectMConfigView->getBool("presetLocked", false));
 
@@ -86,25 +113,54 @@ void ProjectMWrapper::initialize(Poco::Util::Application& app)
             throw std::runtime_error("Playlist initialization failed");
         }
 
-        projectm_playlist_set_shuffle(_playlist, _projectMConfigView->getBool("shuffleEnabled", true));
+        // The application selects the next presets itself to prefetch them, see PlayNext().
+        projectm_playlist_set_shuffle(_playlist, false);
 
+        std::vector<std::string> presetFiles;
+        std::vector<std::string> presetDirectories;
         for (const auto& presetPath : presetPaths)
         {
             Poco::File file(presetPath);
             if (file.exists() && file.isFile())
             {
-                projectm_playlist_add_preset(_playlist, presetPath.c_str(), false);
+                presetFiles.push_back(presetPath);
             }
             else
             {
                 // Symbolic links also fall under this. Without complex resolving, we can't
                 // be sure what the link exactly points to, especially if a trailing slash is missing.
-                projectm_playlist_add_path(_playlist, presetPath.c_str(), true, false);
+                presetDirectories.push_back(presetPath);
             }
         }
-        projectm_playlist_sort(_playlist, 0, projectm_playlist_size(_playlist), SORT_PREDICATE_FILENAME_ONLY, SORT_ORDER_ASCENDING);
+
+        AddPresets(presetFiles);
+
+        // Directories are scanned in the background, the playlist is filled while rendering, see PollPresetScan().
+        if (presetDirectories.empty())
+        {
+            SortPlaylist();
+        }
+        else
+        {
+            _presetScanner.reset(new PresetScanner(PresetIndexFile()));
+            _presetScanner->Start(presetDirectories);
+        }
 
         projectm_playlist_set_preset_switched_event_callback(_playlist, &ProjectMWrapper::PresetSwitchedEvent, static_cast<void*>(this));
+        projectm_set_preset_switch_requested_event_callback(_projectM, &ProjectMWrapper::PresetSwitchRequestedEvent, static_cast<void*>(this));
+
+        _prefetchCount = static_cast<size_t>(std::max(_projectMConfigView->getInt("prefetchCount", 3), 0));
+        _presetCacheEnabled = _projectMConfigView->getBool("presetCacheEnabled", true);
+        if (UsePrefetcher())
+        {
+            size_t cacheSize{0};
+            if (_presetCacheEnabled)
+            {
+                cacheSize = static_cast<size_t>(std::max(_projectMConfigView->getInt("presetCacheSize", 16), 0));
+            }
+            _prefetcher.Start(cacheSize * 1024 * 1024);
+            UpdatePrefetch();
+        }
     }
 
     Poco::NotificationCenter::defaultCenter().addObserver(_playbackControlNotificationObserver);
@@ -120,6 +176,19 @@ void ProjectMWrapper::uninitialize()
     _userConfig->propertyChanged -= Poco::delegate(this, &ProjectMWrapper::OnConfigurationPropertyChanged);
     Poco::NotificationCenter::defaultCenter().removeObserver(_playbackControlNotificationObserver);
 
+    if (UsePrefetcher())
+    {
+        auto statistics = _prefetcher.CacheStatistics();
+        poco_information_f3(_logger, "Preset cache: %?u hits, %?u misses, %?u evictions.",
+                            statistics.hits, statistics.misses, statistics.evictions);
+    }
+
+    _prefetcher.Stop();
+    _presetScanner.reset();
+#ifdef PRESET_DIRECTORY_WATCHER
+    _presetWatcher.reset();
+#endif
+
     if (_projectM)
     {
         projectm_destroy(_projectM);
@@ -145,7 +214,22 @@ projectm_playlist_handle ProjectMWrapper::Playlist() const
 
 int ProjectMWrapper::TargetFPS()
 {
-    return _projectMConfigView->getInt("fps", 60);
+    return Settings()->targetFps;
+}
+
+std::shared_ptr<const SettingsSnapshot> ProjectMWrapper::Settings() const
+{
+    return std::atomic_load(&_settings);
+}
+
+void ProjectMWrapper::MeshQuality(float quality)
+{
+    _meshQuality = std::min(std::max(quality, 0.0f), 1.0f);
+}
+
+uint32_t ProjectMWrapper::PresetSwitchCount() const
+{
+    return _presetSwitchCount;
 }
 
 void ProjectMWrapper::UpdateRealFPS(float fps)
@@ -153,38 +237,247 @@ void ProjectMWrapper::UpdateRealFPS(float fps)
     projectm_set_fps(_projectM, static_cast<uint32_t>(std::round(fps)));
 }
 
-void ProjectMWrapper::RenderFrame() const
+void ProjectMWrapper::RenderFrame(uint32_t framebufferObject) const
 {
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    auto settings = Settings();
+
+    // Scale by the governed quality, but never below the smallest mesh size selectable in the settings.
+    auto scaleMeshSize = [this](size_t size) {
+        auto scaledSize = static_cast<size_t>(std::lround(static_cast<float>(size) * _meshQuality));
+        return std::max(scaledSize, std::min<size_t>(size, 8));
+    };
+    auto meshX = scaleMeshSize(settings->meshX);
+    auto meshY = scaleMeshSize(settings->meshY);
+
     size_t currentMeshX{0};
     size_t currentMeshY{0};
     projectm_get_mesh_size(_projectM, &currentMeshX, &currentMeshY);
-    if (currentMeshX != _projectMConfigView->getInt("meshX", 220) ||
-        currentMeshY != _projectMConfigView->getInt("meshY", 125))
+    if (currentMeshX != meshX || currentMeshY != meshY)
     {
-        projectm_set_mesh_size(_projectM, _projectMConfigView->getInt("meshX", 220), _projectMConfigView->getInt("meshY", 125));
+        projectm_set_mesh_size(_projectM, meshX, meshY);
     }
 
+#if PROJECTM_VERSION_MAJOR > 4 || (PROJECTM_VERSION_MAJOR == 4 && PROJECTM_VERSION_MINOR >= 1)
+    projectm_opengl_render_frame_fbo(_projectM, framebufferObject);
+#else
+    poco_assert_dbg(framebufferObject == 0);
     projectm_opengl_render_frame(_projectM);
+#endif
+}
+
+bool ProjectMWrapper::CanRenderToFramebuffer()
+{
+#if PROJECTM_VERSION_MAJOR > 4 || (PROJECTM_VERSION_MAJOR == 4 && PROJECTM_VERSION_MINOR >= 1)
+    return true;
+#else
+    return false;
+#endif
 }
 
 void ProjectMWrapper::DisplayInitialPreset()
 {
     if (!_projectMConfigView->getBool("enableSplash", true))
     {
-        if (_projectMConfigView->getBool("shuffleEnabled", true))
+        // If no preset was found yet, the first one is displayed as soon as the scan has found it.
+        if (projectm_playlist_size(_playlist) == 0 && _presetScanner)
+        {
+            _initialPresetPending = true;
+        }
+        else if (_projectMConfigView->getBool("shuffleEnabled", true))
         {
-            projectm_playlist_play_next(_playlist, true);
+            PlayRandom(true);
         }
         else
         {
-            projectm_playlist_set_position(_playlist, 0, true);
+            PlayPreset(0, true);
         }
     }
 }
 
+void ProjectMWrapper::PollPresetScan()
+{
+    if (_presetScanner)
+    {
+        // Check before taking the presets, so no batch found in between is missed.
+        bool finished = _presetScanner->Finished();
+
+        std::vector<std::string> presetFiles;
+        if (_presetScanner->TakeFoundPresets(presetFiles))
+        {
+            AddPresets(presetFiles);
+
+            if (_initialPresetPending)
+            {
+                _initialPresetPending = false;
+                DisplayInitialPreset();
+            }
+
+            UpdatePrefetch();
+        }
+
+        if (finished)
+        {
+#ifdef PRESET_DIRECTORY_WATCHER
+            StartPresetWatcher(_presetScanner->Directories());
+#endif
+            _presetScanner.reset();
+            SortPlaylist();
+        }
+    }
+
+#ifdef PRESET_DIRECTORY_WATCHER
+    PresetDirectoryWatcher::Changes changes;
+    while (_presetWatcher && _presetWatcher->TakeChanges(changes))
+    {
+        ApplyPresetChanges(changes);
+    }
+#endif
+}
+
+void ProjectMWrapper::FinishPresetScan()
+{
+    if (_presetScanner)
+    {
+        _presetScanner->Wait();
+        PollPresetScan();
+    }
+}
+
+void ProjectMWrapper::PlayNext(bool hardCut)
+{
+    auto playlistSize = projectm_playlist_size(_playlist);
+    if (playlistSize == 0)
+    {
+        return;
+    }
+
+    if (Settings()->shuffleEnabled)
+    {
+        PlayRandom(hardCut);
+    }
+    else
+    {
+        // If the displayed preset was removed, _currentIndex already points to the next one.
+        auto offset = _currentPresetRemoved ? 0 : 1;
+        PlayPreset((_currentIndex + offset) % playlistSize, hardCut);
+    }
+}
+
+void ProjectMWrapper::PlayPrevious(bool hardCut)
+{
+    auto playlistSize = projectm_playlist_size(_playlist);
+    if (playlistSize == 0)
+    {
+        return;
+    }
+
+    if (Settings()->shuffleEnabled)
+    {
+        PlayLast(hardCut);
+    }
+    else
+    {
+        PlayPreset((_currentIndex + playlistSize - 1) % playlistSize, hardCut);
+    }
+}
+
+void ProjectMWrapper::PlayLast(bool hardCut)
+{
+    if (_history.empty())
+    {
+        return;
+    }
+
+    auto index = _history.back();
+    _history.pop_back();
+    if (index >= projectm_playlist_size(_playlist))
+    {
+        return;
+    }
+
+    PlayPreset(index, hardCut);
+
+    // Going back must not add the preset we came from, or PlayLast() would toggle between two presets.
+    _history.pop_back();
+}
+
+void ProjectMWrapper::PlayRandom(bool hardCut)
+{
+    if (projectm_playlist_size(_playlist) == 0)
+    {
+        return;
+    }
+
+    PlayPreset(NextRandomIndex(), hardCut);
+}
+
+void ProjectMWrapper::PlayPreset(uint32_t index, bool hardCut)
+{
+    if (index >= projectm_playlist_size(_playlist))
+    {
+        return;
+    }
+
+    // Keep a limited history, the same as the playlist library does. Before the first preset was displayed or
+    // after it was removed, _currentIndex doesn't refer to a displayed preset.
+    static constexpr size_t maxHistorySize{1000};
+    if (CurrentPresetInPlaylist())
+    {
+        _history.push_back(_currentIndex);
+        if (_history.size() > maxHistorySize)
+        {
+            _history.erase(_history.begin());
+        }
+    }
+
+    auto fileName = PlaylistItem(index);
+    std::string presetData;
+    if (UsePrefetcher() && CanLoadFromMemory(fileName) && _prefetcher.Get(fileName, presetData) &&
+        LoadPresetData(presetData, hardCut))
+    {
+        // Navigation uses _currentIndex, not the playlist position. projectm_playlist_set_position() would load the
+        // preset from disk again, so it's only used if the preset isn't prefetched or failed to load.
+        PresetDisplayed(index);
+    }
+    else
+    {
+        // Calls PresetSwitchedEvent() on success. If the preset is broken, the playlist skips to another one.
+        projectm_playlist_set_position(_playlist, index, hardCut);
+    }
+
+    UpdatePrefetch();
+}
+
+uint32_t ProjectMWrapper::CurrentPresetIndex() const
+{
+    return _currentPresetRemoved ? NoPresetIndex : _currentIndex;
+}
+
+std::string ProjectMWrapper::CurrentPresetFile() const
+{
+    return CurrentPresetInPlaylist() ? PlaylistItem(_currentIndex) : std::string();
+}
+
+uint32_t ProjectMWrapper::PlaylistVersion() const
+{
+    return _playlistVersion;
+}
+
+PresetCache::Statistics ProjectMWrapper::PresetCacheStatistics()
+{
+    return _prefetcher.CacheStatistics();
+}
+
+void ProjectMWrapper::SeedShuffle(uint32_t seed)
+{
+    _randomGenerator.seed(seed);
+    _randomIndices.clear();
+    UpdatePrefetch();
+}
+
 void ProjectMWrapper::ChangeBeatSensitivity(float value)
 {
     projectm_set_beat_sensitivity(_projectM, projectm_get_beat_sensitivity(_projectM) + value);
@@ -209,39 +502,209 @@ std::string ProjectMWrapper::ProjectMRuntimeVersion()
 void ProjectMWrapper::PresetSwitchedEvent(bool isHardCut, unsigned int index, void* context)
 {
     auto that = reinterpret_cast<ProjectMWrapper*>(context);
-    auto presetName = projectm_playlist_item(that->_playlist, index);
-    poco_information_f1(that->_logger, "Displaying preset: %s", std::string(presetName));
-    projectm_playlist_free_string(presetName);
+    that->PresetDisplayed(index);
+}
+
+void ProjectMWrapper::PresetSwitchRequestedEvent(bool isHardCut, void* context)
+{
+    auto that = reinterpret_cast<ProjectMWrapper*>(context);
+    that->PlayNext(isHardCut);
+}
+
+void ProjectMWrapper::PresetLoadFailedEvent(const char* presetFilename, const char* message, void* context)
+{
+    auto that = reinterpret_cast<ProjectMWrapper*>(context);
+    that->_presetLoadFailed = true;
+
+    poco_debug_f1(that->_logger, "Failed to load prefetched preset: %s", std::string(message != nullptr ? message : "Unknown error"));
+}
+
+bool ProjectMWrapper::LoadPresetData(const std::string& presetData, bool hardCut)
+{
+    _presetLoadFailed = false;
+    projectm_set_preset_switch_failed_event_callback(_projectM, &ProjectMWrapper::PresetLoadFailedEvent, static_cast<void*>(this));
+
+    projectm_load_preset_data(_projectM, presetData.c_str(), !hardCut);
+
+    // Connecting restores the playlist's failure and switch request handlers, the latter is replaced again.
+    projectm_playlist_connect(_playlist, _projectM);
+    projectm_set_preset_switch_requested_event_callback(_projectM, &ProjectMWrapper::PresetSwitchRequestedEvent, static_cast<void*>(this));
+
+    return !_presetLoadFailed;
+}
+
+void ProjectMWrapper::PresetDisplayed(uint32_t index)
+{
+    _currentIndex = index;
+    _currentPresetRemoved = false;
+    _presetSwitchCount++;
+
+    poco_information_f1(_logger, "Displaying preset: %s", PlaylistItem(index));
 
     Poco::NotificationCenter::defaultCenter().postNotification(new UpdateWindowTitleNotification);
 }
 
+uint32_t ProjectMWrapper::NextRandomIndex()
+{
+    auto playlistSize = projectm_playlist_size(_playlist);
+
+    // Drop indices which became invalid if the playlist has shrunk.
+    while (!_randomIndices.empty() && _randomIndices.front() >= playlistSize)
+    {
+        _randomIndices.pop_front();
+    }
+
+    if (_randomIndices.empty())
+    {
+        std::uniform_int_distribution<uint32_t> distribution(0, playlistSize - 1);
+        return distribution(_randomGenerator);
+    }
+
+    auto index = _randomIndices.front();
+    _randomIndices.pop_front();
+    return index;
+}
+
+std::vector<std::string> ProjectMWrapper::UpcomingPresets(size_t count)
+{
+    std::vector<std::string> fileNames;
+    for (auto index : UpcomingIndices(count))
+    {
+        fileNames.push_back(PlaylistItem(index));
+    }
+
+    return fileNames;
+}
+
+std::vector<uint32_t> ProjectMWrapper::UpcomingIndices(size_t count)
+{
+    std::vector<uint32_t> upcomingIndices;
+
+    auto playlistSize = projectm_playlist_size(_playlist);
+    if (playlistSize == 0)
+    {
+        return upcomingIndices;
+    }
+
+    if (Settings()->shuffleEnabled)
+    {
+        // Draw the random presets in advance, so we know which ones will be displayed.
+        std::uniform_int_distribution<uint32_t> distribution(0, playlistSize - 1);
+        while (_randomIndices.size() < count)
+        {
+            auto index = distribution(_randomGenerator);
+            auto previousIndex = _randomIndices.empty() ? _currentIndex : _randomIndices.back();
+            if (index == previousIndex && playlistSize > 1)
+            {
+                continue;
+            }
+            _randomIndices.push_back(index);
+        }
+        upcomingIndices.assign(_randomIndices.begin(), _randomIndices.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    else
+    {
+        // Before the initial preset is displayed, the first playlist item is up next. The same applies to
+        // _currentIndex after the displayed preset was removed.
+        size_t firstOffset = CurrentPresetInPlaylist() ? 1 : 0;
+        for (size_t offset = firstOffset; offset < firstOffset + std::min<size_t>(count, playlistSize); offset++)
+        {
+            upcomingIndices.push_back(static_cast<uint32_t>((_currentIndex + offset) % playlistSize));
+        }
+    }
+
+    return upcomingIndices;
+}
+
+void ProjectMWrapper::UpdatePrefetch()
+{
+    auto playlistSize = projectm_playlist_size(_playlist);
+    if (!UsePrefetcher() || playlistSize == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> upcomingIndices;
+    if (_prefetchCount > 0)
+    {
+        upcomingIndices = UpcomingIndices(_prefetchCount);
+        if (!Settings()->shuffleEnabled)
+        {
+            upcomingIndices.push_back((_currentIndex + playlistSize - 1) % playlistSize);
+        }
+    }
+
+    // Keep the displayed preset, so it stays cached after switching away from it.
+    if (_presetCacheEnabled && CurrentPresetInPlaylist())
+    {
+        upcomingIndices.push_back(_currentIndex);
+    }
+
+    // Also keep the preset for going back, e.g. when switching between favorites.
+    if (!_history.empty())
+    {
+        upcomingIndices.push_back(_history.back());
+    }
+
+    std::vector<std::string> fileNames;
+    for (auto index : upcomingIndices)
+    {
+        auto fileName = PlaylistItem(index);
+        if (CanLoadFromMemory(fileName) && std::find(fileNames.begin(), fileNames.end(), fileName) == fileNames.end())
+        {
+            fileNames.push_back(std::move(fileName));
+        }
+    }
+
+    _prefetcher.Prefetch(fileNames);
+}
+
+bool ProjectMWrapper::UsePrefetcher() const
+{
+    return _prefetchCount > 0 || _presetCacheEnabled;
+}
+
+bool ProjectMWrapper::CurrentPresetInPlaylist() const
+{
+    return _presetSwitchCount > 0 && !_currentPresetRemoved;
+}
+
+std::string ProjectMWrapper::PlaylistItem(uint32_t index) const
+{
+    auto item = projectm_playlist_item(_playlist, index);
+    if (item == nullptr)
+    {
+        return {};
+    }
+
+    std::string fileName(item);
+    projectm_playlist_free_string(item);
+
+    return fileName;
+}
+
 void ProjectMWrapper::PlaybackControlNotificationHandler(const Poco::AutoPtr<PlaybackControlNotification>& notification)
 {
     switch (notification->ControlAction())
     {
         case PlaybackControlNotification::Action::NextPreset:
-            projectm_playlist_play_next(_playlist, !notification->SmoothTransition());
+            PlayNext(!notification->SmoothTransition());
             break;
 
         case PlaybackControlNotification::Action::PreviousPreset:
-            projectm_playlist_play_previous(_playlist, !notification->SmoothTransition());
+            PlayPrevious(!notification->SmoothTransition());
             break;
 
         case PlaybackControlNotification::Action::LastPreset:
-            projectm_playlist_play_last(_playlist, !notification->SmoothTransition());
+            PlayLast(!notification->SmoothTransition());
             break;
 
-        case PlaybackControlNotification::Action::RandomPreset: {
-            bool shuffleEnabled = projectm_playlist_get_shuffle(_playlist);
-            projectm_playlist_set_shuffle(_playlist, true);
-            projectm_playlist_play_next(_playlist, !notification->SmoothTransition());
-            projectm_playlist_set_shuffle(_playlist, shuffleEnabled);
+        case PlaybackControlNotification::Action::RandomPreset:
+            PlayRandom(!notification->SmoothTransition());
             break;
-        }
 
         case PlaybackControlNotification::Action::ToggleShuffle:
-            _userConfig->setBool("projectM.shuffleEnabled", !projectm_playlist_get_shuffle(_playlist));
+            _userConfig->setBool("projectM.shuffleEnabled", !Settings()->shuffleEnabled);
             break;
 
         case PlaybackControlNotification::Action::TogglePresetLocked: {
@@ -274,6 +737,255 @@ std::vector<std::string> ProjectMWrapper::GetPathListWithDefault(const std::stri
     return pathList;
 }
 
+void ProjectMWrapper::AddPresets(const std::vector<std::string>& presetFiles)
+{
+    // Adding presets without duplicates is quadratic in the playlist library, so they're filtered here.
+    std::vector<const char*> presetFileList;
+    presetFileList.reserve(presetFiles.size());
+    for (const auto& presetFile : presetFiles)
+    {
+        if (_playlistFiles.insert(presetFile).second)
+        {
+            presetFileList.push_back(presetFile.c_str());
+        }
+    }
+
+    if (!presetFileList.empty())
+    {
+        projectm_playlist_add_presets(_playlist, presetFileList.data(), static_cast<uint32_t>(presetFileList.size()), true);
+    }
+}
+
+void ProjectMWrapper::SortPlaylist()
+{
+    auto playlistSize = projectm_playlist_size(_playlist);
+    if (playlistSize == 0)
+    {
+        return;
+    }
+
+    // Sorting changes all indices, so remember the current preset and history by file name.
+    std::string currentPreset = CurrentPresetFile();
+    std::vector<std::string> historyPresets;
+    historyPresets.reserve(_history.size());
+    for (auto index : _history)
+    {
+        historyPresets.push_back(PlaylistItem(index));
+    }
+
+    projectm_playlist_sort(_playlist, 0, playlistSize, SORT_PREDICATE_FILENAME_ONLY, SORT_ORDER_ASCENDING);
+    _playlistVersion++;
+
+    std::unordered_map<std::string, uint32_t> presetIndices;
+    auto items = projectm_playlist_items(_playlist, 0, playlistSize);
+    if (items != nullptr)
+    {
+        for (uint32_t index = 0; items[index] != nullptr; index++)
+        {
+            presetIndices.emplace(items[index], index);
+        }
+        projectm_playlist_free_string_array(items);
+    }
+
+    auto currentIndex = presetIndices.find(currentPreset);
+    _currentIndex = currentIndex != presetIndices.end() ? currentIndex->second : 0;
+
+    _history.clear();
+    for (const auto& historyPreset : historyPresets)
+    {
+        auto historyIndex = presetIndices.find(historyPreset);
+        if (historyIndex != presetIndices.end())
+        {
+            _history.push_back(historyIndex->second);
+        }
+    }
+
+    _randomIndices.clear();
+    UpdatePrefetch();
+}
+
+#ifdef PRESET_DIRECTORY_WATCHER
+void ProjectMWrapper::StartPresetWatcher(const std::vector<std::string>& directories)
+{
+    if (!_projectMConfigView->getBool("watchPresetDirectories", true))
+    {
+        return;
+    }
+
+    try
+    {
+        std::unique_ptr<PresetDirectoryWatcher> presetWatcher(new PresetDirectoryWatcher);
+        presetWatcher->Start(directories);
+        _presetWatcher = std::move(presetWatcher);
+    }
+    catch (const Poco::Exception& ex)
+    {
+        poco_warning_f1(_logger, "Preset directories can't be watched for changes: %s", ex.displayText());
+    }
+}
+
+void ProjectMWrapper::ApplyPresetChanges(const PresetDirectoryWatcher::Changes& changes)
+{
+    std::vector<std::string> items;
+    items.reserve(projectm_playlist_size(_playlist));
+    auto playlistItems = projectm_playlist_items(_playlist, 0, projectm_playlist_size(_playlist));
+    if (playlistItems != nullptr)
+    {
+        for (uint32_t index = 0; playlistItems[index] != nullptr; index++)
+        {
+            items.emplace_back(playlistItems[index]);
+        }
+        projectm_playlist_free_string_array(playlistItems);
+    }
+
+    // After a resync, every preset which wasn't listed again is gone.
+    std::unordered_set<std::string> resyncedPresets;
+    if (changes.resync)
+    {
+        resyncedPresets.insert(changes.addedPresets.begin(), changes.addedPresets.end());
+    }
+
+    // Removals: collect all affected indices first, then remove them back to front so the others stay valid.
+    std::unordered_set<std::string> removedPresets(changes.removedPresets.begin(), changes.removedPresets.end());
+    std::vector<uint32_t> removedIndices;
+    for (uint32_t index = 0; index < items.size(); index++)
+    {
+        const auto& item = items[index];
+        bool removed = (changes.resync && resyncedPresets.find(item) == resyncedPresets.end()) ||
+                       removedPresets.find(item) != removedPresets.end() ||
+                       std::any_of(changes.removedDirectories.begin(), changes.removedDirectories.end(),
+                                   [&item](const std::string& directory) {
+                                       return item.compare(0, directory.size(), directory) == 0;
+                                   });
+        if (removed)
+        {
+            removedIndices.push_back(index);
+        }
+    }
+
+    // Cached contents of removed or changed files must not be used anymore.
+    std::vector<std::string> invalidatedPresets;
+    bool currentPresetRemoved{false};
+
+    for (auto it = removedIndices.rbegin(); it != removedIndices.rend(); ++it)
+    {
+        projectm_playlist_remove_preset(_playlist, *it);
+        _playlistFiles.erase(items[*it]);
+        invalidatedPresets.push_back(std::move(items[*it]));
+        items.erase(items.begin() + *it);
+    }
+
+    if (!removedIndices.empty())
+    {
+        _playlistVersion++;
+
+        // Maps an old index to the new one, which is the index of the next remaining preset if it was removed.
+        auto remapIndex = [&removedIndices](uint32_t index) {
+            return index - static_cast<uint32_t>(std::lower_bound(removedIndices.begin(), removedIndices.end(), index) - removedIndices.begin());
+        };
+        auto isRemoved = [&removedIndices](uint32_t index) {
+            return std::binary_search(removedIndices.begin(), removedIndices.end(), index);
+        };
+
+        // If the displayed preset was deleted, it keeps playing but is no longer part of the playlist. _currentIndex
+        // then points to the next remaining preset, so navigation continues from there.
+        if (_presetSwitchCount > 0 && !_currentPresetRemoved && isRemoved(_currentIndex))
+        {
+            poco_debug(_logger, "The displayed preset was removed from the playlist.");
+            _currentPresetRemoved = true;
+            currentPresetRemoved = true;
+        }
+        auto currentIndex = remapIndex(_currentIndex);
+        _currentIndex = currentIndex < items.size() ? currentIndex : 0;
+
+        _history.erase(std::remove_if(_history.begin(), _history.end(), isRemoved), _history.end());
+        std::transform(_history.begin(), _history.end(), _history.begin(), remapIndex);
+
+        _randomIndices.erase(std::remove_if(_randomIndices.begin(), _randomIndices.end(), isRemoved), _randomIndices.end());
+        std::transform(_randomIndices.begin(), _randomIndices.end(), _randomIndices.begin(), remapIndex);
+    }
+
+    // Additions: insert each preset at its sorted position, matching SortPlaylist().
+    auto fileNameLess = [](const std::string& left, const std::string& right) {
+        return Poco::Path(left).getFileName() < Poco::Path(right).getFileName();
+    };
+
+    // Modified files may be missing from the playlist if they were created before the watcher was started.
+    std::vector<std::string> changedPresets(changes.addedPresets);
+    changedPresets.insert(changedPresets.end(), changes.modifiedPresets.begin(), changes.modifiedPresets.end());
+
+    size_t addedCount{0};
+    size_t modifiedCount{0};
+    for (const auto& presetFile : changedPresets)
+    {
+        if (_playlistFiles.find(presetFile) != _playlistFiles.end())
+        {
+            // Rewritten in place or replaced by a moved file. After a resync, any file may have changed.
+            invalidatedPresets.push_back(presetFile);
+            modifiedCount++;
+            continue;
+        }
+
+        auto position = static_cast<uint32_t>(std::upper_bound(items.begin(), items.end(), presetFile, fileNameLess) - items.begin());
+        if (!projectm_playlist_insert_preset(_playlist, presetFile.c_str(), position, true))
+        {
+            continue;
+        }
+
+        _playlistFiles.insert(presetFile);
+        items.insert(items.begin() + position, presetFile);
+        addedCount++;
+        _playlistVersion++;
+
+        auto shiftIndex = [position](uint32_t index) {
+            return index >= position ? index + 1 : index;
+        };
+
+        // Before the first preset switch, index 0 is the one displayed next and stays the first item.
+        if (_presetSwitchCount > 0)
+        {
+            _currentIndex = shiftIndex(_currentIndex);
+        }
+        std::transform(_history.begin(), _history.end(), _history.begin(), shiftIndex);
+        std::transform(_randomIndices.begin(), _randomIndices.end(), _randomIndices.begin(), shiftIndex);
+    }
+
+    if (UsePrefetcher() && !invalidatedPresets.empty())
+    {
+        _prefetcher.Invalidate(invalidatedPresets);
+    }
+
+    poco_information_f4(_logger, "Preset library changed: %?u presets added, %?u modified, %?u removed, playlist has %?u presets.",
+                        addedCount, changes.resync ? 0 : modifiedCount, removedIndices.size(), items.size());
+
+    // The window title must not show the name of the preset which took the removed one's index.
+    if (currentPresetRemoved)
+    {
+        Poco::NotificationCenter::defaultCenter().postNotification(new UpdateWindowTitleNotification);
+    }
+
+    UpdatePrefetch();
+}
+#endif
+
+std::string ProjectMWrapper::PresetIndexFile()
+{
+    auto userConfigurationFile = Poco::Util::Application::instance().config().getString("app.UserConfigurationFile", "");
+    if (!_projectMConfigView->getBool("presetIndex", true) || userConfigurationFile.empty())
+    {
+        return {};
+    }
+
+    return Poco::Path(userConfigurationFile).setFileName("presetIndex.bin").toString();
+}
+
+void ProjectMWrapper::UpdateSettings()
+{
+    auto settings = std::make_shared<const SettingsSnapshot>(
+        SettingsSnapshot::FromConfiguration(Poco::Util::Application::instance().config()));
+    std::atomic_store(&_settings, std::move(settings));
+}
+
 void ProjectMWrapper::OnConfigurationPropertyChanged(const Poco::Util::AbstractConfiguration::KeyValue& property)
 {
     OnConfigurationPropertyRemoved(property.key());
@@ -281,6 +993,8 @@ void ProjectMWrapper::OnConfigurationPropertyChanged(const Poco::Util::AbstractC
 
 void ProjectMWrapper::OnConfigurationPropertyRemoved(const std::string& key)
 {
+    UpdateSettings();
+
     if (_projectM == nullptr || _playlist == nullptr)
     {
         return;
@@ -294,7 +1008,8 @@ void ProjectMWrapper::OnConfigurationPropertyRemoved(const std::string& key)
 
     if (key == "projectM.shuffleEnabled")
     {
-        projectm_playlist_set_shuffle(_playlist, _projectMConfigView->getBool("shuffleEnabled", true));
+        _randomIndices.clear();
+        UpdatePrefetch();
     }
 
     if (key == "projectM.aspectCorrectionEnabled")
@@ -314,7 +1029,7 @@ void ProjectMWrapper::OnConfigurationPropertyRemoved(const std::string& key)
 
     if (key == "projectM.hardCutsEnabled")
     {
-        projectm_set_aspect_correction(_projectM, _projectMConfigView->getBool("hardCutsEnabled", false));
+        projectm_set_hard_cut_enabled(_projectM, _projectMConfigView->getBool("hardCutsEnabled", false));
     }
 
     if (key == "projectM.hardCutDuration")
@@ -329,6 +1044,7 @@ void ProjectMWrapper::OnConfigurationPropertyRemoved(const std::string& key)
 
     if (key == "projectM.meshX" || key == "projectM.meshY")
     {
-        projectm_set_mesh_size(_projectM, _projectMConfigView->getUInt64("meshX", 48), _projectMConfigView->getUInt64("meshY", 32));
+        auto settings = Settings();
+        projectm_set_mesh_size(_projectM, settings->meshX, settings->meshY);
     }
 }
@@ -1,7 +1,15 @@
 #pragma once
 
+#include "PresetPrefetcher.h"
+#include "PresetScanner.h"
+#include "SettingsSnapshot.h"
+
 #include "notifications/PlaybackControlNotification.h"
 
+#ifdef PRESET_DIRECTORY_WATCHER
+#include "PresetDirectoryWatcher.h"
+#endif
+
 #include <projectM-4/projectM.h>
 #include <projectM-4/playlist.h>
 
@@ -11,11 +19,18 @@
 #include <Poco/Util/AbstractConfiguration.h>
 #include <Poco/Util/Subsystem.h>
 
+#include <deque>
+#include <limits>
 #include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
 
 class ProjectMWrapper : public Poco::Util::Subsystem
 {
 public:
+    static constexpr uint32_t NoPresetIndex{std::numeric_limits<uint32_t>::max()}; //!< Returned by CurrentPresetIndex() if no playlist item is displayed.
+
     const char* name() const override;
 
     void initialize(Poco::Util::Application& app) override;
@@ -36,8 +51,15 @@ public:
 
     /**
      * Renders a single projectM frame.
+     * @param framebufferObject The OpenGL framebuffer to render into. 0 renders into the window.
      */
-    void RenderFrame() const;
+    void RenderFrame(uint32_t framebufferObject = 0) const;
+
+    /**
+     * @brief Returns whether the libprojectM version in use can render into a framebuffer object.
+     * @return True if RenderFrame() supports other framebuffers than the window's.
+     */
+    static bool CanRenderToFramebuffer();
 
     /**
      * @brief Returns the targeted FPS value.
@@ -45,6 +67,34 @@ public:
      */
     int TargetFPS();
 
+    /**
+     * @brief Returns the current settings snapshot.
+     *
+     * The snapshot is replaced as a whole if any user setting changes, so callers can keep the returned pointer for
+     * the duration of a frame and always see consistent values.
+     *
+     * @return The current settings snapshot. Never nullptr after initialization.
+     */
+    std::shared_ptr<const SettingsSnapshot> Settings() const;
+
+    /**
+     * @brief Scales the configured per-pixel mesh size.
+     *
+     * Used by the MeshGovernor to trade quality for speed. The scaled size is applied on the next frame.
+     *
+     * @param quality The scale factor for both mesh dimensions, between 0.0 and 1.0.
+     */
+    void MeshQuality(float quality);
+
+    /**
+     * @brief Returns the number of preset switches since the application was started.
+     *
+     * Can be used to detect preset changes by comparing the value between frames.
+     *
+     * @return The number of times a new preset was displayed.
+     */
+    uint32_t PresetSwitchCount() const;
+
     /**
      * @brief Updates projectM with the current, actual FPS value.
      * @param fps The current FPS value.
@@ -54,9 +104,114 @@ public:
     /**
      * @brief If splash is disabled, shows the initial preset.
      * If shuffle is on, a random preset will be picked. Otherwise, the first playlist item is displayed.
+     * If the directory scan hasn't found any preset yet, the initial preset is displayed by PollPresetScan() later.
      */
     void DisplayInitialPreset();
 
+    /**
+     * @brief Switches to the next preset.
+     *
+     * If shuffle is enabled, the next preset is drawn randomly. The application selects presets itself instead of
+     * using the playlist's navigation functions, so it knows the upcoming presets in advance and can prefetch them.
+     * Automatic switches requested by projectM also end up here.
+     *
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     */
+    void PlayNext(bool hardCut);
+
+    /**
+     * @brief Switches to the previous playlist item, or to the last displayed preset if shuffle is enabled.
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     */
+    void PlayPrevious(bool hardCut);
+
+    /**
+     * @brief Switches back to the previously displayed preset, if there is any.
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     */
+    void PlayLast(bool hardCut);
+
+    /**
+     * @brief Switches to a random preset, regardless of the shuffle setting.
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     */
+    void PlayRandom(bool hardCut);
+
+    /**
+     * @brief Switches to the given playlist item.
+     *
+     * Uses the prefetched preset data if available, otherwise the playlist loads the preset from disk.
+     *
+     * @param index The playlist index.
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     */
+    void PlayPreset(uint32_t index, bool hardCut);
+
+    /**
+     * @brief Returns the playlist index of the currently displayed preset.
+     * @return The current playlist index, or NoPresetIndex if the displayed preset was removed from the playlist.
+     */
+    uint32_t CurrentPresetIndex() const;
+
+    /**
+     * @brief Returns the file name of the currently displayed preset.
+     * @return The preset file name, or an empty string if no preset was displayed yet or it was removed from the playlist.
+     */
+    std::string CurrentPresetFile() const;
+
+    /**
+     * @brief Returns a counter which is incremented whenever presets already in the playlist change their index.
+     *
+     * This happens if the playlist is sorted or presets are inserted or removed. Appending presets while the directory
+     * scan is running doesn't change the counter, as all existing indices stay valid.
+     *
+     * @return The playlist version.
+     */
+    uint32_t PlaylistVersion() const;
+
+    /**
+     * @brief Returns the usage counters of the preset content cache.
+     * @return The cache statistics. All values are 0 if both prefetching and the preset cache are disabled.
+     */
+    PresetCache::Statistics PresetCacheStatistics();
+
+    /**
+     * @brief Returns the presets which will most likely be displayed next, in order.
+     *
+     * In shuffle mode, the random presets are drawn in advance, so these are exactly the presets PlayNext() will
+     * display. Before the initial preset is displayed, the list starts with it.
+     *
+     * @param count The number of presets to return.
+     * @return The preset file names. May contain fewer entries if the playlist is small.
+     */
+    std::vector<std::string> UpcomingPresets(size_t count);
+
+    /**
+     * @brief Seeds the random generator used to shuffle presets.
+     *
+     * With the same seed and playlist, random preset selection is reproducible.
+     *
+     * @param seed The seed value.
+     */
+    void SeedShuffle(uint32_t seed);
+
+    /**
+     * @brief Adds the presets found by the background directory scan to the playlist.
+     *
+     * Must be called regularly, e.g. once per frame. If no preset could be displayed on startup because none was
+     * found yet, the initial preset is displayed as soon as the first one is added. When the scan has finished, the
+     * playlist is sorted, keeping the current preset, and the preset directories are watched for changes if enabled.
+     * Changes reported by the watcher are then applied here as well.
+     */
+    void PollPresetScan();
+
+    /**
+     * @brief Waits until the background directory scan has finished and adds all remaining presets to the playlist.
+     *
+     * Used by modes which need the complete, sorted playlist up front.
+     */
+    void FinishPresetScan();
+
     /**
      * @brief Changes beat sensitivity by the given value.
      * @param value A positive or negative delta value.
@@ -84,10 +239,126 @@ private:
      */
     static void PresetSwitchedEvent(bool isHardCut, unsigned int index, void* context);
 
+    /**
+     * @brief projectM callback. Called if projectM wants to switch to the next preset, e.g. after the display duration.
+     *
+     * Replaces the playlist's own handler, so automatic switches also use the prefetched presets.
+     *
+     * @param isHardCut True if a hard cut was requested.
+     * @param context Callback context, e.g. "this" pointer.
+     */
+    static void PresetSwitchRequestedEvent(bool isHardCut, void* context);
+
+    /**
+     * @brief projectM callback. Called if a preset loaded from prefetched data couldn't be compiled.
+     * @param presetFilename The file name of the preset, empty for data loaded from memory.
+     * @param message The error message.
+     * @param context Callback context, e.g. "this" pointer.
+     */
+    static void PresetLoadFailedEvent(const char* presetFilename, const char* message, void* context);
+
+    /**
+     * @brief Loads a preset from prefetched data.
+     *
+     * While loading, projectM's failure callback is redirected from the playlist to this class, so the playlist
+     * doesn't skip to another preset on its own. Afterwards, the playlist is connected again.
+     *
+     * @param presetData The preset file contents.
+     * @param hardCut True for an immediate switch, false for a soft transition.
+     * @return True if projectM loaded the preset, false if it failed.
+     */
+    bool LoadPresetData(const std::string& presetData, bool hardCut);
+
+    /**
+     * @brief Updates the current index and notifies the application after a preset has been displayed.
+     * @param index The playlist index of the new preset.
+     */
+    void PresetDisplayed(uint32_t index);
+
+    /**
+     * @brief Returns the next pre-drawn random playlist index and draws new ones as needed.
+     * @return A random playlist index.
+     */
+    uint32_t NextRandomIndex();
+
+    /**
+     * @brief Returns the playlist indices which will most likely be displayed next, drawing random ones as needed.
+     * @param count The number of indices to return.
+     * @return The upcoming playlist indices.
+     */
+    std::vector<uint32_t> UpcomingIndices(size_t count);
+
+    /**
+     * @brief Predicts the next presets from the shuffle setting and passes them to the prefetcher.
+     *
+     * If the preset cache is enabled, the displayed preset is passed as well, so it's kept in memory afterwards.
+     */
+    void UpdatePrefetch();
+
+    /**
+     * @brief Returns whether the prefetcher is running, i.e. prefetching or the preset cache is enabled.
+     * @return True if presets can be loaded from memory.
+     */
+    bool UsePrefetcher() const;
+
+    /**
+     * @brief Returns whether _currentIndex refers to the preset on screen.
+     * @return False before the first preset was displayed or after the displayed preset was removed from the playlist.
+     */
+    bool CurrentPresetInPlaylist() const;
+
+    /**
+     * @brief Returns the file name of the given playlist item.
+     * @param index The playlist index.
+     * @return The preset file name, or an empty string if the index is invalid.
+     */
+    std::string PlaylistItem(uint32_t index) const;
+
     void PlaybackControlNotificationHandler(const Poco::AutoPtr<PlaybackControlNotification>& notification);
 
     std::vector<std::string> GetPathListWithDefault(const std::string& baseKey, const std::string& defaultPath);
 
+    /**
+     * @brief Appends presets to the playlist, skipping those already in it.
+     * @param presetFiles The preset file names.
+     */
+    void AddPresets(const std::vector<std::string>& presetFiles);
+
+    /**
+     * @brief Sorts the playlist by file name and updates all stored playlist indices.
+     */
+    void SortPlaylist();
+
+#ifdef PRESET_DIRECTORY_WATCHER
+    /**
+     * @brief Starts watching all scanned preset directories if enabled.
+     * @param directories The scanned directories.
+     */
+    void StartPresetWatcher(const std::vector<std::string>& directories);
+
+    /**
+     * @brief Applies a batch of preset library changes to the sorted playlist without resorting it.
+     *
+     * Removed presets are taken out and new presets are inserted at their sorted position. The current preset,
+     * history and upcoming random presets are kept, only their indices are updated. Modified and removed presets are
+     * discarded from the preset cache. A resync is diffed against the playlist.
+     *
+     * @param changes The changes reported by the directory watcher.
+     */
+    void ApplyPresetChanges(const PresetDirectoryWatcher::Changes& changes);
+#endif
+
+    /**
+     * @brief Returns the file name of the preset directory index, next to the user configuration file.
+     * @return The index file name, or an empty string if the index is disabled.
+     */
+    std::string PresetIndexFile();
+
+    /**
+     * @brief Rebuilds the settings snapshot from the effective configuration and publishes it.
+     */
+    void UpdateSettings();
+
     /**
      * @brief Event callback if a configuration value has changed.
      * @param property The key and value that has been changed.
@@ -103,9 +374,33 @@ private:
     Poco::AutoPtr<Poco::Util::AbstractConfiguration> _userConfig; //!< View of the "projectM" configuration subkey in the "user" configuration.
     Poco::AutoPtr<Poco::Util::AbstractConfiguration> _projectMConfigView; //!< View of the "projectM" configuration subkey in the "effective" configuration.
 
+    std::shared_ptr<const SettingsSnapshot> _settings; //!< Current settings snapshot. Only accessed via std::atomic_load/store.
+
     projectm_handle _projectM{nullptr}; //!< Pointer to the projectM instance used by the application.
     projectm_playlist_handle _playlist{nullptr}; //!< Pointer to the projectM playlist manager instance.
 
+    float _meshQuality{1.0f}; //!< Scale factor applied to the configured mesh size.
+    uint32_t _presetSwitchCount{0}; //!< Number of preset switches, incremented in PresetDisplayed().
+
+    uint32_t _playlistVersion{0}; //!< Incremented if existing playlist indices change, see PlaylistVersion().
+    uint32_t _currentIndex{0}; //!< Playlist index of the currently displayed preset, or of the next one if it was removed.
+    bool _currentPresetRemoved{false}; //!< True if the displayed preset was removed from the playlist, reset in PresetDisplayed().
+    bool _presetLoadFailed{false}; //!< Set by PresetLoadFailedEvent() while loading prefetched preset data.
+    std::vector<uint32_t> _history; //!< Previously displayed playlist indices, most recent last.
+    std::deque<uint32_t> _randomIndices; //!< Pre-drawn random playlist indices for shuffle mode.
+    std::mt19937 _randomGenerator{std::random_device{}()}; //!< Random generator for shuffle mode.
+    size_t _prefetchCount{3}; //!< Number of upcoming presets to read in advance. 0 disables prefetching.
+    bool _presetCacheEnabled{true}; //!< If true, displayed presets are kept in memory within the cache budget.
+    PresetPrefetcher _prefetcher; //!< Reads upcoming preset files in the background and holds the preset cache.
+
+    std::unique_ptr<PresetScanner> _presetScanner; //!< Scans the preset directories, nullptr after the scan has finished.
+    std::unordered_set<std::string> _playlistFiles; //!< All preset files in the playlist, to filter duplicates.
+    bool _initialPresetPending{false}; //!< True if the initial preset is displayed once the first preset was found.
+
+#ifdef PRESET_DIRECTORY_WATCHER
+    std::unique_ptr<PresetDirectoryWatcher> _presetWatcher; //!< Reports changes in the preset directories, if enabled.
+#endif
+
     Poco::NObserver<ProjectMWrapper, PlaybackControlNotification> _playbackControlNotificationObserver{*this, &ProjectMWrapper::PlaybackControlNotificationHandler};
 
     Poco::Logger& _logger{Poco::Logger::get("SDLRenderingWindow")}; //!< The class logger.
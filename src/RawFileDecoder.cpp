@@ -0,0 +1,51 @@
+#include "RawFileDecoder.h"
+
+#include "SampleConverter.h"
+
+#include <Poco/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+
+RawFileDecoder::RawFileDecoder(const char* data, size_t size, uint32_t sampleRate, uint32_t channels)
+    : _sampleData(data)
+    , _sampleRate(sampleRate)
+    , _channels(channels)
+{
+    if (_sampleRate == 0 || _channels == 0 || _channels > SampleConverter::MaxInputChannels)
+    {
+        throw Poco::DataFormatException("Raw PCM data requires a valid sample rate and a supported channel count");
+    }
+
+    _frameCount = size / (sizeof(float) * _channels);
+}
+
+const char* RawFileDecoder::FormatName() const
+{
+    return "raw float PCM";
+}
+
+uint32_t RawFileDecoder::SampleRate() const
+{
+    return _sampleRate;
+}
+
+uint32_t RawFileDecoder::Channels() const
+{
+    return _channels;
+}
+
+size_t RawFileDecoder::Decode(float* output, size_t frames)
+{
+    frames = std::min(frames, _frameCount - _nextFrame);
+
+    std::memcpy(output, _sampleData + _nextFrame * _channels * sizeof(float), frames * _channels * sizeof(float));
+    _nextFrame += frames;
+
+    return frames;
+}
+
+void RawFileDecoder::Rewind()
+{
+    _nextFrame = 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "AudioFileDecoder.h"
+
+/**
+ * @brief "Decoder" for headerless, interleaved 32-bit float PCM data in native byte order.
+ *
+ * As the data has no header, sample rate and channel count have to be provided by the user.
+ */
+class RawFileDecoder : public AudioFileDecoder
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param data Pointer to the file contents.
+     * @param size Size of the file contents in bytes.
+     * @param sampleRate The sample rate of the data in Hz.
+     * @param channels The number of interleaved channels.
+     */
+    RawFileDecoder(const char* data, size_t size, uint32_t sampleRate, uint32_t channels);
+
+    const char* FormatName() const override;
+
+    uint32_t SampleRate() const override;
+
+    uint32_t Channels() const override;
+
+    size_t Decode(float* output, size_t frames) override;
+
+    void Rewind() override;
+
+private:
+    const char* _sampleData{nullptr}; //!< Start of the sample data.
+    size_t _frameCount{0}; //!< Number of complete sample frames in the file.
+    size_t _nextFrame{0}; //!< Next frame to decode.
+
+    uint32_t _sampleRate{0}; //!< Sample rate in Hz.
+    uint32_t _channels{0}; //!< Number of interleaved channels.
+};
@@ -1,6 +1,9 @@
 #include "RenderLoop.h"
 
 #include "FPSLimiter.h"
+#include "FrameStatistics.h"
+#include "MeshGovernor.h"
+#include "PresetWarmUp.h"
 
 #include "gui/ProjectMGUI.h"
 
@@ -10,6 +13,9 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+#include <thread>
+
 RenderLoop::RenderLoop()
     : _audioCapture(Poco::Util::Application::instance().getSubsystem<AudioCapture>())
     , _projectMWrapper(Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>())
@@ -17,31 +23,93 @@ RenderLoop::RenderLoop()
     , _projectMHandle(_projectMWrapper.ProjectM())
     , _playlistHandle(_projectMWrapper.Playlist())
     , _projectMGui(Poco::Util::Application::instance().getSubsystem<ProjectMGUI>())
+    , _renderScaler(_projectMWrapper, _sdlRenderingWindow.Framebuffer())
 {
 }
 
 void RenderLoop::Run()
 {
-    FPSLimiter limiter;
-
     auto& notificationCenter{Poco::NotificationCenter::defaultCenter()};
 
     notificationCenter.addObserver(_quitNotificationObserver);
 
+    PresetWarmUp().Run();
     _projectMWrapper.DisplayInitialPreset();
 
+    StartFrameOutputs();
+
+    _windowState = _sdlRenderingWindow.QueryWindowState();
+
+    _useRenderThread = Poco::Util::Application::instance().config().getBool("window.renderThread", false);
+    if (_useRenderThread)
+    {
+        poco_information(_logger, "Rendering on a dedicated render thread.");
+
+        // The context can only be current on one thread at a time.
+        _sdlRenderingWindow.MakeContextCurrent(false);
+        auto initialWindowState = _windowState;
+        std::thread renderThread(&RenderLoop::RenderThread, this);
+        ForwardEvents(initialWindowState);
+        renderThread.join();
+        _sdlRenderingWindow.MakeContextCurrent(true);
+    }
+    else
+    {
+        RenderFrames();
+    }
+
+    StopFrameOutputs();
+
+    notificationCenter.removeObserver(_quitNotificationObserver);
+
+    projectm_playlist_set_preset_switched_event_callback(_playlistHandle, nullptr, nullptr);
+
+    if (_renderThreadException)
+    {
+        std::rethrow_exception(_renderThreadException);
+    }
+}
+
+void RenderLoop::RenderFrames()
+{
+    FPSLimiter limiter;
+    FrameStatistics statistics;
+    MeshGovernor meshGovernor(_projectMWrapper, limiter);
+
     while (!_wantsToQuit)
     {
         limiter.TargetFPS(_projectMWrapper.TargetFPS());
         limiter.StartFrame();
+        statistics.TargetFPS(_projectMWrapper.TargetFPS());
+        statistics.StartFrame();
 
         PollEvents();
+        _projectMWrapper.PollPresetScan();
         CheckViewportSize();
+        _renderScaler.Update(limiter);
+        statistics.EndPhase(FrameStatistics::Phase::Events);
         _audioCapture.FillBuffer();
-        _projectMWrapper.RenderFrame();
-        _projectMGui.Draw();
+        statistics.EndPhase(FrameStatistics::Phase::AudioFill);
+        _projectMWrapper.RenderFrame(_renderScaler.Framebuffer());
+        if (_frameCapture.HasConsumers())
+        {
+            int captureWidth;
+            int captureHeight;
+            _renderScaler.GetRenderSize(captureWidth, captureHeight);
+            _frameCapture.Capture(_renderScaler.Framebuffer(), captureWidth, captureHeight);
+        }
+        _renderScaler.Present();
+        statistics.EndPhase(FrameStatistics::Phase::Render);
+        _projectMGui.Draw(_windowState);
+        statistics.EndPhase(FrameStatistics::Phase::GuiDraw);
+        limiter.EndWork();
 
         _sdlRenderingWindow.Swap();
+        statistics.EndPhase(FrameStatistics::Phase::Swap);
+
+        statistics.DumpIfRequested();
+
+        meshGovernor.Update();
 
         limiter.EndFrame();
 
@@ -49,80 +117,189 @@ void RenderLoop::Run()
         _projectMWrapper.UpdateRealFPS(limiter.FPS());
     }
 
-    notificationCenter.removeObserver(_quitNotificationObserver);
+    // Pending frames must be read while the context is still current on this thread.
+    _frameCapture.Flush();
 
-    projectm_playlist_set_preset_switched_event_callback(_playlistHandle, nullptr, nullptr);
+    statistics.Dump();
 }
 
-void RenderLoop::PollEvents()
+void RenderLoop::RenderThread()
 {
-    SDL_Event event;
+    _sdlRenderingWindow.MakeContextCurrent(true);
 
-    while (SDL_PollEvent(&event))
+    try
+    {
+        RenderFrames();
+    }
+    catch (...)
     {
-        _projectMGui.ProcessInput(event);
+        _renderThreadException = std::current_exception();
+        _wantsToQuit = true;
+    }
 
-        switch (event.type)
-        {
-            case SDL_MOUSEWHEEL:
+    _sdlRenderingWindow.MakeContextCurrent(false);
+}
 
-                if (!_projectMGui.WantsMouseInput())
+void RenderLoop::ForwardEvents(WindowState windowState)
+{
+    while (!_wantsToQuit)
+    {
+        // Wake up regularly to notice if the render thread requested to quit, and more often while events wait for
+        // space in the queue.
+        SDL_Event event;
+        if (SDL_WaitEventTimeout(&event, _eventQueue.Flush() ? 100 : 5))
+        {
+            do
+            {
+                if (_sdlRenderingWindow.HandleWindowCommand(event))
                 {
-                    ScrollEvent(event.wheel);
+                    continue;
                 }
 
-                break;
-
-            case SDL_KEYDOWN:
-                if (!_projectMGui.WantsKeyboardInput())
+                if (event.type == SDL_QUIT)
                 {
-                    KeyEvent(event.key, true);
+                    _wantsToQuit = true;
                 }
-                break;
 
-            case SDL_KEYUP:
-                if (!_projectMGui.WantsKeyboardInput())
-                {
-                    KeyEvent(event.key, false);
-                }
-                break;
+                _eventQueue.Push(event);
+            } while (SDL_PollEvent(&event));
+        }
 
-            case SDL_MOUSEBUTTONDOWN:
-                if (!_projectMGui.WantsMouseInput())
-                {
-                    MouseDownEvent(event.button);
-                }
+        auto newWindowState = _sdlRenderingWindow.QueryWindowState();
+        if (newWindowState != windowState)
+        {
+            windowState = newWindowState;
+            _eventQueue.PublishWindowState(windowState);
+        }
+    }
+}
 
-                break;
+void RenderLoop::StartFrameOutputs()
+{
+#ifdef FRAME_OUTPUT_SHARED_MEMORY
+    auto& config = Poco::Util::Application::instance().config();
+    auto sharedMemoryName = config.getString("output.sharedMemory.name", "");
+    if (!sharedMemoryName.empty())
+    {
+        try
+        {
+            _sharedMemoryOutput.reset(new SharedMemoryFrameOutput(sharedMemoryName,
+                                                                  config.getInt("output.sharedMemory.maxWidth", 3840),
+                                                                  config.getInt("output.sharedMemory.maxHeight", 2160),
+                                                                  config.getUInt("output.sharedMemory.slots", 3)));
+            auto output = _sharedMemoryOutput.get();
+            _sharedMemoryConsumerId = _frameCapture.AddConsumer([output](const FrameCapture::Frame& frame) {
+                output->Publish(frame);
+            });
+        }
+        catch (const Poco::Exception& ex)
+        {
+            poco_error_f1(_logger, "Shared memory frame output is disabled: %s", ex.displayText());
+        }
+    }
+#endif
+}
 
-            case SDL_MOUSEBUTTONUP:
-                if (!_projectMGui.WantsMouseInput())
-                {
-                    MouseUpEvent(event.button);
-                }
+void RenderLoop::StopFrameOutputs()
+{
+#ifdef FRAME_OUTPUT_SHARED_MEMORY
+    if (_sharedMemoryOutput)
+    {
+        _frameCapture.RemoveConsumer(_sharedMemoryConsumerId);
+        _sharedMemoryOutput.reset();
+    }
+#endif
+}
 
-                break;
+void RenderLoop::PollEvents()
+{
+    SDL_Event event;
 
-            case SDL_QUIT:
-                _wantsToQuit = true;
-                break;
+    if (_useRenderThread)
+    {
+        while (_eventQueue.Pop(event))
+        {
+            HandleEvent(event);
         }
+        _eventQueue.TakeWindowState(_windowState);
+        return;
+    }
+
+    while (SDL_PollEvent(&event))
+    {
+        HandleEvent(event);
+    }
+    _windowState = _sdlRenderingWindow.QueryWindowState();
+}
+
+void RenderLoop::HandleEvent(const SDL_Event& event)
+{
+    _projectMGui.ProcessInput(event);
+
+    switch (event.type)
+    {
+        case SDL_MOUSEWHEEL:
+
+            if (!_projectMGui.WantsMouseInput())
+            {
+                ScrollEvent(event.wheel);
+            }
+
+            break;
+
+        case SDL_KEYDOWN:
+            if (!_projectMGui.WantsKeyboardInput())
+            {
+                KeyEvent(event.key, true);
+            }
+            break;
+
+        case SDL_KEYUP:
+            if (!_projectMGui.WantsKeyboardInput())
+            {
+                KeyEvent(event.key, false);
+            }
+            break;
+
+        case SDL_MOUSEBUTTONDOWN:
+            if (!_projectMGui.WantsMouseInput())
+            {
+                MouseDownEvent(event.button);
+            }
+
+            break;
+
+        case SDL_MOUSEBUTTONUP:
+            if (!_projectMGui.WantsMouseInput())
+            {
+                MouseUpEvent(event.button);
+            }
+
+            break;
+
+        case SDL_AUDIODEVICEADDED:
+        case SDL_AUDIODEVICEREMOVED:
+            _audioCapture.AudioDeviceEvent(event.adevice);
+            break;
+
+        case SDL_QUIT:
+            _wantsToQuit = true;
+            break;
     }
 }
 
 void RenderLoop::CheckViewportSize()
 {
-    int renderWidth;
-    int renderHeight;
-    _sdlRenderingWindow.GetDrawableSize(renderWidth, renderHeight);
+    auto renderWidth = _windowState.drawableWidth;
+    auto renderHeight = _windowState.drawableHeight;
 
     if (renderWidth != _renderWidth || renderHeight != _renderHeight)
     {
-        projectm_set_window_size(_projectMHandle, renderWidth, renderHeight);
+        _renderScaler.Resize(renderWidth, renderHeight);
         _renderWidth = renderWidth;
         _renderHeight = renderHeight;
 
-        _projectMGui.UpdateFontSize();
+        _projectMGui.UpdateFontSize(_windowState);
 
         poco_debug_f2(_logger, "Resized rendering canvas to %?dx%?d.", renderWidth, renderHeight);
     }
@@ -262,12 +439,12 @@ void RenderLoop::ScrollEvent(const SDL_MouseWheelEvent& event)
     // Wheel up is positive
     if (event.y > 0)
     {
-        projectm_playlist_play_next(_playlistHandle, true);
+        _projectMWrapper.PlayNext(true);
     }
     // Wheel down is negative
     else if (event.y < 0)
     {
-        projectm_playlist_play_previous(_playlistHandle, true);
+        _projectMWrapper.PlayPrevious(true);
     }
 }
 
@@ -284,14 +461,11 @@ void RenderLoop::MouseDownEvent(const SDL_MouseButtonEvent& event)
             if (!_mouseDown && _keyStates._shiftPressed)
             {
                 // ToDo: Improve this to differentiate between single click (add waveform) and drag (move waveform).
-                int x;
-                int y;
-                int width;
-                int height;
-
-                _sdlRenderingWindow.GetDrawableSize(width, height);
-
-                SDL_GetMouseState(&x, &y);
+                // The event position is in window coordinates, so it's scaled by the window size, not the drawable size.
+                int x = event.x;
+                int y = event.y;
+                int width = std::max(_windowState.windowWidth, 1);
+                int height = std::max(_windowState.windowHeight, 1);
 
                 // Scale those coordinates. libProjectM uses a scale of 0..1 instead of absolute pixel coordinates.
                 float scaledX = (static_cast<float>(x) / static_cast<float>(width));
@@ -1,15 +1,26 @@
 #pragma once
 
 #include "AudioCapture.h"
+#include "EventQueue.h"
+#include "FrameCapture.h"
 #include "ProjectMWrapper.h"
+#include "RenderScaler.h"
 #include "SDLRenderingWindow.h"
 
+#ifdef FRAME_OUTPUT_SHARED_MEMORY
+#include "SharedMemoryFrameOutput.h"
+#endif
+
 #include "notifications/QuitNotification.h"
 
 #include <Poco/Logger.h>
 #include <Poco/NObserver.h>
 #include <Poco/Notification.h>
 
+#include <atomic>
+#include <exception>
+#include <memory>
+
 class ProjectMGUI;
 
 class RenderLoop
@@ -28,10 +39,53 @@ protected:
     };
 
     /**
-     * @brief Polls all SDL events in the queue and takes action if required.
+     * @brief Renders frames until the application should quit.
+     *
+     * Runs on the main thread, or on the render thread if enabled.
+     */
+    void RenderFrames();
+
+    /**
+     * @brief Entry point of the render thread.
+     *
+     * Takes over the OpenGL context and renders until the application should quit. Any exception is stored and
+     * rethrown on the main thread after the render thread has finished.
+     */
+    void RenderThread();
+
+    /**
+     * @brief Waits for SDL events on the main thread and forwards them to the render thread.
+     *
+     * Window commands posted by the render thread are executed directly. After each batch of events, the window state
+     * is queried and passed on if it has changed. Returns once the application should quit.
+     *
+     * @param windowState The window state the render thread was started with.
+     */
+    void ForwardEvents(WindowState windowState);
+
+    /**
+     * @brief Creates the configured frame outputs and registers them with the frame capture.
+     */
+    void StartFrameOutputs();
+
+    /**
+     * @brief Delivers all pending frames and destroys the frame outputs.
+     */
+    void StopFrameOutputs();
+
+    /**
+     * @brief Polls all SDL events in the queue and takes action if required, then updates the window state.
+     *
+     * If a render thread is used, takes the events and window state forwarded by the main thread instead.
      */
     void PollEvents();
 
+    /**
+     * @brief Takes action on a single SDL event.
+     * @param event The event.
+     */
+    void HandleEvent(const SDL_Event& event);
+
     /**
      * @brief Checks if the GL viewport size has changed and if so, reconfigured projectM accordingly.
      */
@@ -76,9 +130,24 @@ protected:
 
     ProjectMGUI& _projectMGui;
 
+    RenderScaler _renderScaler; //!< Scales the projectM render resolution relative to the window size.
+
+    FrameCapture _frameCapture; //!< Reads back rendered frames for all registered frame consumers.
+
+#ifdef FRAME_OUTPUT_SHARED_MEMORY
+    std::unique_ptr<SharedMemoryFrameOutput> _sharedMemoryOutput; //!< Publishes frames for local readers, if enabled.
+    int _sharedMemoryConsumerId{0}; //!< Frame capture consumer ID of the shared memory output.
+#endif
+
     Poco::NObserver<RenderLoop, QuitNotification> _quitNotificationObserver{*this, &RenderLoop::QuitNotificationHandler}; //!< The observer for quit notifications.
 
-    bool _wantsToQuit{false};
+    std::atomic<bool> _wantsToQuit{false}; //!< Set if the application should quit, from either thread.
+
+    bool _useRenderThread{false}; //!< If true, rendering runs on a dedicated thread while the main thread handles events.
+    EventQueue _eventQueue; //!< Events forwarded from the main thread to the render thread.
+    std::exception_ptr _renderThreadException; //!< Exception which stopped the render thread, if any.
+
+    WindowState _windowState; //!< Latest window state, as seen by the rendering thread.
 
     bool _mouseDown{false}; //!< Left mouse button is pressed
 
@@ -0,0 +1,241 @@
+#include "RenderScaler.h"
+
+#include "FPSLimiter.h"
+#include "ProjectMWrapper.h"
+
+#ifdef USE_GLEW
+#include <GL/glew.h>
+#endif
+
+#include <SDL2/SDL_opengl.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double ScaleStep{0.85}; //!< Factor applied to the scale when lowering it by one step.
+constexpr uint32_t WindowFrames{30}; //!< Number of frames evaluated at once.
+constexpr uint32_t FailingFrames{WindowFrames / 6}; //!< A window with more missed frames than this fails.
+constexpr uint32_t MinProbeWindows{4}; //!< Good windows required before probing a higher scale.
+constexpr uint32_t MaxProbeWindows{64}; //!< Upper limit for the probe delay after repeatedly failed probes.
+constexpr double MissedFrameRatio{1.1}; //!< A frame taking longer than this share of the target time is missed.
+constexpr double CpuBoundRatio{0.9}; //!< A missed frame is CPU-bound if the CPU work exceeds this share of the target time.
+
+} // namespace
+
+RenderScaler::RenderScaler(ProjectMWrapper& projectMWrapper, uint32_t windowFramebuffer)
+    : _projectMWrapper(projectMWrapper)
+    , _windowFramebuffer(windowFramebuffer)
+    , _probeWindows(MinProbeWindows)
+{
+#if USE_GLES
+    poco_debug(_logger, "Render scaling is not supported with OpenGL ES.");
+#else
+    if (!ProjectMWrapper::CanRenderToFramebuffer())
+    {
+        poco_debug(_logger, "Render scaling requires libprojectM 4.1 or later.");
+    }
+    else if (!OffscreenFramebuffer::Available())
+    {
+        poco_debug(_logger, "Render scaling is not supported, OpenGL framebuffer functions are missing.");
+    }
+    else
+    {
+        _available = true;
+    }
+#endif
+}
+
+void RenderScaler::Resize(int width, int height)
+{
+    _drawableWidth = width;
+    _drawableHeight = height;
+}
+
+void RenderScaler::Update(const FPSLimiter& limiter)
+{
+    auto settings = _projectMWrapper.Settings();
+    if (settings != _settings)
+    {
+        _settings = settings;
+        ApplySettings();
+    }
+
+    RecordFrame(limiter.LastFrameTime(), limiter.LastWorkTime(), limiter.TargetFrameTime());
+
+    ApplySize();
+}
+
+uint32_t RenderScaler::Framebuffer() const
+{
+    return _framebuffer.Name() != 0 ? _framebuffer.Name() : _windowFramebuffer;
+}
+
+void RenderScaler::GetRenderSize(int& width, int& height) const
+{
+    width = _renderWidth;
+    height = _renderHeight;
+}
+
+void RenderScaler::Present()
+{
+    if (_framebuffer.Name() == 0)
+    {
+        return;
+    }
+
+    _framebuffer.BlitTo(_windowFramebuffer, _drawableWidth, _drawableHeight);
+
+    glViewport(0, 0, _drawableWidth, _drawableHeight);
+}
+
+void RenderScaler::ApplySettings()
+{
+    if (!_available)
+    {
+        if (_settings->renderScale < 1.0 || _settings->adaptiveRenderScale)
+        {
+            poco_warning(_logger, "Render scaling is not available, rendering at native resolution.");
+        }
+        return;
+    }
+
+    if (_configuredScale == _settings->renderScale &&
+        _minimumScale == (_settings->adaptiveRenderScale ? _settings->minimumRenderScale : _settings->renderScale))
+    {
+        return;
+    }
+
+    _configuredScale = _settings->renderScale;
+    _minimumScale = _settings->adaptiveRenderScale ? _settings->minimumRenderScale : _configuredScale;
+    _probeWindows = MinProbeWindows;
+    _probing = false;
+
+    SetScale(_configuredScale);
+}
+
+void RenderScaler::RecordFrame(uint64_t frameTime, uint64_t workTime, uint64_t targetFrameTime)
+{
+    if (_minimumScale >= _configuredScale || targetFrameTime == 0 || frameTime == 0)
+    {
+        return;
+    }
+
+    _windowFrames++;
+    if (static_cast<double>(frameTime) > static_cast<double>(targetFrameTime) * MissedFrameRatio)
+    {
+        _windowMissedFrames++;
+        if (static_cast<double>(workTime) <= static_cast<double>(targetFrameTime) * CpuBoundRatio)
+        {
+            _windowGpuBoundFrames++;
+        }
+    }
+
+    if (_windowFrames < WindowFrames)
+    {
+        return;
+    }
+
+    auto missedFrames = _windowMissedFrames;
+    auto gpuBoundFrames = _windowGpuBoundFrames;
+    _windowFrames = 0;
+    _windowMissedFrames = 0;
+    _windowGpuBoundFrames = 0;
+
+    if (_settleWindows > 0)
+    {
+        _settleWindows--;
+        return;
+    }
+
+    if (missedFrames > FailingFrames)
+    {
+        _goodWindows = 0;
+
+        if (_probing)
+        {
+            // The higher resolution was too much, so wait longer before the next try.
+            _probing = false;
+            _probeWindows = std::min(_probeWindows * 2, MaxProbeWindows);
+            SetScale(std::max(_minimumScale, _scale * ScaleStep));
+        }
+        else if (gpuBoundFrames > FailingFrames && _scale > _minimumScale)
+        {
+            // Only lower the resolution if the time is spent after the CPU work, i.e. on the GPU.
+            SetScale(std::max(_minimumScale, _scale * ScaleStep));
+        }
+        return;
+    }
+
+    if (_probing)
+    {
+        _probing = false;
+        _probeWindows = MinProbeWindows;
+    }
+
+    if (missedFrames > 0 || _scale >= _configuredScale)
+    {
+        _goodWindows = 0;
+        return;
+    }
+
+    _goodWindows++;
+    if (_goodWindows >= _probeWindows)
+    {
+        _probing = true;
+        SetScale(std::min(_configuredScale, _scale / ScaleStep));
+    }
+}
+
+void RenderScaler::SetScale(double scale)
+{
+    if (scale != _scale)
+    {
+        poco_debug_f1(_logger, "Changing render scale to %.0f%%.", scale * 100.0);
+    }
+
+    _scale = scale;
+    _goodWindows = 0;
+    _settleWindows = 1;
+    _windowFrames = 0;
+    _windowMissedFrames = 0;
+    _windowGpuBoundFrames = 0;
+}
+
+void RenderScaler::ApplySize()
+{
+    if (_drawableWidth <= 0 || _drawableHeight <= 0)
+    {
+        return;
+    }
+
+    int width = std::max(static_cast<int>(std::lround(_drawableWidth * _scale)), 1);
+    int height = std::max(static_cast<int>(std::lround(_drawableHeight * _scale)), 1);
+    if (width == _renderWidth && height == _renderHeight)
+    {
+        return;
+    }
+
+    _renderWidth = width;
+    _renderHeight = height;
+
+    if (_renderWidth == _drawableWidth && _renderHeight == _drawableHeight)
+    {
+        _framebuffer.Destroy();
+    }
+    else if (!_framebuffer.Create(_renderWidth, _renderHeight))
+    {
+        poco_error_f2(_logger, "Could not create a %?dx%?d render framebuffer, rendering at native resolution.",
+                      _renderWidth, _renderHeight);
+        _framebuffer.Destroy();
+        _available = false;
+        _scale = 1.0;
+        _configuredScale = 1.0;
+        _minimumScale = 1.0;
+        _renderWidth = _drawableWidth;
+        _renderHeight = _drawableHeight;
+    }
+
+    projectm_set_window_size(_projectMWrapper.ProjectM(), _renderWidth, _renderHeight);
+}
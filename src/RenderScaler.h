@@ -0,0 +1,124 @@
+#pragma once
+
+#include "OffscreenFramebuffer.h"
+#include "SettingsSnapshot.h"
+
+#include <Poco/Logger.h>
+
+#include <cstdint>
+#include <memory>
+
+class FPSLimiter;
+class ProjectMWrapper;
+
+/**
+ * @brief Renders projectM at a fraction of the window resolution and upscales the result.
+ *
+ * Fill rate is the limiting factor for many presets on high-resolution displays. If "window.renderScale" is below 1.0,
+ * projectM renders into an offscreen framebuffer of the scaled size, which is then stretched to the window with linear
+ * filtering. The UI is drawn afterwards, so it always stays at native resolution.
+ *
+ * With "window.adaptiveRenderScale" enabled, the scale is lowered in steps down to "window.minimumRenderScale" while
+ * frames miss the target frame time without being limited by the CPU. Higher resolutions are probed again after a
+ * number of frames meeting the target. If a probe fails, the next one is delayed twice as long.
+ *
+ * Requires libprojectM 4.1 or later for rendering into a framebuffer object, and isn't available with OpenGL ES.
+ */
+class RenderScaler
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param projectMWrapper The projectM wrapper.
+     * @param windowFramebuffer The framebuffer of the window's drawable area, see SDLRenderingWindow::Framebuffer().
+     */
+    RenderScaler(ProjectMWrapper& projectMWrapper, uint32_t windowFramebuffer);
+
+    /**
+     * @brief Sets the size of the window's drawable area.
+     * @param width The drawable width in pixels.
+     * @param height The drawable height in pixels.
+     */
+    void Resize(int width, int height);
+
+    /**
+     * @brief Updates the render scale from the settings and the last frame's timings.
+     *
+     * Should be called once per frame before rendering. Resizes the framebuffer and the projectM canvas if required.
+     *
+     * @param limiter The FPS limiter with the timings of the previous frame.
+     */
+    void Update(const FPSLimiter& limiter);
+
+    /**
+     * @brief Returns the framebuffer projectM should render into.
+     * @return The offscreen framebuffer name, or the window's framebuffer if rendering at native resolution.
+     */
+    uint32_t Framebuffer() const;
+
+    /**
+     * @brief Returns the size projectM currently renders at, which is the size of Framebuffer()'s contents.
+     * @param[out] width The render width in pixels.
+     * @param[out] height The render height in pixels.
+     */
+    void GetRenderSize(int& width, int& height) const;
+
+    /**
+     * @brief Upscales the rendered image into the window's framebuffer.
+     *
+     * Does nothing if projectM renders at native resolution. Leaves the window's framebuffer bound.
+     */
+    void Present();
+
+protected:
+    /**
+     * @brief Reads the render scale settings after they've been changed.
+     */
+    void ApplySettings();
+
+    /**
+     * @brief Records the frame timings for the adaptive render scale.
+     * @param frameTime The actual duration of the last frame in nanoseconds.
+     * @param workTime The time spent on the CPU in the last frame in nanoseconds.
+     * @param targetFrameTime The targeted frame time in nanoseconds.
+     */
+    void RecordFrame(uint64_t frameTime, uint64_t workTime, uint64_t targetFrameTime);
+
+    /**
+     * @brief Changes the current render scale and starts a new measurement.
+     * @param scale The new render scale.
+     */
+    void SetScale(double scale);
+
+    /**
+     * @brief Applies the current scale and drawable size to the framebuffer and projectM.
+     */
+    void ApplySize();
+
+    ProjectMWrapper& _projectMWrapper; //!< The projectM wrapper.
+
+    bool _available{false}; //!< True if offscreen rendering is supported.
+    std::shared_ptr<const SettingsSnapshot> _settings; //!< The settings snapshot the scale was last configured from.
+
+    int _drawableWidth{0}; //!< Width of the window's drawable area.
+    int _drawableHeight{0}; //!< Height of the window's drawable area.
+    int _renderWidth{0}; //!< Width projectM currently renders at.
+    int _renderHeight{0}; //!< Height projectM currently renders at.
+
+    double _configuredScale{1.0}; //!< The configured render scale, also the maximum for the adaptive scale.
+    double _minimumScale{1.0}; //!< The lowest render scale the adaptive scale may use.
+    double _scale{1.0}; //!< The currently used render scale.
+
+    uint32_t _windowFramebuffer{0}; //!< The framebuffer of the window's drawable area.
+    OffscreenFramebuffer _framebuffer; //!< Offscreen framebuffer, only created if rendering at a lower resolution.
+
+    uint32_t _windowFrames{0}; //!< Number of frames recorded in the current adaptive window.
+    uint32_t _windowMissedFrames{0}; //!< Frames in the current window which missed the target frame time.
+    uint32_t _windowGpuBoundFrames{0}; //!< Missed frames in the current window which weren't limited by the CPU.
+    uint32_t _settleWindows{0}; //!< Number of windows to ignore after a scale change.
+    uint32_t _goodWindows{0}; //!< Consecutive windows meeting the target frame time.
+    uint32_t _probeWindows{0}; //!< Good windows required before probing a higher scale.
+    bool _probing{false}; //!< True if the scale was just raised to test for headroom.
+
+    Poco::Logger& _logger{Poco::Logger::get("RenderScaler")}; //!< The class logger.
+};
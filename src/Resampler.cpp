@@ -0,0 +1,263 @@
+#include "Resampler.h"
+
+#include <Poco/String.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESAMPLER_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr uint32_t MaxPhaseCount{256}; //!< Upper limit for the number of precomputed filter phases.
+constexpr double Pi{3.14159265358979323846};
+
+/**
+ * @brief Calculates the dot product of two float vectors.
+ *
+ * The tap count is always a multiple of 8, so no scalar tail handling is required in the SIMD variants.
+ *
+ * @param samples Pointer to the first vector, may be unaligned.
+ * @param coefficients Pointer to the second vector, may be unaligned.
+ * @param count Number of elements, must be a multiple of 8.
+ * @return The dot product.
+ */
+inline float DotProduct(const float* samples, const float* coefficients, size_t count)
+{
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 sum = _mm256_setzero_ps();
+    for (size_t index = 0; index < count; index += 8)
+    {
+        sum = _mm256_fmadd_ps(_mm256_loadu_ps(samples + index), _mm256_loadu_ps(coefficients + index), sum);
+    }
+    __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    sum128 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+    sum128 = _mm_add_ss(sum128, _mm_shuffle_ps(sum128, sum128, 0x55));
+    return _mm_cvtss_f32(sum128);
+#elif defined(RESAMPLER_USE_SSE2)
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 sum2 = _mm_setzero_ps();
+    for (size_t index = 0; index < count; index += 8)
+    {
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + index), _mm_loadu_ps(coefficients + index)));
+        sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(samples + index + 4), _mm_loadu_ps(coefficients + index + 4)));
+    }
+    __m128 sum = _mm_add_ps(sum1, sum2);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t sum1 = vdupq_n_f32(0.0f);
+    float32x4_t sum2 = vdupq_n_f32(0.0f);
+    for (size_t index = 0; index < count; index += 8)
+    {
+        sum1 = vmlaq_f32(sum1, vld1q_f32(samples + index), vld1q_f32(coefficients + index));
+        sum2 = vmlaq_f32(sum2, vld1q_f32(samples + index + 4), vld1q_f32(coefficients + index + 4));
+    }
+    float32x4_t sum = vaddq_f32(sum1, sum2);
+    float32x2_t sumPair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(sumPair, sumPair), 0);
+#else
+    float sum{0.0f};
+    for (size_t index = 0; index < count; index++)
+    {
+        sum += samples[index] * coefficients[index];
+    }
+    return sum;
+#endif
+}
+
+uint32_t GreatestCommonDivisor(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        auto remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+} // namespace
+
+Resampler::Quality Resampler::QualityFromString(const std::string& name)
+{
+    if (Poco::icompare(name, "low") == 0)
+    {
+        return Quality::Low;
+    }
+
+    if (Poco::icompare(name, "high") == 0)
+    {
+        return Quality::High;
+    }
+
+    return Quality::Medium;
+}
+
+void Resampler::Configure(uint32_t inputRate, uint32_t outputRate, uint32_t channels, Quality quality)
+{
+    _channels = std::max(channels, 1U);
+
+    auto divisor = GreatestCommonDivisor(outputRate, inputRate);
+    _interpolation = outputRate / divisor;
+    _decimation = inputRate / divisor;
+    _phaseCount = std::min(_interpolation, MaxPhaseCount);
+
+    double rollOff{0.94};
+    switch (quality)
+    {
+        case Quality::Low:
+            _taps = 8;
+            rollOff = 0.90;
+            break;
+
+        case Quality::Medium:
+            _taps = 16;
+            rollOff = 0.94;
+            break;
+
+        case Quality::High:
+            _taps = 32;
+            rollOff = 0.97;
+            break;
+    }
+
+    if (Passthrough())
+    {
+        _coefficients.clear();
+    }
+    else
+    {
+        // When downsampling, the cutoff has to be lowered to the output Nyquist frequency to prevent aliasing.
+        CalculateCoefficients(std::min(1.0, static_cast<double>(outputRate) / static_cast<double>(inputRate)) * rollOff);
+    }
+
+    _history.assign(_channels, {});
+    Reset();
+}
+
+void Resampler::Reset()
+{
+    // Prime the history with silence, so the first input sample is aligned with the filter center.
+    for (auto& channelHistory : _history)
+    {
+        channelHistory.assign(_taps / 2 - 1, 0.0f);
+    }
+
+    _inputPosition = 0;
+    _phaseAccumulator = 0;
+}
+
+bool Resampler::Passthrough() const
+{
+    return _interpolation == _decimation;
+}
+
+size_t Resampler::Process(const float* input, size_t inputFrames, std::vector<float>& output)
+{
+    if (Passthrough())
+    {
+        output.assign(input, input + inputFrames * _channels);
+        return inputFrames;
+    }
+
+    for (uint32_t channel = 0; channel < _channels; channel++)
+    {
+        auto& channelHistory = _history[channel];
+        auto offset = channelHistory.size();
+        channelHistory.resize(offset + inputFrames);
+        for (size_t frame = 0; frame < inputFrames; frame++)
+        {
+            channelHistory[offset + frame] = input[frame * _channels + channel];
+        }
+    }
+
+    auto historySize = _history[0].size();
+
+    // Upper bound for the number of output frames, so the output vector is only resized once.
+    size_t maxOutputFrames{0};
+    if (historySize >= _inputPosition + _taps)
+    {
+        maxOutputFrames = (historySize - _inputPosition - _taps + 1) * _interpolation / _decimation + 1;
+    }
+    output.resize(maxOutputFrames * _channels);
+
+    size_t outputFrames{0};
+    while (_inputPosition + _taps <= historySize && outputFrames < maxOutputFrames)
+    {
+        auto phase = static_cast<size_t>(_phaseAccumulator * _phaseCount / _interpolation);
+        const float* coefficients = &_coefficients[phase * _taps];
+
+        for (uint32_t channel = 0; channel < _channels; channel++)
+        {
+            output[outputFrames * _channels + channel] = DotProduct(&_history[channel][_inputPosition], coefficients, _taps);
+        }
+        outputFrames++;
+
+        _phaseAccumulator += _decimation;
+        _inputPosition += static_cast<size_t>(_phaseAccumulator / _interpolation);
+        _phaseAccumulator %= _interpolation;
+    }
+
+    output.resize(outputFrames * _channels);
+
+    // Drop all samples that won't be used anymore. Erasing keeps the vector capacity, so no reallocation occurs
+    // once the buffers have reached their steady-state size.
+    auto consumed = std::min(_inputPosition, historySize);
+    for (auto& channelHistory : _history)
+    {
+        channelHistory.erase(channelHistory.begin(), channelHistory.begin() + consumed);
+    }
+    _inputPosition -= consumed;
+
+    return outputFrames;
+}
+
+void Resampler::CalculateCoefficients(double cutoff)
+{
+    _coefficients.resize(static_cast<size_t>(_phaseCount) * _taps);
+
+    const double halfLength = static_cast<double>(_taps) / 2.0;
+    const double center = halfLength - 1.0;
+
+    for (uint32_t phase = 0; phase < _phaseCount; phase++)
+    {
+        const double fraction = static_cast<double>(phase) / static_cast<double>(_phaseCount);
+        float* phaseCoefficients = &_coefficients[static_cast<size_t>(phase) * _taps];
+
+        double sum{0.0};
+        for (size_t tap = 0; tap < _taps; tap++)
+        {
+            // Distance of this tap from the interpolated sample position.
+            double distance = static_cast<double>(tap) - center - fraction;
+
+            double sinc{1.0};
+            if (std::abs(distance) > 1e-9)
+            {
+                sinc = std::sin(Pi * cutoff * distance) / (Pi * cutoff * distance);
+            }
+
+            // Blackman window over the full filter length.
+            double windowPosition = distance / halfLength;
+            double window = 0.42 + 0.5 * std::cos(Pi * windowPosition) + 0.08 * std::cos(2.0 * Pi * windowPosition);
+
+            double coefficient = cutoff * sinc * std::max(window, 0.0);
+            phaseCoefficients[tap] = static_cast<float>(coefficient);
+            sum += coefficient;
+        }
+
+        // Normalize each phase to unity gain, so DC and low frequencies pass through unchanged.
+        for (size_t tap = 0; tap < _taps; tap++)
+        {
+            phaseCoefficients[tap] = static_cast<float>(phaseCoefficients[tap] / sum);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Polyphase windowed-sinc sample rate converter for interleaved float PCM data.
+ *
+ * Converts audio captured at the device's native sample rate to the rate projectM expects. The conversion ratio is
+ * reduced to a fraction L/M, and one filter phase is precomputed for each of the L possible output sample positions
+ * between two input samples. If L is too large, the phases are quantized to a fixed number of steps.
+ *
+ * Samples are stored internally in planar form, so the filter kernel is a plain dot product over contiguous memory,
+ * which is vectorized using SSE2, AVX2 or NEON, depending on the target architecture.
+ *
+ * The class is not thread-safe. It's meant to be used on the consumer side of the audio capture path, e.g. the
+ * render thread.
+ */
+class Resampler
+{
+public:
+    /**
+     * Filter quality levels. Higher quality uses more filter taps and a steeper cutoff, costing more CPU time.
+     */
+    enum class Quality
+    {
+        Low,    //!< 8 taps, good enough for visualization purposes.
+        Medium, //!< 16 taps.
+        High    //!< 32 taps.
+    };
+
+    /**
+     * @brief Parses a quality level name.
+     * @param name One of "low", "medium" or "high". Case-insensitive.
+     * @return The quality level. If the name isn't recognized, Quality::Medium is returned.
+     */
+    static Quality QualityFromString(const std::string& name);
+
+    /**
+     * @brief Sets up the resampler for the given conversion and discards any buffered data.
+     * @param inputRate The sample rate of the input data in Hz.
+     * @param outputRate The sample rate of the output data in Hz.
+     * @param channels The number of interleaved channels in both input and output data.
+     * @param quality The filter quality level.
+     */
+    void Configure(uint32_t inputRate, uint32_t outputRate, uint32_t channels, Quality quality);
+
+    /**
+     * @brief Discards all buffered input samples, but keeps the current configuration.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns whether input and output rates are identical.
+     * @return True if no conversion is done and data is simply copied.
+     */
+    bool Passthrough() const;
+
+    /**
+     * @brief Converts the given input samples.
+     *
+     * Due to the filter length, some input samples are held back until enough data is available to
+     * calculate the next output sample.
+     *
+     * @param input Pointer to the interleaved input samples.
+     * @param inputFrames Number of input frames, e.g. sample count divided by channel count.
+     * @param[out] output Receives the interleaved output samples. Previous contents are replaced.
+     * @return The number of output frames stored in @a output.
+     */
+    size_t Process(const float* input, size_t inputFrames, std::vector<float>& output);
+
+private:
+    /**
+     * @brief Calculates the filter coefficients for all phases.
+     * @param cutoff The normalized cutoff frequency, relative to the input Nyquist frequency.
+     */
+    void CalculateCoefficients(double cutoff);
+
+    uint32_t _channels{0}; //!< Number of interleaved channels.
+    uint32_t _interpolation{1}; //!< Reduced conversion ratio numerator (L).
+    uint32_t _decimation{1}; //!< Reduced conversion ratio denominator (M).
+    uint32_t _phaseCount{1}; //!< Number of precomputed filter phases.
+    size_t _taps{0}; //!< Number of filter taps per phase.
+
+    std::vector<float> _coefficients; //!< Filter coefficients, _taps values per phase.
+    std::vector<std::vector<float>> _history; //!< Buffered input samples for each channel.
+
+    size_t _inputPosition{0}; //!< Index of the first history sample used for the next output sample.
+    uint64_t _phaseAccumulator{0}; //!< Fractional input position of the next output sample, in units of 1/L.
+};
@@ -1,9 +1,12 @@
 #include "SDLRenderingWindow.h"
 
+#include "FrameCapture.h"
 #include "ProjectMSDLApplication.h"
 #include "ProjectMWrapper.h"
 
 #include <Poco/Delegate.h>
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
 #include <Poco/NotificationCenter.h>
 
 #include <Poco/Util/Application.h>
@@ -12,8 +15,29 @@
 #include <GL/glew.h>
 #endif
 
+#ifdef USE_EGL
+// Don't pull in Xlib, which defines macros clashing with regular identifiers.
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <SDL2/SDL_opengl.h>
 
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+#ifdef USE_EGL
+void* EglGetProcAddress(const char* name)
+{
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+#endif
+
+} // namespace
+
 const char* SDLRenderingWindow::name() const
 {
     return "SDL2 Rendering Window";
@@ -24,8 +48,18 @@ void SDLRenderingWindow::initialize(Poco::Util::Application& app)
     auto& projectMSDLApp = dynamic_cast<ProjectMSDLApplication&>(app);
     _userConfig = projectMSDLApp.UserConfiguration();
     _config = app.config().createView("window");
+    _headless = _config->getBool("headless", false);
+    _mainThreadId = SDL_ThreadID();
+    _windowCommandEvent = SDL_RegisterEvents(1);
 
-    if (!_renderingWindow)
+    if (_headless)
+    {
+        if (_eglContext == nullptr)
+        {
+            CreateHeadlessContext();
+        }
+    }
+    else if (!_renderingWindow)
     {
         CreateSDLWindow();
     }
@@ -48,20 +82,72 @@ void SDLRenderingWindow::uninitialize()
         DestroySDLWindow();
         _renderingWindow = nullptr;
     }
+
+    if (_eglContext)
+    {
+        DestroyHeadlessContext();
+    }
 }
 
 void SDLRenderingWindow::GetDrawableSize(int& width, int& height) const
 {
+    if (_headless)
+    {
+        width = _headlessFramebuffer.Width();
+        height = _headlessFramebuffer.Height();
+        return;
+    }
+
     SDL_GL_GetDrawableSize(_renderingWindow, &width, &height);
 }
 
+WindowState SDLRenderingWindow::QueryWindowState() const
+{
+    WindowState windowState;
+    GetDrawableSize(windowState.drawableWidth, windowState.drawableHeight);
+
+    if (_headless)
+    {
+        windowState.windowWidth = windowState.drawableWidth;
+        windowState.windowHeight = windowState.drawableHeight;
+        return windowState;
+    }
+
+    SDL_GetWindowSize(_renderingWindow, &windowState.windowWidth, &windowState.windowHeight);
+    windowState.displayIndex = SDL_GetWindowDisplayIndex(_renderingWindow);
+
+    return windowState;
+}
+
 void SDLRenderingWindow::Swap() const
 {
+    if (_headless)
+    {
+        // Nothing is presented, but frames shouldn't queue up on the GPU either.
+        glFinish();
+        return;
+    }
+
     SDL_GL_SwapWindow(_renderingWindow);
 }
 
+bool SDLRenderingWindow::Headless() const
+{
+    return _headless;
+}
+
+uint32_t SDLRenderingWindow::Framebuffer() const
+{
+    return _headlessFramebuffer.Name();
+}
+
 void SDLRenderingWindow::ToggleFullscreen()
 {
+    if (!_renderingWindow || PostToMainThread(WindowCommand::ToggleFullscreen))
+    {
+        return;
+    }
+
     if (_fullscreen)
     {
         Windowed();
@@ -129,11 +215,21 @@ void SDLRenderingWindow::Windowed()
 
 void SDLRenderingWindow::ShowCursor(bool visible)
 {
+    if (!_renderingWindow || PostToMainThread(visible ? WindowCommand::ShowCursor : WindowCommand::HideCursor))
+    {
+        return;
+    }
+
     SDL_ShowCursor(visible);
 }
 
 void SDLRenderingWindow::NextDisplay()
 {
+    if (!_renderingWindow || PostToMainThread(WindowCommand::NextDisplay))
+    {
+        return;
+    }
+
     auto numDisplays = SDL_GetNumVideoDisplays();
 
     if (numDisplays < 2)
@@ -270,17 +366,7 @@ void SDLRenderingWindow::CreateSDLWindow()
     SDL_GL_MakeCurrent(_renderingWindow, _glContext);
     UpdateSwapInterval();
 
-#ifdef USE_GLEW
-    auto glewError = glewInit();
-    if (glewError != GLEW_OK)
-    {
-        auto errorMessage = "Could not initialize GLEW. Error: " + std::string(reinterpret_cast<const char*>(glewGetErrorString(glewError)));
-        poco_fatal(_logger, errorMessage);
-        throw Poco::Exception(errorMessage);
-    }
-
-    poco_debug_f1(_logger, "Initialized GLEW: %s", std::string(reinterpret_cast<const char*>(glewGetString(GLEW_VERSION))));
-#endif
+    InitializeOpenGL(&SDL_GL_GetProcAddress);
 
     if (_config->getBool("fullscreen", false))
     {
@@ -290,11 +376,6 @@ void SDLRenderingWindow::CreateSDLWindow()
     {
         Windowed();
     }
-
-    if (_logger.debug())
-    {
-        DumpOpenGLInfo();
-    }
 }
 
 void SDLRenderingWindow::DestroySDLWindow()
@@ -310,6 +391,156 @@ void SDLRenderingWindow::DestroySDLWindow()
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
 }
 
+void SDLRenderingWindow::CreateHeadlessContext()
+{
+#ifdef USE_EGL
+    if (!ProjectMWrapper::CanRenderToFramebuffer())
+    {
+        throw Poco::NotImplementedException("Headless rendering requires libprojectM 4.1 or later.");
+    }
+
+    // Needed for the event queue, which also receives SDL_QUIT on SIGINT/SIGTERM.
+    SDL_InitSubSystem(SDL_INIT_EVENTS);
+
+    // The surfaceless platform works without a display server and falls back to software rendering without a GPU.
+    EGLDisplay display{EGL_NO_DISPLAY};
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay != nullptr)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+#endif
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint majorVersion{0};
+    EGLint minorVersion{0};
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &majorVersion, &minorVersion))
+    {
+        auto errorMessage = Poco::format("Could not initialize EGL display. Error: 0x%04x", static_cast<unsigned int>(eglGetError()));
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+    _eglDisplay = display;
+
+    poco_debug_f3(_logger, "Initialized EGL %?d.%?d: %s", majorVersion, minorVersion,
+                  std::string(eglQueryString(display, EGL_VENDOR)));
+
+    // The surface type defaults to window surfaces, which surfaceless displays don't offer.
+    const EGLint configAttributes[]{
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+
+    // projectM Requires at least Core Profile 3.30 for samplers etc.
+    const EGLint contextAttributes[]{
+        EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+        EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE};
+
+    EGLConfig config{nullptr};
+    EGLint configCount{0};
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount < 1)
+    {
+        auto errorMessage = Poco::format("No EGL configuration supports desktop OpenGL. Error: 0x%04x", static_cast<unsigned int>(eglGetError()));
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+
+    auto context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        auto errorMessage = Poco::format("Could not create headless OpenGL 3.3 context. Error: 0x%04x", static_cast<unsigned int>(eglGetError()));
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+    _eglContext = context;
+
+    // Requires EGL_KHR_surfaceless_context, as there's no surface to render to.
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        auto errorMessage = Poco::format("Could not activate headless OpenGL context without a surface. Error: 0x%04x", static_cast<unsigned int>(eglGetError()));
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+
+    InitializeOpenGL(&EglGetProcAddress);
+
+    int width = std::max(_config->getInt("width", 1024), 1);
+    int height = std::max(_config->getInt("height", 768), 1);
+    if (!OffscreenFramebuffer::Available() || !_headlessFramebuffer.Create(width, height))
+    {
+        auto errorMessage = Poco::format("Could not create a %?dx%?d headless framebuffer.", width, height);
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+    OffscreenFramebuffer::Bind(_headlessFramebuffer.Name());
+
+    poco_information_f2(_logger, "Rendering headless at %?dx%?d.", width, height);
+#else
+    throw Poco::NotImplementedException("Headless rendering requires a build with EGL support.");
+#endif
+}
+
+void SDLRenderingWindow::DestroyHeadlessContext()
+{
+#ifdef USE_EGL
+    poco_debug(_logger, "Destroying headless OpenGL context.");
+
+    _headlessFramebuffer.Destroy();
+
+    eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(_eglDisplay, _eglContext);
+    eglTerminate(_eglDisplay);
+    _eglContext = nullptr;
+    _eglDisplay = nullptr;
+
+    SDL_QuitSubSystem(SDL_INIT_EVENTS);
+#endif
+}
+
+void SDLRenderingWindow::InitializeOpenGL(OffscreenFramebuffer::ProcAddressFunction getProcAddress)
+{
+#ifdef USE_GLEW
+    auto glewError = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW tries to load GLX extensions, which isn't possible without an X display, e.g. in headless mode.
+    if (glewError == GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        glewError = GLEW_OK;
+    }
+#endif
+    if (glewError != GLEW_OK)
+    {
+        auto errorMessage = "Could not initialize GLEW. Error: " + std::string(reinterpret_cast<const char*>(glewGetErrorString(glewError)));
+        poco_fatal(_logger, errorMessage);
+        throw Poco::Exception(errorMessage);
+    }
+
+    poco_debug_f1(_logger, "Initialized GLEW: %s", std::string(reinterpret_cast<const char*>(glewGetString(GLEW_VERSION))));
+#endif
+
+    if (!OffscreenFramebuffer::LoadFunctions(getProcAddress))
+    {
+        poco_debug(_logger, "OpenGL framebuffer functions are not available.");
+    }
+
+    if (!FrameCapture::LoadFunctions(getProcAddress))
+    {
+        poco_debug(_logger, "OpenGL pixel buffer and sync functions are not available, frames will be captured synchronously.");
+    }
+
+    if (_logger.debug())
+    {
+        DumpOpenGLInfo();
+    }
+}
+
 void SDLRenderingWindow::DumpOpenGLInfo()
 {
     poco_debug_f1(_logger, "- GL_VERSION: %s", std::string(reinterpret_cast<const char*>(glGetString(GL_VERSION))));
@@ -354,6 +585,12 @@ int SDLRenderingWindow::GetCurrentDisplay()
 
 void SDLRenderingWindow::GetWindowSize(int& width, int& height)
 {
+    if (_headless)
+    {
+        GetDrawableSize(width, height);
+        return;
+    }
+
     SDL_GetWindowSize(_renderingWindow, &width, &height);
 }
 
@@ -372,6 +609,108 @@ void SDLRenderingWindow::GetWindowPosition(int& left, int& top, bool relative)
     top -= bounds.y;
 }
 
+void SDLRenderingWindow::StoreWindowPlacement()
+{
+    if (!_renderingWindow || PostToMainThread(WindowCommand::StoreWindowPlacement))
+    {
+        return;
+    }
+
+    int x;
+    int y;
+
+    GetWindowSize(x, y);
+    _userConfig->setInt("window.width", x);
+    _userConfig->setInt("window.height", y);
+
+    GetWindowPosition(x, y, true);
+    _userConfig->setInt("window.left", x);
+    _userConfig->setInt("window.top", y);
+
+    _userConfig->setBool("window.overridePosition", true);
+    _userConfig->setInt("window.monitor", GetCurrentDisplay() + 1);
+}
+
+void SDLRenderingWindow::MakeContextCurrent(bool current)
+{
+#ifdef USE_EGL
+    if (_headless)
+    {
+        eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, current ? _eglContext : EGL_NO_CONTEXT);
+        return;
+    }
+#endif
+
+    SDL_GL_MakeCurrent(_renderingWindow, current ? _glContext : nullptr);
+}
+
+bool SDLRenderingWindow::HandleWindowCommand(const SDL_Event& event)
+{
+    if (_windowCommandEvent == static_cast<Uint32>(-1) || event.type != _windowCommandEvent)
+    {
+        return false;
+    }
+
+    std::unique_ptr<std::string> argument(static_cast<std::string*>(event.user.data1));
+
+    switch (static_cast<WindowCommand>(event.user.code))
+    {
+        case WindowCommand::ToggleFullscreen:
+            ToggleFullscreen();
+            break;
+
+        case WindowCommand::NextDisplay:
+            NextDisplay();
+            break;
+
+        case WindowCommand::ShowCursor:
+        case WindowCommand::HideCursor:
+            ShowCursor(static_cast<WindowCommand>(event.user.code) == WindowCommand::ShowCursor);
+            break;
+
+        case WindowCommand::SetTitle:
+            if (_renderingWindow && argument)
+            {
+                SDL_SetWindowTitle(_renderingWindow, argument->c_str());
+            }
+            break;
+
+        case WindowCommand::UpdateBorder:
+            OnConfigurationPropertyRemoved("window.borderless");
+            break;
+
+        case WindowCommand::StoreWindowPlacement:
+            StoreWindowPlacement();
+            break;
+    }
+
+    return true;
+}
+
+bool SDLRenderingWindow::PostToMainThread(WindowCommand command, const std::string& argument)
+{
+    if (SDL_ThreadID() == _mainThreadId || _windowCommandEvent == static_cast<Uint32>(-1))
+    {
+        return false;
+    }
+
+    SDL_Event event{};
+    event.type = _windowCommandEvent;
+    event.user.code = static_cast<Sint32>(command);
+    if (command == WindowCommand::SetTitle)
+    {
+        event.user.data1 = new std::string(argument);
+    }
+
+    if (SDL_PushEvent(&event) != 1)
+    {
+        delete static_cast<std::string*>(event.user.data1);
+        poco_debug_f1(_logger, "Could not post window command to the main thread: %s", std::string(SDL_GetError()));
+    }
+
+    return true;
+}
+
 SDL_Window* SDLRenderingWindow::GetRenderingWindow() const
 {
     return _renderingWindow;
@@ -389,6 +728,11 @@ void SDLRenderingWindow::UpdateWindowTitleNotificationHandler(POCO_UNUSED const
 
 void SDLRenderingWindow::UpdateWindowTitle()
 {
+    if (!_renderingWindow)
+    {
+        return;
+    }
+
     std::string newTitle = "projectM";
 
     if (_config->getBool("displayPresetNameInTitle", true))
@@ -396,7 +740,7 @@ void SDLRenderingWindow::UpdateWindowTitle()
         auto& app = Poco::Util::Application::instance();
         auto& projectMWrapper = app.getSubsystem<ProjectMWrapper>();
 
-        auto presetName = projectm_playlist_item(projectMWrapper.Playlist(), projectm_playlist_get_position(projectMWrapper.Playlist()));
+        auto presetName = projectm_playlist_item(projectMWrapper.Playlist(), projectMWrapper.CurrentPresetIndex());
 
         if (presetName)
         {
@@ -412,6 +756,11 @@ void SDLRenderingWindow::UpdateWindowTitle()
         }
     }
 
+    if (PostToMainThread(WindowCommand::SetTitle, newTitle))
+    {
+        return;
+    }
+
     SDL_SetWindowTitle(_renderingWindow, newTitle.c_str());
 }
 
@@ -451,7 +800,7 @@ void SDLRenderingWindow::OnConfigurationPropertyRemoved(const std::string& key)
         UpdateSwapInterval();
     }
 
-    if (key == "window.borderless")
+    if (key == "window.borderless" && !PostToMainThread(WindowCommand::UpdateBorder))
     {
         SDL_SetWindowBordered(_renderingWindow, _config->getBool("borderless", false) ? SDL_FALSE : SDL_TRUE);
     }
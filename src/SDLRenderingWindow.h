@@ -1,5 +1,8 @@
 #pragma once
 
+#include "OffscreenFramebuffer.h"
+#include "WindowState.h"
+
 #include "notifications/UpdateWindowTitleNotification.h"
 
 #include <SDL2/SDL.h>
@@ -10,6 +13,8 @@
 #include <Poco/Util/Subsystem.h>
 #include <Poco/Util/AbstractConfiguration.h>
 
+#include <string>
+
 struct projectm;
 
 class SDLRenderingWindow : public Poco::Util::Subsystem
@@ -32,11 +37,38 @@ public:
      */
     void GetDrawableSize(int& width, int& height) const;
 
+    /**
+     * @brief Queries the current window geometry.
+     *
+     * Must only be called on the main thread. The render thread receives the state via the EventQueue.
+     *
+     * @return The current window state.
+     */
+    WindowState QueryWindowState() const;
+
     /**
      * Swaps the OpenGL front- and back buffers.
+     *
+     * In headless mode, waits for the GPU to finish the frame instead.
      */
     void Swap() const;
 
+    /**
+     * @brief Returns whether rendering happens without a window.
+     *
+     * In headless mode, an OpenGL context is created via EGL without any window or display server, and all frames
+     * are rendered into an offscreen framebuffer of the configured window size. There is no UI and no input.
+     *
+     * @return True if running in headless mode.
+     */
+    bool Headless() const;
+
+    /**
+     * @brief Returns the framebuffer which represents the window's drawable area.
+     * @return 0 for the window's default framebuffer, or the offscreen framebuffer in headless mode.
+     */
+    uint32_t Framebuffer() const;
+
     /**
      * @brief Toggles the window's fullscreen mode.
      *
@@ -92,11 +124,59 @@ public:
      */
     void GetWindowPosition(int& left, int& top, bool relative = false);
 
+    /**
+     * @brief Stores the current window size, position and display as startup placement in the user configuration.
+     */
+    void StoreWindowPlacement();
+
+    /**
+     * @brief Makes the OpenGL context current on the calling thread, or releases it.
+     *
+     * A context can only be current on one thread at a time, so it must be released before another thread can
+     * take it over.
+     *
+     * @param current If true, binds the context to the calling thread, otherwise releases it.
+     */
+    void MakeContextCurrent(bool current);
+
+    /**
+     * @brief Executes a window command which was posted to the main thread.
+     *
+     * Window management functions must only be called from the thread which created the window. If ToggleFullscreen(),
+     * ShowCursor(), NextDisplay(), StoreWindowPlacement() or a title update are called from another thread, e.g. the render thread, they are
+     * posted as an SDL user event instead. The main thread's event loop has to pass all events to this method.
+     *
+     * @param event The SDL event.
+     * @return True if the event was a window command and has been handled.
+     */
+    bool HandleWindowCommand(const SDL_Event& event);
+
     SDL_Window* GetRenderingWindow() const;
 
     SDL_GLContext GetGlContext() const;
 
 protected:
+    /**
+     * @brief Window operations which can be posted to the main thread.
+     */
+    enum class WindowCommand : Sint32
+    {
+        ToggleFullscreen,
+        NextDisplay,
+        ShowCursor,
+        HideCursor,
+        SetTitle,
+        UpdateBorder,
+        StoreWindowPlacement
+    };
+
+    /**
+     * @brief Posts a window command to the main thread if called from any other thread.
+     * @param command The command to execute.
+     * @param argument Command argument, only used by SetTitle.
+     * @return True if the command was posted, false if the caller is on the main thread and has to execute it.
+     */
+    bool PostToMainThread(WindowCommand command, const std::string& argument = {});
 
     /**
      * Creates the SDL rendering window and an OpenGL rendering context.
@@ -108,6 +188,22 @@ protected:
      */
     void DestroySDLWindow();
 
+    /**
+     * @brief Creates a windowless EGL rendering context and the offscreen framebuffer for headless mode.
+     */
+    void CreateHeadlessContext();
+
+    /**
+     * @brief Destroys the headless rendering context and framebuffer.
+     */
+    void DestroyHeadlessContext();
+
+    /**
+     * @brief Initializes OpenGL function pointers for the current context.
+     * @param getProcAddress The function used to look up OpenGL functions in the current context.
+     */
+    void InitializeOpenGL(OffscreenFramebuffer::ProcAddressFunction getProcAddress);
+
     /**
      * Prints OpenGL debug information.
      */
@@ -147,6 +243,11 @@ protected:
     SDL_Window* _renderingWindow{ nullptr }; //!< Pointer to the SDL window used for rendering.
     SDL_GLContext _glContext{ nullptr }; //!< Pointer to the OpenGL context associated with the window.
 
+    bool _headless{ false }; //!< True if rendering without a window.
+    OffscreenFramebuffer _headlessFramebuffer; //!< Framebuffer replacing the window's drawable area in headless mode.
+    void* _eglDisplay{ nullptr }; //!< The EGLDisplay of the headless context.
+    void* _eglContext{ nullptr }; //!< The EGLContext used in headless mode.
+
     Poco::NObserver<SDLRenderingWindow, UpdateWindowTitleNotification> _updateWindowTitleObserver{*this, &SDLRenderingWindow::UpdateWindowTitleNotificationHandler}; //!< the observer for title update notifications
 
     Poco::Logger& _logger{ Poco::Logger::get("SDLRenderingWindow") }; //!< The class logger.
@@ -156,6 +257,9 @@ protected:
 
     bool _fullscreen{ false };
 
+    SDL_threadID _mainThreadId{ 0 }; //!< ID of the thread which created the window.
+    Uint32 _windowCommandEvent{ 0 }; //!< SDL user event type used to post window commands to the main thread.
+
 };
 
 
@@ -0,0 +1,454 @@
+#include "SampleConverter.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/String.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SAMPLECONVERTER_USE_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SAMPLECONVERTER_USE_NEON
+#endif
+
+namespace {
+
+using Format = SampleConverter::Format;
+
+constexpr float S16Scale{1.0f / 32768.0f};
+constexpr float S32Scale{1.0f / 2147483648.0f};
+
+/**
+ * Number of samples converted to float at once before downmixing. The buffer lives on the stack.
+ */
+constexpr size_t ScratchSamples{2048};
+
+constexpr float Center{0.7071f}; //!< -3 dB
+constexpr float Lfe{0.5f};       //!< -6 dB
+
+/**
+ * Downmix coefficients for the left and right output channel, by input channel count, in SDL/WAVE channel order.
+ * Rows are normalized in NormalizedCoefficient().
+ */
+const float DownmixMatrix[SampleConverter::MaxChannels + 1][2][SampleConverter::MaxChannels]{
+    {},
+    // Mono
+    {{1.0f}, {1.0f}},
+    // Stereo
+    {{1.0f, 0.0f}, {0.0f, 1.0f}},
+    // 2.1: FL FR LFE
+    {{1.0f, 0.0f, Lfe}, {0.0f, 1.0f, Lfe}},
+    // Quad: FL FR BL BR
+    {{1.0f, 0.0f, Center, 0.0f}, {0.0f, 1.0f, 0.0f, Center}},
+    // 4.1: FL FR LFE BL BR
+    {{1.0f, 0.0f, Lfe, Center, 0.0f}, {0.0f, 1.0f, Lfe, 0.0f, Center}},
+    // 5.1: FL FR FC LFE BL BR
+    {{1.0f, 0.0f, Center, Lfe, Center, 0.0f}, {0.0f, 1.0f, Center, Lfe, 0.0f, Center}},
+    // 6.1: FL FR FC LFE BC SL SR
+    {{1.0f, 0.0f, Center, Lfe, Lfe, Center, 0.0f}, {0.0f, 1.0f, Center, Lfe, Lfe, 0.0f, Center}},
+    // 7.1: FL FR FC LFE BL BR SL SR
+    {{1.0f, 0.0f, Center, Lfe, Center, 0.0f, Center, 0.0f}, {0.0f, 1.0f, Center, Lfe, 0.0f, Center, 0.0f, Center}}};
+
+/**
+ * @brief Returns the downmix coefficient, scaled so each output row sums up to one.
+ */
+inline float NormalizedCoefficient(uint32_t channels, uint32_t side, uint32_t channel)
+{
+    float sum{0.0f};
+    for (uint32_t index = 0; index < channels; index++)
+    {
+        sum += DownmixMatrix[channels][side][index];
+    }
+    return DownmixMatrix[channels][side][channel] / sum;
+}
+
+void ConvertS16(const int16_t* input, size_t samples, float* output)
+{
+    size_t sample{0};
+
+#if defined(SAMPLECONVERTER_USE_SSE2)
+    const __m128 scale = _mm_set1_ps(S16Scale);
+    for (; sample + 8 <= samples; sample += 8)
+    {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + sample));
+        // Sign-extend by moving the 16-bit values into the upper half of each 32-bit lane.
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+        _mm_storeu_ps(output + sample, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(output + sample + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#elif defined(SAMPLECONVERTER_USE_NEON)
+    for (; sample + 8 <= samples; sample += 8)
+    {
+        int16x8_t values = vld1q_s16(input + sample);
+        vst1q_f32(output + sample, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(values))), S16Scale));
+        vst1q_f32(output + sample + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(values))), S16Scale));
+    }
+#endif
+
+    for (; sample < samples; sample++)
+    {
+        output[sample] = static_cast<float>(input[sample]) * S16Scale;
+    }
+}
+
+void ConvertS24(const uint8_t* input, size_t samples, float* output)
+{
+    size_t sample{0};
+
+#if defined(SAMPLECONVERTER_USE_SSE2) && defined(__SSSE3__)
+    // Moves each 3-byte sample into the upper three bytes of a 32-bit lane, which also takes care of the sign.
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128 scale = _mm_set1_ps(S32Scale);
+    // Each load reads 16 bytes, but only uses 12, so stop early enough not to read past the end.
+    for (; sample + 6 <= samples; sample += 4)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + sample * 3));
+        __m128i values = _mm_shuffle_epi8(bytes, shuffle);
+        _mm_storeu_ps(output + sample, _mm_mul_ps(_mm_cvtepi32_ps(values), scale));
+    }
+#endif
+
+    for (; sample < samples; sample++)
+    {
+        auto value = static_cast<int32_t>((static_cast<uint32_t>(input[sample * 3]) << 8) |
+                                          (static_cast<uint32_t>(input[sample * 3 + 1]) << 16) |
+                                          (static_cast<uint32_t>(input[sample * 3 + 2]) << 24));
+        output[sample] = static_cast<float>(value) * S32Scale;
+    }
+}
+
+void ConvertS32(const int32_t* input, size_t samples, float* output)
+{
+    size_t sample{0};
+
+#if defined(SAMPLECONVERTER_USE_SSE2)
+    const __m128 scale = _mm_set1_ps(S32Scale);
+    for (; sample + 4 <= samples; sample += 4)
+    {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + sample));
+        _mm_storeu_ps(output + sample, _mm_mul_ps(_mm_cvtepi32_ps(values), scale));
+    }
+#elif defined(SAMPLECONVERTER_USE_NEON)
+    for (; sample + 4 <= samples; sample += 4)
+    {
+        vst1q_f32(output + sample, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(input + sample)), S32Scale));
+    }
+#endif
+
+    for (; sample < samples; sample++)
+    {
+        output[sample] = static_cast<float>(input[sample]) * S32Scale;
+    }
+}
+
+template<Format SampleFormat>
+void ConvertBlock(const void* input, size_t samples, float* output);
+
+template<>
+void ConvertBlock<Format::S16>(const void* input, size_t samples, float* output)
+{
+    ConvertS16(static_cast<const int16_t*>(input), samples, output);
+}
+
+template<>
+void ConvertBlock<Format::S24>(const void* input, size_t samples, float* output)
+{
+    ConvertS24(static_cast<const uint8_t*>(input), samples, output);
+}
+
+template<>
+void ConvertBlock<Format::S32>(const void* input, size_t samples, float* output)
+{
+    ConvertS32(static_cast<const int32_t*>(input), samples, output);
+}
+
+template<>
+void ConvertBlock<Format::F32>(const void* input, size_t samples, float* output)
+{
+    std::memcpy(output, input, samples * sizeof(float));
+}
+
+/**
+ * @brief Downmixes a block of float samples with a fixed channel count to stereo.
+ */
+template<uint32_t Channels>
+void DownmixBlock(const float* input, size_t frames, float* output)
+{
+    float left[Channels];
+    float right[Channels];
+    for (uint32_t channel = 0; channel < Channels; channel++)
+    {
+        left[channel] = NormalizedCoefficient(Channels, 0, channel);
+        right[channel] = NormalizedCoefficient(Channels, 1, channel);
+    }
+
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        float leftSum{0.0f};
+        float rightSum{0.0f};
+        for (uint32_t channel = 0; channel < Channels; channel++)
+        {
+            leftSum += input[channel] * left[channel];
+            rightSum += input[channel] * right[channel];
+        }
+        output[0] = leftSum;
+        output[1] = rightSum;
+
+        input += Channels;
+        output += 2;
+    }
+}
+
+template<>
+void DownmixBlock<1>(const float* input, size_t frames, float* output)
+{
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        output[frame * 2] = input[frame];
+        output[frame * 2 + 1] = input[frame];
+    }
+}
+
+/**
+ * @brief Kernel for a fixed format and channel count.
+ */
+template<Format SampleFormat, uint32_t Channels>
+void ConvertAndDownmix(const void* input, size_t frames, uint32_t, float* output)
+{
+    // Stereo data only needs to be converted.
+    if (Channels == 2)
+    {
+        ConvertBlock<SampleFormat>(input, frames * 2, output);
+        return;
+    }
+
+    float scratch[ScratchSamples];
+    constexpr size_t blockFrames{ScratchSamples / Channels};
+
+    auto inputBytes = static_cast<const uint8_t*>(input);
+    const size_t bytesPerFrame = SampleConverter::BytesPerSample(SampleFormat) * Channels;
+
+    for (size_t frame = 0; frame < frames; frame += blockFrames)
+    {
+        size_t count = std::min(blockFrames, frames - frame);
+        ConvertBlock<SampleFormat>(inputBytes + frame * bytesPerFrame, count * Channels, scratch);
+        DownmixBlock<Channels>(scratch, count, output + frame * 2);
+    }
+}
+
+/**
+ * @brief Sums up the even and odd samples of a frame separately.
+ * @param samples The frame's samples.
+ * @param pairs Number of sample pairs to sum up.
+ * @param leftSum Receives the sum of all even samples.
+ * @param rightSum Receives the sum of all odd samples.
+ */
+inline void SumChannelPairs(const float* samples, uint32_t pairs, float& leftSum, float& rightSum)
+{
+    uint32_t pair{0};
+
+#if defined(SAMPLECONVERTER_USE_SSE2)
+    // Two pairs per vector: L0 R0 L1 R1, folded into the lower half at the end.
+    __m128 sums = _mm_setzero_ps();
+    for (; pair + 2 <= pairs; pair += 2)
+    {
+        sums = _mm_add_ps(sums, _mm_loadu_ps(samples + pair * 2));
+    }
+    sums = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+    leftSum = _mm_cvtss_f32(sums);
+    rightSum = _mm_cvtss_f32(_mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 1, 1, 1)));
+#elif defined(SAMPLECONVERTER_USE_NEON)
+    float32x4_t sums = vdupq_n_f32(0.0f);
+    for (; pair + 2 <= pairs; pair += 2)
+    {
+        sums = vaddq_f32(sums, vld1q_f32(samples + pair * 2));
+    }
+    float32x2_t folded = vadd_f32(vget_low_f32(sums), vget_high_f32(sums));
+    leftSum = vget_lane_f32(folded, 0);
+    rightSum = vget_lane_f32(folded, 1);
+#else
+    leftSum = 0.0f;
+    rightSum = 0.0f;
+#endif
+
+    for (; pair < pairs; pair++)
+    {
+        leftSum += samples[pair * 2];
+        rightSum += samples[pair * 2 + 1];
+    }
+}
+
+/**
+ * @brief Fallback kernel for layouts with more than MaxChannels channels.
+ *
+ * Mixes all even channels into the left and all odd channels into the right output channel. With an odd channel
+ * count, the last channel has no partner and is mixed into both sides.
+ */
+template<Format SampleFormat>
+void ConvertAndDownmixGeneric(const void* input, size_t frames, uint32_t channels, float* output)
+{
+    static_assert(ScratchSamples >= SampleConverter::MaxInputChannels, "The scratch buffer must hold at least one frame");
+
+    float scratch[ScratchSamples];
+    const size_t blockFrames = ScratchSamples / channels;
+
+    auto inputBytes = static_cast<const uint8_t*>(input);
+    const size_t bytesPerFrame = SampleConverter::BytesPerSample(SampleFormat) * channels;
+    const uint32_t pairs = channels / 2;
+    const bool lastChannelUnpaired = (channels & 1) != 0;
+    // Both sides sum up the same number of channels.
+    const float scale = 1.0f / static_cast<float>((channels + 1) / 2);
+
+    for (size_t frame = 0; frame < frames; frame += blockFrames)
+    {
+        size_t count = std::min(blockFrames, frames - frame);
+        ConvertBlock<SampleFormat>(inputBytes + frame * bytesPerFrame, count * channels, scratch);
+
+        for (size_t blockFrame = 0; blockFrame < count; blockFrame++)
+        {
+            const float* frameSamples = scratch + blockFrame * channels;
+            float leftSum;
+            float rightSum;
+            SumChannelPairs(frameSamples, pairs, leftSum, rightSum);
+            if (lastChannelUnpaired)
+            {
+                leftSum += frameSamples[channels - 1];
+                rightSum += frameSamples[channels - 1];
+            }
+            output[(frame + blockFrame) * 2] = leftSum * scale;
+            output[(frame + blockFrame) * 2 + 1] = rightSum * scale;
+        }
+    }
+}
+
+template<Format SampleFormat>
+SampleConverter::Kernel KernelForChannels(uint32_t channels)
+{
+    switch (channels)
+    {
+        case 1:
+            return &ConvertAndDownmix<SampleFormat, 1>;
+        case 2:
+            return &ConvertAndDownmix<SampleFormat, 2>;
+        case 3:
+            return &ConvertAndDownmix<SampleFormat, 3>;
+        case 4:
+            return &ConvertAndDownmix<SampleFormat, 4>;
+        case 5:
+            return &ConvertAndDownmix<SampleFormat, 5>;
+        case 6:
+            return &ConvertAndDownmix<SampleFormat, 6>;
+        case 7:
+            return &ConvertAndDownmix<SampleFormat, 7>;
+        case 8:
+            return &ConvertAndDownmix<SampleFormat, 8>;
+        default:
+            return &ConvertAndDownmixGeneric<SampleFormat>;
+    }
+}
+
+} // namespace
+
+SampleConverter::Format SampleConverter::FormatFromString(const std::string& name)
+{
+    if (Poco::icompare(name, "s16") == 0)
+    {
+        return Format::S16;
+    }
+
+    if (Poco::icompare(name, "s24") == 0)
+    {
+        return Format::S24;
+    }
+
+    if (Poco::icompare(name, "s32") == 0)
+    {
+        return Format::S32;
+    }
+
+    return Format::F32;
+}
+
+size_t SampleConverter::BytesPerSample(Format format)
+{
+    switch (format)
+    {
+        case Format::S16:
+            return 2;
+        case Format::S24:
+            return 3;
+        case Format::S32:
+        case Format::F32:
+        default:
+            return 4;
+    }
+}
+
+void SampleConverter::ConvertToFloat(Format format, const void* input, size_t samples, float* output)
+{
+    switch (format)
+    {
+        case Format::S16:
+            ConvertBlock<Format::S16>(input, samples, output);
+            break;
+        case Format::S24:
+            ConvertBlock<Format::S24>(input, samples, output);
+            break;
+        case Format::S32:
+            ConvertBlock<Format::S32>(input, samples, output);
+            break;
+        case Format::F32:
+            ConvertBlock<Format::F32>(input, samples, output);
+            break;
+    }
+}
+
+void SampleConverter::Configure(Format format, uint32_t channels)
+{
+    if (channels > MaxInputChannels)
+    {
+        throw Poco::InvalidArgumentException(Poco::format("Unsupported channel count %?u, at most %?u channels are supported",
+                                                          channels, MaxInputChannels));
+    }
+
+    _channels = std::max(channels, 1U);
+
+    switch (format)
+    {
+        case Format::S16:
+            _kernel = KernelForChannels<Format::S16>(_channels);
+            break;
+        case Format::S24:
+            _kernel = KernelForChannels<Format::S24>(_channels);
+            break;
+        case Format::S32:
+            _kernel = KernelForChannels<Format::S32>(_channels);
+            break;
+        case Format::F32:
+            _kernel = KernelForChannels<Format::F32>(_channels);
+            break;
+    }
+}
+
+void SampleConverter::Process(const void* input, size_t frames, float* output) const
+{
+    if (_kernel == nullptr || frames == 0)
+    {
+        return;
+    }
+
+    _kernel(input, frames, _channels, output);
+}
+
+uint32_t SampleConverter::Channels() const
+{
+    return _channels;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Converts interleaved integer or float PCM data with any channel count to interleaved stereo float samples.
+ *
+ * A kernel is instantiated at compile time for each combination of sample format and channel count up to
+ * MaxChannels, so the inner loops are fully unrolled. The sample format conversion uses SSE2, SSSE3 or NEON if
+ * available on the target architecture. Layouts with more channels use a generic kernel.
+ *
+ * Downmixing follows the SDL/WAVE channel order. Center and surround channels are mixed into both sides at -3 dB,
+ * the LFE channel at -6 dB. Each output channel is normalized, so it never exceeds full scale.
+ *
+ * Processing doesn't allocate any memory, so it's safe to call from audio callbacks.
+ */
+class SampleConverter
+{
+public:
+    /**
+     * Supported sample formats, all in native byte order.
+     */
+    enum class Format
+    {
+        S16, //!< Signed 16-bit integer.
+        S24, //!< Signed 24-bit integer, packed into three bytes.
+        S32, //!< Signed 32-bit integer. Also used for 24-bit data in 32-bit containers, which is MSB-aligned.
+        F32  //!< 32-bit float.
+    };
+
+    /**
+     * Highest channel count with specialized kernels. Up to 7.1 surround.
+     */
+    static constexpr uint32_t MaxChannels{8};
+
+    /**
+     * Highest supported input channel count. Decoders and capture backends must reject streams with more channels.
+     */
+    static constexpr uint32_t MaxInputChannels{256};
+
+    /**
+     * @brief Parses a sample format name.
+     * @param name One of "s16", "s24", "s32" or "f32". Case-insensitive.
+     * @return The sample format. If the name isn't recognized, Format::F32 is returned.
+     */
+    static Format FormatFromString(const std::string& name);
+
+    /**
+     * @brief Returns the size of a single sample in the given format.
+     * @param format The sample format.
+     * @return The size of one sample in bytes.
+     */
+    static size_t BytesPerSample(Format format);
+
+    /**
+     * @brief Converts samples to float without changing the channel layout.
+     * @param format The input sample format.
+     * @param input Pointer to the input samples.
+     * @param samples Number of samples, e.g. frames times channels.
+     * @param output Receives the float samples.
+     */
+    static void ConvertToFloat(Format format, const void* input, size_t samples, float* output);
+
+    /**
+     * @brief Selects the kernel for the given input format.
+     * @param format The input sample format.
+     * @throws Poco::InvalidArgumentException if channels is greater than MaxInputChannels.
+     * @param channels The number of interleaved input channels. Must be at least 1.
+     */
+    void Configure(Format format, uint32_t channels);
+
+    /**
+     * @brief Converts and downmixes the given input frames to stereo.
+     * @param input Pointer to the interleaved input samples.
+     * @param frames Number of input frames.
+     * @param output Receives the interleaved stereo samples. Must hold twice the number of frames.
+     */
+    void Process(const void* input, size_t frames, float* output) const;
+
+    /**
+     * @brief Returns the configured channel count.
+     * @return The number of interleaved input channels.
+     */
+    uint32_t Channels() const;
+
+    /**
+     * @brief Kernel function type.
+     */
+    using Kernel = void (*)(const void* input, size_t frames, uint32_t channels, float* output);
+
+private:
+    Kernel _kernel{nullptr}; //!< The selected conversion kernel.
+    uint32_t _channels{2}; //!< Number of interleaved input channels.
+};
@@ -0,0 +1,22 @@
+#include "SettingsSnapshot.h"
+
+#include <algorithm>
+
+SettingsSnapshot SettingsSnapshot::FromConfiguration(const Poco::Util::AbstractConfiguration& config)
+{
+    SettingsSnapshot snapshot;
+
+    snapshot.targetFps = config.getInt("projectM.fps", 60);
+    snapshot.meshX = config.getUInt64("projectM.meshX", 220);
+    snapshot.meshY = config.getUInt64("projectM.meshY", 125);
+    snapshot.adaptiveMeshSize = config.getBool("projectM.adaptiveMeshSize", false);
+    snapshot.renderScale = std::min(std::max(config.getDouble("window.renderScale", 1.0), 0.25), 1.0);
+    snapshot.adaptiveRenderScale = config.getBool("window.adaptiveRenderScale", false);
+    snapshot.minimumRenderScale = std::min(std::max(config.getDouble("window.minimumRenderScale", 0.5), 0.25), snapshot.renderScale);
+    snapshot.presetLocked = config.getBool("projectM.presetLocked", false);
+    snapshot.shuffleEnabled = config.getBool("projectM.shuffleEnabled", true);
+    snapshot.displayToasts = config.getBool("projectM.displayToasts", true);
+    snapshot.displayPresetNameInTitle = config.getBool("window.displayPresetNameInTitle", true);
+
+    return snapshot;
+}
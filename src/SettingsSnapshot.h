@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Poco/Util/AbstractConfiguration.h>
+
+#include <cstddef>
+
+/**
+ * @brief Typed, immutable copy of the settings read on every frame.
+ *
+ * Looking up a value in Poco's layered configuration walks all layers by string key and parses the value text, which
+ * is measurable at high frame rates. Instead, the render loop and GUI read plain fields from a snapshot which is only
+ * rebuilt when a setting is changed. See ProjectMWrapper::Settings().
+ */
+struct SettingsSnapshot
+{
+    int targetFps{60}; //!< Target frames per second. 0 means unlimited.
+    size_t meshX{220}; //!< Horizontal per-pixel mesh size.
+    size_t meshY{125}; //!< Vertical per-pixel mesh size.
+    bool adaptiveMeshSize{false}; //!< If true, the mesh size is reduced while frames miss their deadline.
+    double renderScale{1.0}; //!< Render resolution as a fraction of the drawable size.
+    bool adaptiveRenderScale{false}; //!< If true, the render resolution is lowered while frames miss their deadline.
+    double minimumRenderScale{0.5}; //!< Lowest render scale used by the adaptive render scale.
+    bool presetLocked{false}; //!< If true, presets aren't switched automatically.
+    bool shuffleEnabled{true}; //!< If true, the playlist is shuffled.
+    bool displayToasts{true}; //!< If true, toast messages are displayed.
+    bool displayPresetNameInTitle{true}; //!< If true, the current preset name is shown in the window title.
+
+    /**
+     * @brief Reads all snapshot values from the given configuration.
+     * @param config The effective, layered application configuration.
+     * @return A new snapshot with the current values.
+     */
+    static SettingsSnapshot FromConfiguration(const Poco::Util::AbstractConfiguration& config);
+};
@@ -0,0 +1,207 @@
+#include "SharedMemoryFrameOutput.h"
+
+#include <Poco/Exception.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Rounds a size up to a multiple of the given alignment.
+ */
+size_t AlignUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+SharedMemoryFrameOutput::SharedMemoryFrameOutput(const std::string& name, int maxWidth, int maxHeight, uint32_t slotCount)
+    : _name(name)
+{
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                  "Atomics in shared memory must be lock-free to work across processes.");
+
+    slotCount = std::max(slotCount, 2u);
+    auto slotCapacity = static_cast<size_t>(std::max(maxWidth, 1)) * static_cast<size_t>(std::max(maxHeight, 1)) * 4;
+
+    // Page-align the pixel data, so readers can map or upload it efficiently.
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto headersSize = AlignUp(sizeof(SharedFrameHeader) + slotCount * sizeof(SharedFrameSlot), pageSize);
+    auto alignedSlotCapacity = AlignUp(slotCapacity, pageSize);
+    _size = headersSize + slotCount * alignedSlotCapacity;
+
+    int fileDescriptor = CreateObject();
+
+    if (ftruncate(fileDescriptor, static_cast<off_t>(_size)) != 0)
+    {
+        auto error = errno;
+        close(fileDescriptor);
+        shm_unlink(_name.c_str());
+        throw Poco::SystemException("Could not resize shared memory object " + _name, std::strerror(error));
+    }
+
+    auto memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (memory == MAP_FAILED)
+    {
+        auto error = errno;
+        shm_unlink(_name.c_str());
+        throw Poco::SystemException("Could not map shared memory object " + _name, std::strerror(error));
+    }
+
+    _memory = static_cast<uint8_t*>(memory);
+
+    for (uint32_t index = 0; index < slotCount; index++)
+    {
+        auto slot = new (_memory + sizeof(SharedFrameHeader) + index * sizeof(SharedFrameSlot)) SharedFrameSlot;
+        slot->dataOffset = headersSize + index * alignedSlotCapacity;
+    }
+
+    _header = new (_memory) SharedFrameHeader;
+    _header->slotCount = slotCount;
+    _header->slotCapacity = alignedSlotCapacity;
+    _header->writerProcessId = static_cast<int32_t>(getpid());
+    _header->writerActive.store(1, std::memory_order_relaxed);
+
+    // The magic number is written last, so readers never see it with an incomplete header or slot headers.
+    _header->magic.store(Magic, std::memory_order_release);
+
+    poco_information_f4(_logger, R"(Publishing frames up to %?dx%?d in shared memory object "%s" with %?u slots.)",
+                        maxWidth, maxHeight, _name, slotCount);
+}
+
+SharedMemoryFrameOutput::~SharedMemoryFrameOutput()
+{
+    if (_memory == nullptr)
+    {
+        return;
+    }
+
+    _header->writerActive.store(0, std::memory_order_release);
+    _header->frameCounter.fetch_add(1, std::memory_order_release);
+    WakeReaders();
+
+    munmap(_memory, _size);
+    shm_unlink(_name.c_str());
+}
+
+void SharedMemoryFrameOutput::Publish(const FrameCapture::Frame& frame)
+{
+    auto stride = static_cast<uint64_t>(frame.width) * 4;
+    auto size = stride * static_cast<uint64_t>(frame.height);
+    if (size > _header->slotCapacity)
+    {
+        if (!_skipWarningShown)
+        {
+            poco_warning_f2(_logger, "Frame size %?dx%?d exceeds the shared memory slot size, frames are skipped.",
+                            frame.width, frame.height);
+            _skipWarningShown = true;
+        }
+        return;
+    }
+
+    auto& slot = Slot(static_cast<uint32_t>(frame.sequence % _header->slotCount));
+
+    // Odd lock value: readers started before this point will see a changed value and discard the frame.
+    auto lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.sequence = frame.sequence;
+    slot.timestamp = frame.timestamp;
+    slot.width = static_cast<uint32_t>(frame.width);
+    slot.height = static_cast<uint32_t>(frame.height);
+    slot.stride = static_cast<uint32_t>(stride);
+    slot.format = static_cast<uint32_t>(PixelFormat::RGBA8BottomUp);
+    slot.size = size;
+    std::memcpy(_memory + slot.dataOffset, frame.pixels, size);
+
+    slot.lock.store(lock + 2, std::memory_order_release);
+
+    _header->latestSequence.store(frame.sequence, std::memory_order_release);
+    _header->frameCounter.fetch_add(1, std::memory_order_release);
+    WakeReaders();
+}
+
+int SharedMemoryFrameOutput::CreateObject()
+{
+    int fileDescriptor = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fileDescriptor < 0 && errno == EEXIST)
+    {
+        if (!ExistingObjectIsStale())
+        {
+            throw Poco::FileExistsException("Shared memory object " + _name + " is in use by another application. "
+                                            "Choose a different name, or remove it if it's left over.");
+        }
+
+        poco_information_f1(_logger, R"(Removing stale shared memory object "%s" left behind by a previous instance.)", _name);
+        shm_unlink(_name.c_str());
+        fileDescriptor = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+
+    if (fileDescriptor < 0)
+    {
+        throw Poco::SystemException("Could not create shared memory object " + _name, std::strerror(errno));
+    }
+
+    return fileDescriptor;
+}
+
+bool SharedMemoryFrameOutput::ExistingObjectIsStale() const
+{
+    int fileDescriptor = shm_open(_name.c_str(), O_RDONLY, 0);
+    if (fileDescriptor < 0)
+    {
+        // Already removed by someone else, the next creation attempt will tell.
+        return errno == ENOENT;
+    }
+
+    struct stat status{};
+    bool stale{false};
+    if (fstat(fileDescriptor, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(SharedFrameHeader))
+    {
+        auto memory = mmap(nullptr, sizeof(SharedFrameHeader), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        if (memory != MAP_FAILED)
+        {
+            auto header = static_cast<const SharedFrameHeader*>(memory);
+            auto processId = static_cast<pid_t>(header->writerProcessId);
+
+            // A process which exists, but belongs to another user, fails with EPERM and is still considered alive.
+            stale = header->magic.load(std::memory_order_acquire) == Magic && header->version == Version && processId > 0 &&
+                    kill(processId, 0) != 0 && errno == ESRCH;
+
+            munmap(memory, sizeof(SharedFrameHeader));
+        }
+    }
+    close(fileDescriptor);
+
+    return stale;
+}
+
+SharedMemoryFrameOutput::SharedFrameSlot& SharedMemoryFrameOutput::Slot(uint32_t index)
+{
+    return *reinterpret_cast<SharedFrameSlot*>(_memory + sizeof(SharedFrameHeader) + index * sizeof(SharedFrameSlot));
+}
+
+void SharedMemoryFrameOutput::WakeReaders()
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_header->frameCounter), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "FrameCapture.h"
+
+#include <Poco/Logger.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Publishes captured frames in a POSIX shared memory ring buffer for local readers.
+ *
+ * Compositors, OBS plugins or ffmpeg wrappers can map the shared memory object and read frames directly from it,
+ * without grabbing the window. Any number of readers is supported, and readers never block the render loop.
+ *
+ * The object starts with a SharedFrameHeader, followed by SharedFrameHeader::slotCount SharedFrameSlot headers and
+ * the pixel data of each slot at SharedFrameSlot::dataOffset. Frames are written round-robin into the slots. Each slot
+ * is guarded by a sequence lock: its sequence value is odd while the slot is being written. A reader copies or
+ * processes the pixels, then checks that the slot's sequence didn't change, otherwise the frame was overwritten and
+ * must be discarded.
+ *
+ * The object is created exclusively, so two instances never publish into the same object. An existing object is only
+ * replaced if it was left behind by a crashed instance, i.e. its writer process doesn't exist anymore.
+ *
+ * SharedFrameHeader::magic is written last with release semantics. Readers have to load it with acquire semantics and
+ * only access the other fields once it's Magic.
+ *
+ * After each frame, SharedFrameHeader::frameCounter is incremented. On Linux, readers can wait for the next frame with
+ * FUTEX_WAIT on this counter (without FUTEX_PRIVATE_FLAG, as it's shared between processes). On other systems,
+ * readers have to poll it.
+ */
+class SharedMemoryFrameOutput
+{
+public:
+    static constexpr uint32_t Magic{0x52464d50}; //!< "PMFR" in little endian byte order.
+    static constexpr uint32_t Version{2}; //!< Layout version, incremented on incompatible changes.
+
+    /**
+     * @brief Pixel formats of the published frames.
+     */
+    enum class PixelFormat : uint32_t
+    {
+        RGBA8BottomUp = 1 //!< Tightly packed 8-bit RGBA pixels, bottom row first, as read by OpenGL.
+    };
+
+    /**
+     * @brief Header at the start of the shared memory object.
+     */
+    struct SharedFrameHeader
+    {
+        std::atomic<uint32_t> magic{0}; //!< Identifies the object, Magic once the object is completely initialized.
+        uint32_t version{Version}; //!< The layout version.
+        uint32_t slotCount{0}; //!< Number of frame slots in the ring.
+        int32_t writerProcessId{0}; //!< Process ID of the publishing application, 0 while the object is initialized.
+        uint64_t slotCapacity{0}; //!< Maximum pixel data size of a single slot, in bytes.
+        std::atomic<uint64_t> latestSequence{0}; //!< Sequence number of the most recently published frame, 0 before the first one.
+        std::atomic<uint32_t> frameCounter{0}; //!< Incremented after each frame, futex word for waiting readers.
+        std::atomic<uint32_t> writerActive{0}; //!< 1 while the application is publishing frames, 0 after it stopped.
+    };
+
+    /**
+     * @brief Per-slot header, following the global header.
+     */
+    struct SharedFrameSlot
+    {
+        std::atomic<uint64_t> lock{0}; //!< Sequence lock, odd while the slot is written.
+        uint64_t sequence{0}; //!< Frame sequence number as counted by the FrameCapture, starting at 1. 0 if the slot is still empty.
+        int64_t timestamp{0}; //!< Time the frame was rendered, in microseconds since the Unix epoch.
+        uint32_t width{0}; //!< Frame width in pixels.
+        uint32_t height{0}; //!< Frame height in pixels.
+        uint32_t stride{0}; //!< Size of one row in bytes.
+        uint32_t format{0}; //!< The PixelFormat of the data.
+        uint64_t size{0}; //!< Size of the pixel data in bytes.
+        uint64_t dataOffset{0}; //!< Offset of the pixel data from the start of the shared memory object.
+    };
+
+    /**
+     * @brief Creates the shared memory object.
+     * @param name The POSIX shared memory object name, e.g. "/projectm-frames".
+     * @param maxWidth The largest frame width which can be published.
+     * @param maxHeight The largest frame height which can be published.
+     * @param slotCount The number of frames kept in the ring.
+     * @throws Poco::SystemException if the object can't be created or mapped.
+     * @throws Poco::FileExistsException if another running instance publishes into an object with the same name.
+     */
+    SharedMemoryFrameOutput(const std::string& name, int maxWidth, int maxHeight, uint32_t slotCount);
+
+    SharedMemoryFrameOutput(const SharedMemoryFrameOutput&) = delete;
+
+    SharedMemoryFrameOutput& operator=(const SharedMemoryFrameOutput&) = delete;
+
+    /**
+     * @brief Marks the output as inactive, wakes up all readers and removes the shared memory object.
+     *
+     * Readers which still have the object mapped can continue to access it until they unmap it.
+     */
+    ~SharedMemoryFrameOutput();
+
+    /**
+     * @brief Frame consumer, copies a captured frame into the next slot and notifies readers.
+     *
+     * Frames larger than the configured maximum size are skipped.
+     *
+     * @param frame The captured frame.
+     */
+    void Publish(const FrameCapture::Frame& frame);
+
+protected:
+    /**
+     * @brief Exclusively creates the shared memory object, replacing a stale object left behind by a crashed instance.
+     * @return The file descriptor of the new object.
+     */
+    int CreateObject();
+
+    /**
+     * @brief Checks if an existing shared memory object was left behind by a publisher which doesn't run anymore.
+     *
+     * Objects which aren't fully initialized yet, or have an unknown layout, are never considered stale, as they may
+     * belong to an instance which is just starting or to another application.
+     *
+     * @return True if the object can safely be removed.
+     */
+    bool ExistingObjectIsStale() const;
+
+    /**
+     * @brief Returns the header of the given slot.
+     * @param index The slot index.
+     * @return A reference to the slot header in shared memory.
+     */
+    SharedFrameSlot& Slot(uint32_t index);
+
+    /**
+     * @brief Wakes up all readers waiting on the frame counter.
+     */
+    void WakeReaders();
+
+    std::string _name; //!< The shared memory object name.
+    size_t _size{0}; //!< Total size of the shared memory object.
+    uint8_t* _memory{nullptr}; //!< Start of the mapped object.
+    SharedFrameHeader* _header{nullptr}; //!< The global header, at the start of the mapped object.
+
+    bool _skipWarningShown{false}; //!< True if a too large frame was already reported.
+
+    Poco::Logger& _logger{Poco::Logger::get("SharedMemoryFrameOutput")}; //!< The class logger.
+};
@@ -0,0 +1,118 @@
+#include "TimingHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TimingHistogram::Record(uint64_t microseconds)
+{
+    _counts[BucketIndex(microseconds)]++;
+    _count++;
+    _sum += microseconds;
+    _min = std::min(_min, microseconds);
+    _max = std::max(_max, microseconds);
+}
+
+void TimingHistogram::Reset()
+{
+    std::fill(std::begin(_counts), std::end(_counts), 0);
+    _count = 0;
+    _sum = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+}
+
+uint64_t TimingHistogram::Count() const
+{
+    return _count;
+}
+
+uint64_t TimingHistogram::Min() const
+{
+    return _count > 0 ? _min : 0;
+}
+
+uint64_t TimingHistogram::Max() const
+{
+    return _max;
+}
+
+double TimingHistogram::Mean() const
+{
+    if (_count == 0)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(_sum) / static_cast<double>(_count);
+}
+
+uint64_t TimingHistogram::Percentile(double percentile) const
+{
+    if (_count == 0)
+    {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    auto targetCount = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(_count))), 1);
+
+    uint64_t cumulativeCount{0};
+    for (uint32_t index = 0; index < BucketCount; index++)
+    {
+        cumulativeCount += _counts[index];
+        if (cumulativeCount >= targetCount)
+        {
+            return std::min(BucketUpperBound(index), _max);
+        }
+    }
+
+    return _max;
+}
+
+std::vector<TimingHistogram::Bucket> TimingHistogram::Buckets() const
+{
+    std::vector<Bucket> buckets;
+
+    for (uint32_t index = 0; index < BucketCount; index++)
+    {
+        if (_counts[index] > 0)
+        {
+            buckets.push_back({BucketUpperBound(index), _counts[index]});
+        }
+    }
+
+    return buckets;
+}
+
+uint32_t TimingHistogram::BucketIndex(uint64_t value)
+{
+    if (value < LinearBuckets)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    // Position of the highest set bit, at least 6 here.
+    uint32_t exponent{0};
+    for (uint64_t remaining = value; remaining > 1; remaining >>= 1)
+    {
+        exponent++;
+    }
+
+    auto subBucket = static_cast<uint32_t>((value >> (exponent - SubBucketBits)) & ((1U << SubBucketBits) - 1));
+
+    return LinearBuckets + (exponent - 6) * (1U << SubBucketBits) + subBucket;
+}
+
+uint64_t TimingHistogram::BucketUpperBound(uint32_t index)
+{
+    if (index < LinearBuckets)
+    {
+        return index;
+    }
+
+    uint32_t exponent = (index - LinearBuckets) / (1U << SubBucketBits) + 6;
+    uint64_t subBucket = (index - LinearBuckets) % (1U << SubBucketBits);
+    uint64_t bucketWidth = 1ULL << (exponent - SubBucketBits);
+
+    return (1ULL << exponent) + (subBucket + 1) * bucketWidth - 1;
+}
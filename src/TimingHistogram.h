@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Fixed-size, log-linear histogram of durations in microseconds.
+ *
+ * Works like an HDR histogram: values below 64 microseconds are recorded exactly, larger values are grouped into
+ * 32 linear sub-buckets per power of two. This keeps the relative error below about 3% over the whole 64-bit range,
+ * while the memory used is constant and recording a value only takes a few instructions.
+ */
+class TimingHistogram
+{
+public:
+    /**
+     * @brief A single, non-empty histogram bucket.
+     */
+    struct Bucket
+    {
+        uint64_t upperBound{0}; //!< Highest value in microseconds recorded in this bucket.
+        uint64_t count{0}; //!< Number of values recorded in this bucket.
+    };
+
+    /**
+     * @brief Records a single value.
+     * @param microseconds The duration to record.
+     */
+    void Record(uint64_t microseconds);
+
+    /**
+     * @brief Discards all recorded values.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the number of recorded values.
+     * @return The number of recorded values.
+     */
+    uint64_t Count() const;
+
+    /**
+     * @brief Returns the smallest recorded value.
+     * @return The smallest recorded value in microseconds, or 0 if no values were recorded.
+     */
+    uint64_t Min() const;
+
+    /**
+     * @brief Returns the largest recorded value.
+     * @return The largest recorded value in microseconds, or 0 if no values were recorded.
+     */
+    uint64_t Max() const;
+
+    /**
+     * @brief Returns the mean of all recorded values.
+     * @return The mean value in microseconds, or 0 if no values were recorded.
+     */
+    double Mean() const;
+
+    /**
+     * @brief Returns the value at the given percentile.
+     *
+     * As in HDR histograms, the result is the highest value which is equivalent to the actual percentile value within
+     * the histogram's precision, but never larger than the maximum recorded value.
+     *
+     * @param percentile The percentile, between 0.0 and 100.0.
+     * @return The value at the given percentile in microseconds, or 0 if no values were recorded.
+     */
+    uint64_t Percentile(double percentile) const;
+
+    /**
+     * @brief Returns all non-empty buckets in ascending order.
+     * @return A list of all buckets with at least one recorded value.
+     */
+    std::vector<Bucket> Buckets() const;
+
+private:
+    static constexpr uint32_t LinearBuckets{64}; //!< Number of exact buckets for small values.
+    static constexpr uint32_t SubBucketBits{5}; //!< 2^SubBucketBits sub-buckets per power of two.
+    static constexpr uint32_t BucketCount{LinearBuckets + (64 - 6) * (1U << SubBucketBits)}; //!< Total number of buckets.
+
+    /**
+     * @brief Returns the bucket index for the given value.
+     * @param value The value in microseconds.
+     * @return The index of the bucket the value is recorded in.
+     */
+    static uint32_t BucketIndex(uint64_t value);
+
+    /**
+     * @brief Returns the highest value stored in the bucket with the given index.
+     * @param index The bucket index.
+     * @return The bucket's upper bound in microseconds.
+     */
+    static uint64_t BucketUpperBound(uint32_t index);
+
+    uint64_t _counts[BucketCount]{}; //!< Number of values in each bucket.
+    uint64_t _count{0}; //!< Total number of recorded values.
+    uint64_t _sum{0}; //!< Sum of all recorded values.
+    uint64_t _min{UINT64_MAX}; //!< Smallest recorded value.
+    uint64_t _max{0}; //!< Largest recorded value.
+};
@@ -0,0 +1,173 @@
+#include "WavFileDecoder.h"
+
+#include "SampleConverter.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t WaveFormatPcm{0x0001};
+constexpr uint16_t WaveFormatIeeeFloat{0x0003};
+constexpr uint16_t WaveFormatExtensible{0xFFFE};
+
+uint16_t ReadUInt16(const char* data)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t ReadUInt32(const char* data)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+} // namespace
+
+WavFileDecoder::WavFileDecoder(const char* data, size_t size)
+{
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        throw Poco::DataFormatException("Not a RIFF WAVE file");
+    }
+
+    bool formatFound{false};
+    uint16_t formatTag{0};
+    uint16_t bitsPerSample{0};
+
+    size_t offset{12};
+    while (offset + 8 <= size)
+    {
+        const char* chunkId = data + offset;
+        size_t chunkSize = ReadUInt32(data + offset + 4);
+        const char* chunkData = data + offset + 8;
+        size_t chunkAvailable = std::min(chunkSize, size - offset - 8);
+
+        if (std::memcmp(chunkId, "fmt ", 4) == 0)
+        {
+            if (chunkAvailable < 16)
+            {
+                throw Poco::DataFormatException("WAVE format chunk is too small");
+            }
+
+            formatTag = ReadUInt16(chunkData);
+            _channels = ReadUInt16(chunkData + 2);
+            _sampleRate = ReadUInt32(chunkData + 4);
+            bitsPerSample = ReadUInt16(chunkData + 14);
+
+            // The actual format of an extensible header is stored in the first two bytes of the sub format GUID.
+            if (formatTag == WaveFormatExtensible && chunkAvailable >= 26)
+            {
+                formatTag = ReadUInt16(chunkData + 24);
+            }
+
+            formatFound = true;
+        }
+        else if (std::memcmp(chunkId, "data", 4) == 0)
+        {
+            if (!formatFound)
+            {
+                throw Poco::DataFormatException("WAVE data chunk found before format chunk");
+            }
+
+            _sampleData = chunkData;
+            // Some writers don't update the chunk size when streaming, so trust the actual file size in this case.
+            if (chunkSize == 0 || chunkSize == 0xFFFFFFFF)
+            {
+                chunkAvailable = size - offset - 8;
+            }
+            _bytesPerSample = bitsPerSample / 8;
+            if (_bytesPerSample > 0 && _channels > 0)
+            {
+                _frameCount = chunkAvailable / (_bytesPerSample * _channels);
+            }
+            break;
+        }
+
+        // Chunks are padded to an even size.
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (_sampleData == nullptr)
+    {
+        throw Poco::DataFormatException("WAVE file contains no audio data");
+    }
+
+    if (_channels == 0 || _channels > SampleConverter::MaxInputChannels || _sampleRate == 0)
+    {
+        throw Poco::DataFormatException("WAVE file has an invalid or unsupported channel count or sample rate");
+    }
+
+    if (formatTag == WaveFormatIeeeFloat && bitsPerSample == 32)
+    {
+        _isFloat = true;
+    }
+    else if (formatTag != WaveFormatPcm || (bitsPerSample != 8 && bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32))
+    {
+        throw Poco::DataFormatException(Poco::format("Unsupported WAVE sample format 0x%04?x with %?u bits per sample",
+                                                     formatTag, bitsPerSample));
+    }
+}
+
+const char* WavFileDecoder::FormatName() const
+{
+    return "WAVE";
+}
+
+uint32_t WavFileDecoder::SampleRate() const
+{
+    return _sampleRate;
+}
+
+uint32_t WavFileDecoder::Channels() const
+{
+    return _channels;
+}
+
+size_t WavFileDecoder::Decode(float* output, size_t frames)
+{
+    frames = std::min(frames, _frameCount - _nextFrame);
+    size_t sampleCount = frames * _channels;
+    auto input = reinterpret_cast<const uint8_t*>(_sampleData + _nextFrame * _channels * _bytesPerSample);
+
+    switch (_bytesPerSample)
+    {
+        case 1:
+            // 8-bit WAVE data is unsigned.
+            for (size_t sample = 0; sample < sampleCount; sample++)
+            {
+                output[sample] = static_cast<float>(static_cast<int>(input[sample]) - 128) * (1.0f / 128.0f);
+            }
+            break;
+
+        case 2:
+            SampleConverter::ConvertToFloat(SampleConverter::Format::S16, input, sampleCount, output);
+            break;
+
+        case 3:
+            SampleConverter::ConvertToFloat(SampleConverter::Format::S24, input, sampleCount, output);
+            break;
+
+        case 4:
+            SampleConverter::ConvertToFloat(_isFloat ? SampleConverter::Format::F32 : SampleConverter::Format::S32,
+                                            input, sampleCount, output);
+            break;
+
+        default:
+            break;
+    }
+
+    _nextFrame += frames;
+
+    return frames;
+}
+
+void WavFileDecoder::Rewind()
+{
+    _nextFrame = 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "AudioFileDecoder.h"
+
+/**
+ * @brief Decoder for RIFF WAVE files.
+ *
+ * Supports uncompressed integer PCM with 8, 16, 24 or 32 bits per sample and 32-bit IEEE float data, both in
+ * plain and extensible format headers.
+ */
+class WavFileDecoder : public AudioFileDecoder
+{
+public:
+    /**
+     * @brief Parses the WAVE header and locates the audio data.
+     * @param data Pointer to the file contents.
+     * @param size Size of the file contents in bytes.
+     */
+    WavFileDecoder(const char* data, size_t size);
+
+    const char* FormatName() const override;
+
+    uint32_t SampleRate() const override;
+
+    uint32_t Channels() const override;
+
+    size_t Decode(float* output, size_t frames) override;
+
+    void Rewind() override;
+
+private:
+    const char* _sampleData{nullptr}; //!< Start of the "data" chunk contents.
+    size_t _frameCount{0}; //!< Number of complete sample frames in the data chunk.
+    size_t _nextFrame{0}; //!< Next frame to decode.
+
+    uint32_t _sampleRate{0}; //!< Sample rate in Hz.
+    uint32_t _channels{0}; //!< Number of interleaved channels.
+    uint32_t _bytesPerSample{0}; //!< Size of a single sample in bytes.
+    bool _isFloat{false}; //!< True if the samples are IEEE float values.
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @brief Snapshot of the window geometry, as needed for rendering and the UI.
+ *
+ * SDL window functions may only be called on the main thread. The main thread queries the state with
+ * SDLRenderingWindow::QueryWindowState() and passes it to the render thread via the EventQueue.
+ *
+ * The UI scale is derived from the ratio of drawable to window size. If the OS scales the UI, e.g. to 200%, the
+ * drawable size in pixels is twice the window size in screen coordinates.
+ */
+struct WindowState
+{
+    int windowWidth{0}; //!< Window width in screen coordinates. Mouse event coordinates use the same unit.
+    int windowHeight{0}; //!< Window height in screen coordinates.
+    int drawableWidth{0}; //!< Width of the OpenGL drawable area in pixels.
+    int drawableHeight{0}; //!< Height of the OpenGL drawable area in pixels.
+    int displayIndex{-1}; //!< Index of the display showing the window, or -1 if unknown.
+
+    bool operator==(const WindowState& other) const
+    {
+        return windowWidth == other.windowWidth && windowHeight == other.windowHeight &&
+               drawableWidth == other.drawableWidth && drawableHeight == other.drawableHeight &&
+               displayIndex == other.displayIndex;
+    }
+
+    bool operator!=(const WindowState& other) const
+    {
+        return !(*this == other);
+    }
+};
@@ -47,7 +47,7 @@ void MainMenu::Draw()
 
         if (ImGui::BeginMenu("Playback"))
         {
-            auto& app = ProjectMSDLApplication::instance();
+            auto settings = _projectMWrapper.Settings();
 
             if (ImGui::MenuItem("Play Next Preset", "n"))
             {
@@ -65,14 +65,18 @@ void MainMenu::Draw()
             {
                 _notificationCenter.postNotification(new PlaybackControlNotification(PlaybackControlNotification::Action::RandomPreset));
             }
+            if (ImGui::MenuItem("Find Preset..."))
+            {
+                _gui.ShowPresetSearchWindow();
+            }
 
             ImGui::Separator();
 
-            if (ImGui::MenuItem("Lock Preset", "Spacebar", app.config().getBool("projectM.presetLocked", false)))
+            if (ImGui::MenuItem("Lock Preset", "Spacebar", settings->presetLocked))
             {
                 _notificationCenter.postNotification(new PlaybackControlNotification(PlaybackControlNotification::Action::TogglePresetLocked));
             }
-            if (ImGui::MenuItem("Enable Shuffle", "y", app.config().getBool("projectM.shuffleEnabled", true)))
+            if (ImGui::MenuItem("Enable Shuffle", "y", settings->shuffleEnabled))
             {
                 _notificationCenter.postNotification(new PlaybackControlNotification(PlaybackControlNotification::Action::ToggleShuffle));
             }
@@ -83,10 +87,11 @@ void MainMenu::Draw()
         if (ImGui::BeginMenu("Options"))
         {
             auto& app = ProjectMSDLApplication::instance();
+            auto settings = _projectMWrapper.Settings();
 
             if (ImGui::BeginMenu("Audio Capture Device"))
             {
-                auto devices = _audioCapture.AudioDeviceList();
+                const auto& devices = _audioCapture.AudioDeviceList();
                 auto currentIndex = _audioCapture.AudioDeviceIndex();
 
                 for (const auto& device : devices)
@@ -101,13 +106,13 @@ void MainMenu::Draw()
 
             ImGui::Separator();
 
-            if (ImGui::MenuItem("Display Toast Messages", "", app.config().getBool("projectM.displayToasts", true)))
+            if (ImGui::MenuItem("Display Toast Messages", "", settings->displayToasts))
             {
-                app.UserConfiguration()->setBool("projectM.displayToasts", !app.config().getBool("projectM.displayToasts", true));
+                app.UserConfiguration()->setBool("projectM.displayToasts", !settings->displayToasts);
             }
-            if (ImGui::MenuItem("Display Preset Name in Window Title", "", app.config().getBool("window.displayPresetNameInTitle", true)))
+            if (ImGui::MenuItem("Display Preset Name in Window Title", "", settings->displayPresetNameInTitle))
             {
-                app.UserConfiguration()->setBool("window.displayPresetNameInTitle", !app.config().getBool("window.displayPresetNameInTitle", true));
+                app.UserConfiguration()->setBool("window.displayPresetNameInTitle", !settings->displayPresetNameInTitle);
                 _notificationCenter.postNotification(new UpdateWindowTitleNotification);
             }
 
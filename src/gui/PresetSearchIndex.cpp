@@ -0,0 +1,294 @@
+#include "PresetSearchIndex.h"
+
+#include <Poco/Clock.h>
+#include <Poco/Path.h>
+
+#include <algorithm>
+
+PresetSearchIndex::~PresetSearchIndex()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_one();
+
+    if (_workerThread.joinable())
+    {
+        _workerThread.join();
+    }
+}
+
+void PresetSearchIndex::Update(std::vector<std::string> presetFiles, uint32_t playlistVersion)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pendingPresetFiles = std::move(presetFiles);
+        _pendingPlaylistVersion = playlistVersion;
+        _updatePending = true;
+
+        if (!_workerThread.joinable())
+        {
+            _workerThread = std::thread(&PresetSearchIndex::Worker, this);
+        }
+    }
+    _condition.notify_one();
+}
+
+bool PresetSearchIndex::Updating() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _updatePending || _building;
+}
+
+uint32_t PresetSearchIndex::Generation() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _generation;
+}
+
+PresetSearchIndex::Results PresetSearchIndex::Search(const std::string& query, size_t maxResults) const
+{
+    std::shared_ptr<const Index> index;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        index = _index;
+    }
+
+    Results results;
+    if (!index)
+    {
+        return results;
+    }
+
+    results.playlistVersion = index->playlistVersion;
+    results.presetCount = index->normalizedNames.size();
+
+    auto normalizedQuery = Normalize(query);
+    if (normalizedQuery.size() < MinimumQueryLength)
+    {
+        return results;
+    }
+
+    // Two characters only match at the start of a word, via the trigram with the leading space.
+    if (normalizedQuery.size() < 3)
+    {
+        normalizedQuery.insert(0, 1, ' ');
+    }
+
+    std::vector<uint32_t> queryTrigrams;
+    for (size_t offset = 0; offset + 3 <= normalizedQuery.size(); offset++)
+    {
+        queryTrigrams.push_back(Trigram(&normalizedQuery[offset]));
+    }
+    std::sort(queryTrigrams.begin(), queryTrigrams.end());
+    queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()), queryTrigrams.end());
+    auto trigramCount = queryTrigrams.size();
+
+    std::vector<const std::vector<uint32_t>*> postingLists;
+    for (auto trigram : queryTrigrams)
+    {
+        auto postings = index->trigrams.find(trigram);
+        if (postings != index->trigrams.end())
+        {
+            postingLists.push_back(&postings->second);
+        }
+    }
+
+    // Each typo affects up to three trigrams, so requiring half of them tolerates about one typo per six characters.
+    auto minimumHits = std::max<size_t>(1, trigramCount / 2);
+    if (postingLists.size() < minimumHits)
+    {
+        return results;
+    }
+
+    // A preset can only reach the minimum hit count if it's in at least one of the shortest lists. The longer lists
+    // are then only checked for these candidates, which avoids walking lists of very common trigrams.
+    std::sort(postingLists.begin(), postingLists.end(),
+              [](const std::vector<uint32_t>* left, const std::vector<uint32_t>* right) {
+                  return left->size() < right->size();
+              });
+    auto seedListCount = postingLists.size() - minimumHits + 1;
+
+    std::vector<uint16_t> hits(index->normalizedNames.size(), 0);
+    std::vector<uint32_t> hitPresets;
+    for (size_t list = 0; list < seedListCount; list++)
+    {
+        for (auto presetIndex : *postingLists[list])
+        {
+            if (hits[presetIndex]++ == 0)
+            {
+                hitPresets.push_back(presetIndex);
+            }
+        }
+    }
+    for (size_t list = seedListCount; list < postingLists.size(); list++)
+    {
+        const auto& postings = *postingLists[list];
+        if (hitPresets.size() * 16 < postings.size())
+        {
+            for (auto presetIndex : hitPresets)
+            {
+                if (std::binary_search(postings.begin(), postings.end(), presetIndex))
+                {
+                    hits[presetIndex]++;
+                }
+            }
+        }
+        else
+        {
+            for (auto presetIndex : postings)
+            {
+                if (hits[presetIndex] > 0)
+                {
+                    hits[presetIndex]++;
+                }
+            }
+        }
+    }
+
+    // Candidates are sorted by a single key: substring matches first, matches at the start of a word first, more
+    // trigram hits first, shorter names first and finally by playlist index.
+    std::vector<uint64_t> candidates;
+    for (auto presetIndex : hitPresets)
+    {
+        auto presetHits = hits[presetIndex];
+        if (presetHits < minimumHits)
+        {
+            continue;
+        }
+
+        const auto& name = index->normalizedNames[presetIndex];
+
+        // A substring match requires all trigrams, so the comparably slow search is only done for those.
+        auto position = presetHits == trigramCount ? name.find(normalizedQuery) : std::string::npos;
+        bool substring = position != std::string::npos;
+        bool wordStart = substring && (normalizedQuery[0] == ' ' || name[position - 1] == ' ');
+
+        candidates.push_back(static_cast<uint64_t>(!substring) << 63 |
+                             static_cast<uint64_t>(!wordStart) << 62 |
+                             static_cast<uint64_t>(0xFFFFu - presetHits) << 46 |
+                             static_cast<uint64_t>(std::min<size_t>(name.size(), 0x3FFFu)) << 32 |
+                             presetIndex);
+    }
+
+    auto resultCount = std::min(maxResults, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + resultCount, candidates.end());
+
+    results.matches.reserve(resultCount);
+    for (size_t candidate = 0; candidate < resultCount; candidate++)
+    {
+        auto presetIndex = static_cast<uint32_t>(candidates[candidate] & 0xFFFFFFFFu);
+        results.matches.push_back({presetIndex, index->names[presetIndex], index->presetFiles[presetIndex]});
+    }
+
+    return results;
+}
+
+void PresetSearchIndex::Worker()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        _condition.wait(lock, [this]() {
+            return _stop || _updatePending;
+        });
+
+        if (_stop)
+        {
+            break;
+        }
+
+        auto presetFiles = std::move(_pendingPresetFiles);
+        auto playlistVersion = _pendingPlaylistVersion;
+        _pendingPresetFiles.clear();
+        _updatePending = false;
+        _building = true;
+
+        lock.unlock();
+        Poco::Clock startTime;
+        auto index = Build(std::move(presetFiles), playlistVersion);
+        poco_debug_f2(_logger, "Indexed %?u presets for searching in %.1f ms.",
+                      index->names.size(), static_cast<double>(startTime.elapsed()) / 1000.0);
+        lock.lock();
+
+        _index = std::move(index);
+        _generation++;
+        _building = false;
+    }
+}
+
+std::shared_ptr<const PresetSearchIndex::Index> PresetSearchIndex::Build(std::vector<std::string> presetFiles, uint32_t playlistVersion)
+{
+    auto index = std::make_shared<Index>();
+    index->playlistVersion = playlistVersion;
+    index->names.reserve(presetFiles.size());
+    index->normalizedNames.reserve(presetFiles.size());
+
+    std::vector<uint32_t> nameTrigrams;
+    for (uint32_t presetIndex = 0; presetIndex < presetFiles.size(); presetIndex++)
+    {
+        index->names.push_back(Poco::Path(presetFiles[presetIndex]).getBaseName());
+        // The leading space adds trigrams for the first two characters of each word.
+        index->normalizedNames.push_back(" " + Normalize(index->names.back()));
+
+        // Add each preset only once per trigram, so hit counts aren't skewed by repetitions.
+        const auto& normalizedName = index->normalizedNames.back();
+        nameTrigrams.clear();
+        for (size_t offset = 0; offset + 3 <= normalizedName.size(); offset++)
+        {
+            nameTrigrams.push_back(Trigram(&normalizedName[offset]));
+        }
+        std::sort(nameTrigrams.begin(), nameTrigrams.end());
+        nameTrigrams.erase(std::unique(nameTrigrams.begin(), nameTrigrams.end()), nameTrigrams.end());
+
+        for (auto trigram : nameTrigrams)
+        {
+            index->trigrams[trigram].push_back(presetIndex);
+        }
+    }
+
+    index->presetFiles = std::move(presetFiles);
+
+    return index;
+}
+
+std::string PresetSearchIndex::Normalize(const std::string& text)
+{
+    std::string normalizedText;
+    normalizedText.reserve(text.size());
+
+    for (auto character : text)
+    {
+        auto byte = static_cast<unsigned char>(character);
+
+        // Non-ASCII UTF-8 sequences are kept as they are, so non-English names can still be searched.
+        if ((byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z') || byte >= 0x80)
+        {
+            normalizedText.push_back(character);
+        }
+        else if (byte >= 'A' && byte <= 'Z')
+        {
+            normalizedText.push_back(static_cast<char>(byte - 'A' + 'a'));
+        }
+        else if (!normalizedText.empty() && normalizedText.back() != ' ')
+        {
+            normalizedText.push_back(' ');
+        }
+    }
+
+    if (!normalizedText.empty() && normalizedText.back() == ' ')
+    {
+        normalizedText.pop_back();
+    }
+
+    return normalizedText;
+}
+
+uint32_t PresetSearchIndex::Trigram(const char* text)
+{
+    return static_cast<uint32_t>(static_cast<unsigned char>(text[0])) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[1])) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[2]));
+}
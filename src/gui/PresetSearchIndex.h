@@ -0,0 +1,148 @@
+#pragma once
+
+#include <Poco/Logger.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief In-memory trigram index over the playlist's preset names for instant, typo-tolerant searching.
+ *
+ * Each preset's file name, without directory and extension, is normalized to lower case with all punctuation
+ * replaced by spaces, so "Geiss_-_Cosmic Dust.milk" is found by "cosmic dust" or "geiss cosmic". Every three-character
+ * sequence (trigram) of the normalized name points to all presets containing it.
+ *
+ * A search looks up the query's trigrams and counts the hits per preset. Presets sharing at least half of the query's
+ * trigrams are candidates, so a typo or a swapped letter still finds the preset. Candidates containing the query as a
+ * substring are ranked first, matches at the start of a word and shorter names before others. Names are indexed with
+ * a leading space, so queries of two characters are looked up as the start of a word.
+ *
+ * The index is rebuilt on a worker thread whenever Update() is called. Searches use the last complete index in the
+ * meantime.
+ */
+class PresetSearchIndex
+{
+public:
+    static constexpr size_t MinimumQueryLength{2}; //!< Shorter queries, after normalization, don't return any results.
+
+    /**
+     * @brief A single search result.
+     */
+    struct Match
+    {
+        uint32_t index{0}; //!< The preset's playlist index.
+        std::string name; //!< The preset name for display, without directory and extension.
+        std::string fileName; //!< The full preset file name.
+    };
+
+    /**
+     * @brief The results of a search.
+     */
+    struct Results
+    {
+        uint32_t playlistVersion{0}; //!< The playlist version the index was built from, see ProjectMWrapper::PlaylistVersion().
+        size_t presetCount{0}; //!< The number of presets in the index.
+        std::vector<Match> matches; //!< The best matches, best first.
+    };
+
+    PresetSearchIndex() = default;
+
+    PresetSearchIndex(const PresetSearchIndex&) = delete;
+
+    PresetSearchIndex& operator=(const PresetSearchIndex&) = delete;
+
+    /**
+     * @brief Stops the worker thread.
+     */
+    ~PresetSearchIndex();
+
+    /**
+     * @brief Rebuilds the index in the background.
+     *
+     * If a rebuild is already running, the new preset list is indexed afterwards. Intermediate lists are skipped.
+     *
+     * @param presetFiles All playlist items, in playlist order.
+     * @param playlistVersion The playlist version of the items.
+     */
+    void Update(std::vector<std::string> presetFiles, uint32_t playlistVersion);
+
+    /**
+     * @brief Returns whether the index is being rebuilt.
+     * @return True if an update is pending or running.
+     */
+    bool Updating() const;
+
+    /**
+     * @brief Returns a counter which is incremented each time a rebuilt index replaces the previous one.
+     * @return The index generation.
+     */
+    uint32_t Generation() const;
+
+    /**
+     * @brief Searches the index.
+     * @param query The search text.
+     * @param maxResults The maximum number of matches to return.
+     * @return The best matching presets. Empty if the query has fewer than MinimumQueryLength letters or digits.
+     */
+    Results Search(const std::string& query, size_t maxResults) const;
+
+protected:
+    /**
+     * @brief An immutable, completely built index.
+     */
+    struct Index
+    {
+        uint32_t playlistVersion{0}; //!< The playlist version the index was built from.
+        std::vector<std::string> presetFiles; //!< The full preset file names, in playlist order.
+        std::vector<std::string> names; //!< Display names, in playlist order.
+        std::vector<std::string> normalizedNames; //!< Normalized names with a leading space, in playlist order.
+        std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams; //!< Ascending playlist indices by trigram.
+    };
+
+    /**
+     * @brief Worker thread function, builds indices until stopped.
+     */
+    void Worker();
+
+    /**
+     * @brief Builds a new index.
+     * @param presetFiles All playlist items.
+     * @param playlistVersion The playlist version of the items.
+     * @return The new index.
+     */
+    static std::shared_ptr<const Index> Build(std::vector<std::string> presetFiles, uint32_t playlistVersion);
+
+    /**
+     * @brief Converts text to lower case and replaces all runs of other characters than letters and digits by a single space.
+     * @param text The text to normalize.
+     * @return The normalized text, without leading or trailing spaces.
+     */
+    static std::string Normalize(const std::string& text);
+
+    /**
+     * @brief Packs three characters into a trigram key.
+     * @param text Pointer to the first of the three characters.
+     * @return The trigram key.
+     */
+    static uint32_t Trigram(const char* text);
+
+    std::thread _workerThread; //!< Runs Worker(), started with the first update.
+
+    mutable std::mutex _mutex; //!< Protects all members below.
+    std::condition_variable _condition; //!< Signals a new preset list or stopping.
+    bool _stop{false}; //!< If true, the worker thread exits.
+    bool _updatePending{false}; //!< True if _pendingPresetFiles needs to be indexed.
+    bool _building{false}; //!< True while the worker builds an index.
+    std::vector<std::string> _pendingPresetFiles; //!< The preset list to index next.
+    uint32_t _pendingPlaylistVersion{0}; //!< The playlist version of the pending preset list.
+    std::shared_ptr<const Index> _index; //!< The current index, nullptr until the first one was built.
+    uint32_t _generation{0}; //!< Incremented each time _index is replaced.
+
+    Poco::Logger& _logger{Poco::Logger::get("PresetSearchIndex")}; //!< The class logger.
+};
@@ -0,0 +1,142 @@
+#include "PresetSearchWindow.h"
+
+#include "ProjectMWrapper.h"
+
+#include <imgui.h>
+
+#include <Poco/Util/Application.h>
+
+#include <cstring>
+
+PresetSearchWindow::PresetSearchWindow()
+    : _projectMWrapper(Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>())
+{
+}
+
+void PresetSearchWindow::Show()
+{
+    _visible = true;
+    _focusSearch = true;
+    ImGui::SetWindowFocus("Find Preset###FindPreset");
+}
+
+void PresetSearchWindow::Draw()
+{
+    if (!_visible)
+    {
+        return;
+    }
+
+    UpdateIndex();
+
+    ImGui::SetNextWindowSize(ImVec2(600, 500), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Find Preset###FindPreset", &_visible, ImGuiWindowFlags_NoCollapse))
+    {
+        if (_focusSearch)
+        {
+            ImGui::SetKeyboardFocusHere();
+            _focusSearch = false;
+        }
+
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        bool enterPressed = ImGui::InputTextWithHint("##search", "Preset name, press <ENTER> to play the best match",
+                                                     &_searchText[0], IM_ARRAYSIZE(_searchText), ImGuiInputTextFlags_EnterReturnsTrue);
+
+        auto generation = _searchIndex.Generation();
+        if (_lastSearchText != &_searchText[0] || _resultsGeneration != generation)
+        {
+            Poco::Clock startTime;
+            _results = _searchIndex.Search(&_searchText[0], MaxResults);
+            _searchMilliseconds = static_cast<double>(startTime.elapsed()) / 1000.0;
+            _lastSearchText = &_searchText[0];
+            _resultsGeneration = generation;
+        }
+
+        if (_results.playlistVersion != _projectMWrapper.PlaylistVersion() || (_searchIndex.Updating() && _results.presetCount == 0))
+        {
+            ImGui::TextUnformatted("Updating search index...");
+        }
+        else if (std::strlen(&_searchText[0]) < PresetSearchIndex::MinimumQueryLength)
+        {
+            ImGui::Text("Type at least %zu characters to search %zu presets.", PresetSearchIndex::MinimumQueryLength, _results.presetCount);
+        }
+        else
+        {
+            ImGui::Text("%zu matches in %zu presets (%.2f ms)", _results.matches.size(), _results.presetCount, _searchMilliseconds);
+        }
+
+        if (enterPressed && !_results.matches.empty())
+        {
+            PlayMatch(_results.matches.front());
+        }
+
+        if (ImGui::BeginChild("##results"))
+        {
+            auto currentIndex = _projectMWrapper.CurrentPresetIndex();
+            for (size_t matchIndex = 0; matchIndex < _results.matches.size(); matchIndex++)
+            {
+                const auto& match = _results.matches[matchIndex];
+
+                ImGui::PushID(static_cast<int>(matchIndex));
+                if (ImGui::Selectable(match.name.c_str(), match.index == currentIndex))
+                {
+                    PlayMatch(match);
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("%s", match.fileName.c_str());
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+    }
+    ImGui::End();
+}
+
+void PresetSearchWindow::UpdateIndex()
+{
+    auto playlistVersion = _projectMWrapper.PlaylistVersion();
+    auto playlistSize = projectm_playlist_size(_projectMWrapper.Playlist());
+
+    if (_indexRequested && playlistVersion == _indexedPlaylistVersion && playlistSize == _indexedPlaylistSize)
+    {
+        return;
+    }
+
+    // Appended presets don't change existing indices, so the current index stays usable until the next update.
+    if (_indexRequested && playlistVersion == _indexedPlaylistVersion && _lastIndexUpdate.elapsed() < 1000000)
+    {
+        return;
+    }
+
+    std::vector<std::string> presetFiles;
+    presetFiles.reserve(playlistSize);
+    auto items = projectm_playlist_items(_projectMWrapper.Playlist(), 0, playlistSize);
+    if (items != nullptr)
+    {
+        for (uint32_t index = 0; items[index] != nullptr; index++)
+        {
+            presetFiles.emplace_back(items[index]);
+        }
+        projectm_playlist_free_string_array(items);
+    }
+
+    _searchIndex.Update(std::move(presetFiles), playlistVersion);
+    _indexRequested = true;
+    _indexedPlaylistVersion = playlistVersion;
+    _indexedPlaylistSize = playlistSize;
+    _lastIndexUpdate.update();
+}
+
+void PresetSearchWindow::PlayMatch(const PresetSearchIndex::Match& match)
+{
+    // The indices are outdated if presets were inserted or removed since the index was built.
+    if (_results.playlistVersion != _projectMWrapper.PlaylistVersion() ||
+        match.index >= projectm_playlist_size(_projectMWrapper.Playlist()))
+    {
+        return;
+    }
+
+    _projectMWrapper.PlayPreset(match.index, true);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "PresetSearchIndex.h"
+
+#include <Poco/Clock.h>
+
+#include <string>
+
+class ProjectMWrapper;
+
+/**
+ * @brief Window to find presets by name and jump to them.
+ *
+ * The search index is only built while the window is open, and rebuilt when the playlist changes.
+ */
+class PresetSearchWindow
+{
+public:
+    PresetSearchWindow();
+
+    /**
+     * @brief Displays the search window and focuses the search box.
+     */
+    void Show();
+
+    /**
+     * @brief Draws the search window.
+     */
+    void Draw();
+
+private:
+    static constexpr size_t MaxResults{100}; //!< Maximum number of matches displayed.
+
+    /**
+     * @brief Passes the current playlist to the search index if it has changed.
+     *
+     * While the directory scan appends presets, the index is rebuilt at most once per second.
+     */
+    void UpdateIndex();
+
+    /**
+     * @brief Displays a search result, if the playlist didn't change in the meantime.
+     * @param match The search result.
+     */
+    void PlayMatch(const PresetSearchIndex::Match& match);
+
+    ProjectMWrapper& _projectMWrapper; //!< Reference to the projectM wrapper subsystem.
+
+    PresetSearchIndex _searchIndex; //!< The preset name index.
+    bool _indexRequested{false}; //!< True after the first index update.
+    uint32_t _indexedPlaylistVersion{0}; //!< Playlist version passed to the last index update.
+    uint32_t _indexedPlaylistSize{0}; //!< Playlist size passed to the last index update.
+    Poco::Clock _lastIndexUpdate; //!< Time of the last index update.
+
+    char _searchText[256]{}; //!< Search box contents.
+    std::string _lastSearchText; //!< Search text of the current results.
+    uint32_t _resultsGeneration{0}; //!< Index generation of the current results.
+    PresetSearchIndex::Results _results; //!< The current search results.
+    double _searchMilliseconds{0.0}; //!< Duration of the last search.
+
+    bool _visible{false}; //!< Window visibility flag.
+    bool _focusSearch{false}; //!< If true, the search box is focused in the next frame.
+};
@@ -29,11 +29,22 @@ void PresetSelection::Draw()
         if (ImGui::SliderInt("Playlist Position", reinterpret_cast<int*>(&_playlistPosition), 0, _playlistSize - 1))
         {
             auto& projectMWrapper = Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>();
-            projectm_playlist_set_position(projectMWrapper.Playlist(), _playlistPosition, true);
+            projectMWrapper.PlayPreset(_playlistPosition, true);
         }
 
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+        {
+            auto& projectMWrapper = Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>();
+            auto cacheStatistics = projectMWrapper.PresetCacheStatistics();
+            ImGui::Text("Preset cache: %llu hits, %llu misses, %zu presets using %.1f of %.1f MiB",
+                        static_cast<unsigned long long>(cacheStatistics.hits),
+                        static_cast<unsigned long long>(cacheStatistics.misses),
+                        cacheStatistics.entries,
+                        static_cast<double>(cacheStatistics.size) / (1024.0 * 1024.0),
+                        static_cast<double>(cacheStatistics.budget) / (1024.0 * 1024.0));
+        }
+
         if (ImGui::Button("Toggle Fullscreen"))
         {
             auto& renderingWindow = Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>();
@@ -45,10 +56,7 @@ void PresetSelection::Draw()
         if (ImGui::Button("Random Preset"))
         {
             auto& projectMWrapper = Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>();
-            bool shuffleEnabled = projectm_playlist_get_shuffle(projectMWrapper.Playlist());
-            projectm_playlist_set_shuffle(projectMWrapper.Playlist(), true);
-            projectm_playlist_play_next(projectMWrapper.Playlist(), true);
-            projectm_playlist_set_shuffle(projectMWrapper.Playlist(), shuffleEnabled);
+            projectMWrapper.PlayRandom(true);
         }
 
         ImGui::SameLine();
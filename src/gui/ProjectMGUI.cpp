@@ -13,6 +13,7 @@
 
 #include <Poco/Util/Application.h>
 
+#include <cfloat>
 #include <utility>
 
 const char* ProjectMGUI::name() const
@@ -22,6 +23,17 @@ const char* ProjectMGUI::name() const
 
 void ProjectMGUI::initialize(Poco::Util::Application& app)
 {
+    auto& renderingWindow = Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>();
+    auto& projectMWrapper = Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>();
+
+    _projectMWrapper = &projectMWrapper;
+
+    // Without a window, there's no input and nothing to display the UI on.
+    if (renderingWindow.Headless())
+    {
+        return;
+    }
+
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
@@ -33,19 +45,18 @@ void ProjectMGUI::initialize(Poco::Util::Application& app)
 
     io.IniFilename = _uiIniFileName.c_str();
 
-    ImGui::StyleColorsDark();
+    // The cursor can only be changed on the main thread, it's managed by SDLRenderingWindow.
+    io.ConfigFlags |= ImGuiConfigFlags_NoMouseCursorChange;
 
-    auto& renderingWindow = Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>();
-    auto& projectMWrapper = Poco::Util::Application::instance().getSubsystem<ProjectMWrapper>();
+    ImGui::StyleColorsDark();
 
-    _projectMWrapper = &projectMWrapper;
     _renderingWindow = renderingWindow.GetRenderingWindow();
     _glContext = renderingWindow.GetGlContext();
 
     ImGui_ImplSDL2_InitForOpenGL(_renderingWindow, _glContext);
     ImGui_ImplOpenGL3_Init("#version 130");
 
-    UpdateFontSize();
+    UpdateFontSize(renderingWindow.QueryWindowState());
 
     // Set a sensible minimum window size to prevent layout assertions
     auto& style = ImGui::GetStyle();
@@ -56,29 +67,44 @@ void ProjectMGUI::initialize(Poco::Util::Application& app)
 
 void ProjectMGUI::uninitialize()
 {
+    _projectMWrapper = nullptr;
+
+    if (!_renderingWindow)
+    {
+        return;
+    }
+
     Poco::NotificationCenter::defaultCenter().removeObserver(_displayToastNotificationObserver);
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
 
-    _projectMWrapper = nullptr;
     _renderingWindow = nullptr;
     _glContext = nullptr;
 }
 
-void ProjectMGUI::UpdateFontSize()
+void ProjectMGUI::UpdateFontSize(const WindowState& windowState)
 {
+    if (!_renderingWindow)
+    {
+        return;
+    }
+
     ImGuiIO& io = ImGui::GetIO();
 
-    auto displayIndex = SDL_GetWindowDisplayIndex(_renderingWindow);
-    if (displayIndex < 0)
+    if (windowState.displayIndex < 0)
     {
-        poco_debug_f1(_logger, "Could not get display index for application window: %s", std::string(SDL_GetError()));
+        poco_debug(_logger, "Could not get display index for application window.");
         return;
     }
 
-    auto newScalingFactor = GetScalingFactor();
+    if (windowState.drawableWidth <= 0 || windowState.drawableHeight <= 0)
+    {
+        return;
+    }
+
+    auto newScalingFactor = GetScalingFactor(windowState);
 
     // Only interested in changes of .05 or more
     if (std::abs(_textScalingFactor - newScalingFactor) < 0.05)
@@ -86,7 +112,7 @@ void ProjectMGUI::UpdateFontSize()
         return;
     }
 
-    poco_debug_f3(_logger, "Scaling factor change for display %?d: %hf -> %hf", displayIndex, _textScalingFactor, newScalingFactor);
+    poco_debug_f3(_logger, "Scaling factor change for display %?d: %hf -> %hf", windowState.displayIndex, _textScalingFactor, newScalingFactor);
 
     _textScalingFactor = newScalingFactor;
 
@@ -104,7 +130,18 @@ void ProjectMGUI::UpdateFontSize()
 
 void ProjectMGUI::ProcessInput(const SDL_Event& event)
 {
+    if (!_renderingWindow)
+    {
+        return;
+    }
+
     ImGui_ImplSDL2_ProcessEvent(&event);
+
+    // The SDL backend only applies a pending mouse leave in ImGui_ImplSDL2_NewFrame(), which isn't used.
+    if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_LEAVE)
+    {
+        ImGui::GetIO().AddMousePosEvent(-FLT_MAX, -FLT_MAX);
+    }
 }
 
 void ProjectMGUI::Toggle()
@@ -122,18 +159,14 @@ bool ProjectMGUI::Visible() const
     return _visible;
 }
 
-void ProjectMGUI::Draw()
+void ProjectMGUI::Draw(const WindowState& windowState)
 {
     // Don't render UI at all if there's no need.
-    if (!_toast && !_visible)
+    if (!_renderingWindow || (!_toast && !_visible))
     {
         return;
     }
 
-    ImGui_ImplSDL2_NewFrame();
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui::NewFrame();
-
     float secondsSinceLastFrame = .0f;
     if (_lastFrameTicks == 0)
     {
@@ -146,6 +179,20 @@ void ProjectMGUI::Draw()
         _lastFrameTicks = currentFrameTicks;
     }
 
+    // Replaces ImGui_ImplSDL2_NewFrame(), which queries the window and mouse state via SDL and thus may only be
+    // called on the main thread. Mouse and keyboard input arrive as events in ProcessInput().
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(windowState.windowWidth), static_cast<float>(windowState.windowHeight));
+    if (windowState.windowWidth > 0 && windowState.windowHeight > 0)
+    {
+        io.DisplayFramebufferScale = ImVec2(static_cast<float>(windowState.drawableWidth) / static_cast<float>(windowState.windowWidth),
+                                            static_cast<float>(windowState.drawableHeight) / static_cast<float>(windowState.windowHeight));
+    }
+    io.DeltaTime = secondsSinceLastFrame > 0.0f ? secondsSinceLastFrame : 1.0f / 60.0f;
+
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui::NewFrame();
+
     if (_toast)
     {
         if (!_toast->Draw(secondsSinceLastFrame))
@@ -160,6 +207,7 @@ void ProjectMGUI::Draw()
         _settingsWindow.Draw();
         _aboutWindow.Draw();
         _helpWindow.Draw();
+        _presetSearchWindow.Draw();
     }
 
     ImGui::Render();
@@ -168,12 +216,22 @@ void ProjectMGUI::Draw()
 
 bool ProjectMGUI::WantsKeyboardInput()
 {
+    if (!_renderingWindow)
+    {
+        return false;
+    }
+
     auto& io = ImGui::GetIO();
     return io.WantCaptureKeyboard;
 }
 
 bool ProjectMGUI::WantsMouseInput()
 {
+    if (!_renderingWindow)
+    {
+        return false;
+    }
+
     auto& io = ImGui::GetIO();
     return io.WantCaptureMouse;
 }
@@ -208,24 +266,22 @@ void ProjectMGUI::ShowHelpWindow()
     _helpWindow.Show();
 }
 
-float ProjectMGUI::GetScalingFactor()
+void ProjectMGUI::ShowPresetSearchWindow()
 {
-    int windowWidth;
-    int windowHeight;
-    int renderWidth;
-    int renderHeight;
-
-    SDL_GetWindowSize(_renderingWindow, &windowWidth, &windowHeight);
-    SDL_GL_GetDrawableSize(_renderingWindow, &renderWidth, &renderHeight);
+    _presetSearchWindow.Show();
+}
 
+float ProjectMGUI::GetScalingFactor(const WindowState& windowState)
+{
     // If the OS has a scaled UI, this will return the inverse factor. E.g. if the display is scaled to 200%,
-    // the renderWidth (in actual pixels) will be twice as much as the "virtual" unscaled window width.
-    return ((static_cast<float>(windowWidth) / static_cast<float>(renderWidth)) + (static_cast<float>(windowHeight) / static_cast<float>(renderHeight))) * 0.5f;
+    // the drawable width (in actual pixels) will be twice as much as the "virtual" unscaled window width.
+    return ((static_cast<float>(windowState.windowWidth) / static_cast<float>(windowState.drawableWidth)) +
+            (static_cast<float>(windowState.windowHeight) / static_cast<float>(windowState.drawableHeight))) * 0.5f;
 }
 
 void ProjectMGUI::DisplayToastNotificationHandler(const Poco::AutoPtr<DisplayToastNotification>& notification)
 {
-    if (Poco::Util::Application::instance().config().getBool("projectM.displayToasts", true))
+    if (_projectMWrapper != nullptr && _projectMWrapper->Settings()->displayToasts)
     {
         _toast = std::make_unique<ToastMessage>(notification->ToastText(), 3.0f);
     }
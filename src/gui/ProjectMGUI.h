@@ -3,9 +3,12 @@
 #include "AboutWindow.h"
 #include "HelpWindow.h"
 #include "MainMenu.h"
+#include "PresetSearchWindow.h"
 #include "ToastMessage.h"
 #include "SettingsWindow.h"
 
+#include "WindowState.h"
+
 #include "notifications/DisplayToastNotification.h"
 
 #include <SDL2/SDL.h>
@@ -30,8 +33,9 @@ public:
 
     /**
      * @brief Updates the font size after DPI changes.
+     * @param windowState The current window state.
      */
-    void UpdateFontSize();
+    void UpdateFontSize(const WindowState& windowState);
 
     /**
      * @brief Processes SDL input events in Dear ImGui.
@@ -59,8 +63,13 @@ public:
     /**
      * @brief Draws the UI, including toasts.
      * If neither a toast nor the UI are visible, this is basically a no-op.
+     *
+     * Doesn't call any SDL window functions, so it can run on the render thread. The display size is taken from the
+     * passed window state, input is fed in via ProcessInput().
+     *
+     * @param windowState The current window state.
      */
-    void Draw();
+    void Draw(const WindowState& windowState);
 
     /**
      * @brief Tells the caller whether the UI currently wants the keyboard input.
@@ -104,8 +113,18 @@ public:
      */
     void ShowHelpWindow();
 
+    /**
+     * @brief Displays the preset search window.
+     */
+    void ShowPresetSearchWindow();
+
 private:
-    float GetScalingFactor();
+    /**
+     * @brief Calculates the UI scaling factor from the ratio of window to drawable size.
+     * @param windowState The current window state.
+     * @return The scaling factor, 1.0 if the OS doesn't scale the UI.
+     */
+    static float GetScalingFactor(const WindowState& windowState);
 
     void DisplayToastNotificationHandler(const Poco::AutoPtr<DisplayToastNotification>& notification);
 
@@ -128,6 +147,7 @@ private:
     SettingsWindow _settingsWindow{*this}; //!< The settings window.
     AboutWindow _aboutWindow{*this}; //!< The about window.
     HelpWindow _helpWindow; //!< Help window with shortcuts and tips.
+    PresetSearchWindow _presetSearchWindow; //!< Window to find presets by name.
 
     std::unique_ptr<ToastMessage> _toast; //!< Current toast to be displayed.
 
@@ -133,6 +133,10 @@ void SettingsWindow::DrawProjectMSettingsTab()
             LabelWithTooltip("Per-Point Mesh Size X/Y", "Size of the per-point transformation grid.\nHigher values produce better quality, but require exponentially more CPU time to calculate.\nMilkdrop's default is 48x32.");
             IntegerSettingVec("projectM.meshX", "projectM.meshY", 64, 48, 8, 300);
 
+            ImGui::TableNextRow();
+            LabelWithTooltip("  Adaptive Mesh Size", "Temporarily lowers the mesh size if a preset is too slow to reach the target FPS.\nFull quality is restored if the preset renders fast enough again.\nHas no effect if FPS are unlimited.");
+            BooleanSetting("projectM.adaptiveMeshSize", false);
+
             ImGui::EndTable();
         }
         ImGui::EndTabItem();
@@ -157,20 +161,8 @@ void SettingsWindow::DrawWindowSettingsTab()
             ImGui::TableSetColumnIndex(1);
             if (ImGui::Button("Use Current Size and Position"))
             {
-                auto& renderingWindow = Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>();
-                int x;
-                int y;
-
-                renderingWindow.GetWindowSize(x, y);
-                _userConfiguration->setInt("window.width", x);
-                _userConfiguration->setInt("window.height", y);
-
-                renderingWindow.GetWindowPosition(x, y, true);
-                _userConfiguration->setInt("window.left", x);
-                _userConfiguration->setInt("window.top", y);
-
-                _userConfiguration->setBool("window.overridePosition", true);
-                _userConfiguration->setInt("window.monitor", renderingWindow.GetCurrentDisplay() + 1);
+                // Queries the window, so it's executed on the main thread.
+                Poco::Util::Application::instance().getSubsystem<SDLRenderingWindow>().StoreWindowPlacement();
             }
 
             ImGui::TableNextRow();
@@ -205,6 +197,18 @@ void SettingsWindow::DrawWindowSettingsTab()
             LabelWithTooltip("Target FPS", "Limit frames rendered per second to the given FPS value.\nNOTE: A value of 0 will NOT limit FPS and render at either VSync or unlimited pace, possibly using all CPU/GPU resources.");
             IntegerSetting("projectM.fps", 60, 0, 300);
 
+            ImGui::TableNextRow();
+            LabelWithTooltip("Render Scale", "Renders projectM at this fraction of the window resolution and upscales the result.\nLower values greatly improve performance on high-resolution displays. The UI is not affected.\nRequires libprojectM 4.1 or later.");
+            DoubleSetting("window.renderScale", 1.0, 0.25, 1.0);
+
+            ImGui::TableNextRow();
+            LabelWithTooltip("  Adaptive Render Scale", "Lowers the render scale down to the minimum scale while the GPU can't reach the target FPS.\nHigher resolutions are tried again once frames are on time.");
+            BooleanSetting("window.adaptiveRenderScale", false);
+
+            ImGui::TableNextRow();
+            LabelWithTooltip("  Minimum Render Scale", "Lowest render scale used by the adaptive render scale.");
+            DoubleSetting("window.minimumRenderScale", 0.5, 0.25, 1.0);
+
             ImGui::TableNextRow();
             LabelWithTooltip("Wait for Vertical Sync", "Wait for vertical sync interval before displaying the next frame.\nThis will limit max FPS to the vertical sync frequency but prevents tearing.");
             BooleanSetting("window.waitForVerticalSync", false);
@@ -477,11 +481,15 @@ void SettingsWindow::AudioDeviceSetting()
 {
     ImGui::TableSetColumnIndex(1);
 
-    auto devices = _audioCapture.AudioDeviceList();
+    const auto& devices = _audioCapture.AudioDeviceList();
     auto currentIndex = _audioCapture.AudioDeviceIndex();
 
+    // The current device may just have been removed.
+    auto currentDevice = devices.find(currentIndex);
+    std::string currentDeviceName = currentDevice != devices.end() ? currentDevice->second : "";
+
     ImGui::SetNextItemWidth(-1);
-    if (ImGui::BeginCombo("##audiodevice", devices.at(currentIndex).c_str(), 0))
+    if (ImGui::BeginCombo("##audiodevice", currentDeviceName.c_str(), 0))
     {
         for (const auto& device : devices)
         {
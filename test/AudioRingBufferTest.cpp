@@ -0,0 +1,75 @@
+#include "AudioRingBuffer.h"
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+#include <vector>
+
+TEST_CASE("AudioRingBuffer rounds the capacity up to a power of two", "[AudioRingBuffer]")
+{
+    AudioRingBuffer buffer;
+
+    buffer.Resize(1000);
+    CHECK(buffer.Capacity() == 1024);
+
+    buffer.Resize(1024);
+    CHECK(buffer.Capacity() == 1024);
+    CHECK(buffer.Available() == 0);
+}
+
+TEST_CASE("AudioRingBuffer returns samples in order across the wraparound", "[AudioRingBuffer]")
+{
+    AudioRingBuffer buffer;
+    buffer.Resize(8);
+
+    std::vector<float> samples(6);
+    std::iota(samples.begin(), samples.end(), 1.0f);
+
+    // Move the indices close to the end of the storage first.
+    REQUIRE(buffer.Write(samples.data(), 6));
+    CHECK(buffer.Discard(6) == 6);
+
+    std::iota(samples.begin(), samples.end(), 10.0f);
+    REQUIRE(buffer.Write(samples.data(), 6));
+    CHECK(buffer.Available() == 6);
+
+    std::vector<float> output(6);
+    CHECK(buffer.Read(output.data(), output.size()) == 6);
+    CHECK(output == samples);
+    CHECK(buffer.Available() == 0);
+}
+
+TEST_CASE("AudioRingBuffer drops writes which don't fit completely", "[AudioRingBuffer]")
+{
+    AudioRingBuffer buffer;
+    buffer.Resize(8);
+
+    std::vector<float> samples(6, 1.0f);
+    REQUIRE(buffer.Write(samples.data(), 6));
+
+    // Only two samples are free, so the overrun is dropped as a whole.
+    CHECK_FALSE(buffer.Write(samples.data(), 3));
+    CHECK(buffer.Available() == 6);
+
+    CHECK(buffer.Write(samples.data(), 2));
+    CHECK(buffer.Available() == 8);
+}
+
+TEST_CASE("AudioRingBuffer reads at most the available samples", "[AudioRingBuffer]")
+{
+    AudioRingBuffer buffer;
+    buffer.Resize(16);
+
+    std::vector<float> samples{1.0f, 2.0f, 3.0f};
+    REQUIRE(buffer.Write(samples.data(), samples.size()));
+
+    std::vector<float> output(8, 0.0f);
+    CHECK(buffer.Read(output.data(), output.size()) == 3);
+    CHECK(output[2] == 3.0f);
+    CHECK(output[3] == 0.0f);
+
+    REQUIRE(buffer.Write(samples.data(), samples.size()));
+    buffer.Clear();
+    CHECK(buffer.Available() == 0);
+    CHECK(buffer.Read(output.data(), output.size()) == 0);
+}
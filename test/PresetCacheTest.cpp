@@ -0,0 +1,115 @@
+#include "PresetCache.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+namespace {
+const Poco::Timestamp Modified{1000};
+}
+
+TEST_CASE("PresetCache returns inserted presets and counts hits and misses", "[PresetCache]")
+{
+    PresetCache cache;
+    cache.Budget(1024);
+
+    CHECK(cache.Find("a.milk", Modified) == nullptr);
+
+    cache.Insert("a.milk", Modified, "preset a");
+    auto data = cache.Find("a.milk", Modified);
+    REQUIRE(data != nullptr);
+    CHECK(*data == "preset a");
+
+    auto statistics = cache.GetStatistics();
+    CHECK(statistics.hits == 1);
+    CHECK(statistics.misses == 1);
+    CHECK(statistics.entries == 1);
+    CHECK(statistics.size == 8);
+}
+
+TEST_CASE("PresetCache drops entries if the file was modified", "[PresetCache]")
+{
+    PresetCache cache;
+    cache.Budget(1024);
+    cache.Insert("a.milk", Modified, "old contents");
+
+    CHECK(cache.Contains("a.milk", Modified));
+    CHECK_FALSE(cache.Contains("a.milk", Poco::Timestamp{2000}));
+
+    CHECK(cache.Find("a.milk", Poco::Timestamp{2000}) == nullptr);
+    CHECK(cache.GetStatistics().misses == 1);
+
+    // The outdated entry is gone, even for the old modification time.
+    CHECK(cache.Find("a.milk", Modified) == nullptr);
+    CHECK(cache.GetStatistics().size == 0);
+
+    cache.Insert("a.milk", Poco::Timestamp{2000}, "new contents");
+    auto data = cache.Find("a.milk", Poco::Timestamp{2000});
+    REQUIRE(data != nullptr);
+    CHECK(*data == "new contents");
+}
+
+TEST_CASE("PresetCache evicts the least recently used entries", "[PresetCache]")
+{
+    PresetCache cache;
+    cache.Budget(30);
+
+    cache.Insert("a.milk", Modified, std::string(10, 'a'));
+    cache.Insert("b.milk", Modified, std::string(10, 'b'));
+    cache.Insert("c.milk", Modified, std::string(10, 'c'));
+
+    // Using "a" makes "b" the least recently used entry.
+    CHECK(cache.Find("a.milk", Modified) != nullptr);
+    cache.Insert("d.milk", Modified, std::string(10, 'd'));
+
+    CHECK(cache.Contains("a.milk", Modified));
+    CHECK_FALSE(cache.Contains("b.milk", Modified));
+    CHECK(cache.Contains("c.milk", Modified));
+    CHECK(cache.Contains("d.milk", Modified));
+
+    auto statistics = cache.GetStatistics();
+    CHECK(statistics.evictions == 1);
+    CHECK(statistics.size == 30);
+
+    // Lowering the budget evicts immediately.
+    cache.Budget(10);
+    CHECK(cache.GetStatistics().entries == 1);
+    CHECK(cache.Contains("d.milk", Modified));
+}
+
+TEST_CASE("PresetCache never evicts pinned entries", "[PresetCache]")
+{
+    PresetCache cache;
+    cache.Budget(0);
+
+    cache.Pin({"a.milk", "b.milk"});
+    cache.Insert("a.milk", Modified, std::string(10, 'a'));
+    cache.Insert("b.milk", Modified, std::string(10, 'b'));
+    cache.Insert("c.milk", Modified, std::string(10, 'c'));
+
+    CHECK(cache.Contains("a.milk", Modified));
+    CHECK(cache.Contains("b.milk", Modified));
+    CHECK_FALSE(cache.Contains("c.milk", Modified));
+
+    // Unpinned entries are evicted as soon as they exceed the budget.
+    cache.Pin({"b.milk"});
+    CHECK_FALSE(cache.Contains("a.milk", Modified));
+    CHECK(cache.Contains("b.milk", Modified));
+}
+
+TEST_CASE("PresetCache removes single entries and clears", "[PresetCache]")
+{
+    PresetCache cache;
+    cache.Budget(1024);
+    cache.Insert("a.milk", Modified, "a");
+    cache.Insert("b.milk", Modified, "bb");
+
+    cache.Remove("a.milk");
+    cache.Remove("missing.milk");
+    CHECK_FALSE(cache.Contains("a.milk", Modified));
+    CHECK(cache.GetStatistics().size == 2);
+
+    cache.Clear();
+    CHECK(cache.GetStatistics().entries == 0);
+    CHECK(cache.GetStatistics().size == 0);
+}
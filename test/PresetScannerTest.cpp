@@ -0,0 +1,111 @@
+#include "PresetScanner.h"
+
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Path.h>
+#include <Poco/TemporaryFile.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Exposes the number of directories which had to be listed.
+ */
+class TestPresetScanner : public PresetScanner
+{
+public:
+    using PresetScanner::PresetScanner;
+
+    size_t ListedDirectories() const
+    {
+        return _listedDirectories;
+    }
+};
+
+void CreateFile(const std::string& fileName)
+{
+    Poco::FileOutputStream stream(fileName);
+    stream << "[preset00]\n";
+}
+
+std::vector<std::string> Scan(TestPresetScanner& scanner, const std::string& directory)
+{
+    scanner.Start({directory});
+    scanner.Wait();
+    REQUIRE(scanner.Finished());
+
+    std::vector<std::string> presetFiles;
+    scanner.TakeFoundPresets(presetFiles);
+    std::sort(presetFiles.begin(), presetFiles.end());
+
+    return presetFiles;
+}
+
+} // namespace
+
+TEST_CASE("PresetScanner recognizes preset file extensions", "[PresetScanner]")
+{
+    CHECK(PresetScanner::IsPresetFile("/presets/a.milk"));
+    CHECK(PresetScanner::IsPresetFile("B.MILK"));
+    CHECK(PresetScanner::IsPresetFile("c.prjm"));
+    CHECK_FALSE(PresetScanner::IsPresetFile("d.txt"));
+    CHECK_FALSE(PresetScanner::IsPresetFile("milk"));
+}
+
+TEST_CASE("PresetScanner finds presets and reuses the index", "[PresetScanner]")
+{
+    Poco::TemporaryFile temporaryDirectory;
+    auto root = Poco::Path(temporaryDirectory.path()).makeDirectory().toString();
+    auto presets = root + "presets/";
+    auto subdirectory = presets + "sub/";
+    auto indexFile = root + "index.dat";
+
+    Poco::File(subdirectory).createDirectories();
+    CreateFile(presets + "a.milk");
+    CreateFile(presets + "readme.txt");
+    CreateFile(subdirectory + "b.prjm");
+
+    const std::vector<std::string> expected{presets + "a.milk", subdirectory + "b.prjm"};
+
+    {
+        TestPresetScanner scanner(indexFile);
+        CHECK(Scan(scanner, presets) == expected);
+        CHECK(scanner.ListedDirectories() == 2);
+        CHECK(scanner.Directories() == std::vector<std::string>{presets, subdirectory});
+    }
+    REQUIRE(Poco::File(indexFile).exists());
+
+    SECTION("Unchanged directories are read from the index")
+    {
+        TestPresetScanner scanner(indexFile);
+        CHECK(Scan(scanner, presets) == expected);
+        CHECK(scanner.ListedDirectories() == 0);
+    }
+
+    SECTION("Changed directories are listed again")
+    {
+        CreateFile(subdirectory + "c.milk");
+
+        TestPresetScanner scanner(indexFile);
+        CHECK(Scan(scanner, presets) == std::vector<std::string>{presets + "a.milk", subdirectory + "b.prjm",
+                                                                 subdirectory + "c.milk"});
+        CHECK(scanner.ListedDirectories() == 1);
+    }
+
+    SECTION("A corrupt index is ignored")
+    {
+        {
+            Poco::FileOutputStream stream(indexFile);
+            stream << "garbage";
+        }
+
+        TestPresetScanner scanner(indexFile);
+        CHECK(Scan(scanner, presets) == expected);
+        CHECK(scanner.ListedDirectories() == 2);
+    }
+}
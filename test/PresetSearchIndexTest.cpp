@@ -0,0 +1,154 @@
+#include "gui/PresetSearchIndex.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> PresetFiles{
+    "/presets/Geiss - Cosmic Dust.milk",   // 0
+    "/presets/Stardust Memories.milk",     // 1
+    "/presets/Dust Storm.milk",            // 2
+    "/presets/Rhubarb Fondue.milk",        // 3
+    "/presets/Flexi - cosmic dust 2.milk", // 4
+    "/presets/Martin - Liquid Arrows.milk" // 5
+};
+
+/**
+ * @brief Indexes the given presets and waits until the index is available.
+ */
+void BuildIndex(PresetSearchIndex& index, const std::vector<std::string>& presetFiles, uint32_t playlistVersion)
+{
+    auto generation = index.Generation();
+    index.Update(presetFiles, playlistVersion);
+
+    // Update() is asynchronous.
+    for (int attempt = 0; attempt < 1000 && index.Generation() == generation; attempt++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    REQUIRE(index.Generation() != generation);
+    REQUIRE_FALSE(index.Updating());
+}
+
+std::vector<uint32_t> MatchIndices(const PresetSearchIndex::Results& results)
+{
+    std::vector<uint32_t> indices;
+    for (const auto& match : results.matches)
+    {
+        indices.push_back(match.index);
+    }
+    return indices;
+}
+
+} // namespace
+
+TEST_CASE("PresetSearchIndex returns nothing before the first index is built", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+
+    auto results = index.Search("cosmic", 10);
+    CHECK(results.presetCount == 0);
+    CHECK(results.matches.empty());
+}
+
+TEST_CASE("PresetSearchIndex ranks substring matches first", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 7);
+
+    auto results = index.Search("Cosmic Dust", 10);
+    CHECK(results.playlistVersion == 7);
+    CHECK(results.presetCount == PresetFiles.size());
+
+    // Both substring matches come first, the shorter name before the longer one.
+    REQUIRE(results.matches.size() >= 2);
+    CHECK(MatchIndices(results)[0] == 0);
+    CHECK(MatchIndices(results)[1] == 4);
+    CHECK(results.matches[0].name == "Geiss - Cosmic Dust");
+    CHECK(results.matches[0].fileName == PresetFiles[0]);
+
+    // Punctuation and case don't matter.
+    auto matches = MatchIndices(index.Search("geiss_cosmic", 10));
+    REQUIRE_FALSE(matches.empty());
+    CHECK(matches[0] == 0);
+}
+
+TEST_CASE("PresetSearchIndex ranks matches at the start of a word first", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+
+    auto matches = MatchIndices(index.Search("dust", 10));
+    REQUIRE(matches.size() == 4);
+
+    // "Dust Storm" is the shortest name with "dust" at a word start, "Stardust" only contains it within a word.
+    CHECK(matches[0] == 2);
+    CHECK(matches[3] == 1);
+}
+
+TEST_CASE("PresetSearchIndex tolerates typos", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+
+    auto matches = MatchIndices(index.Search("liquid arows", 10));
+    REQUIRE_FALSE(matches.empty());
+    CHECK(matches[0] == 5);
+
+    matches = MatchIndices(index.Search("cosmik dust", 10));
+    REQUIRE(matches.size() >= 2);
+    CHECK(((matches[0] == 0 && matches[1] == 4) || (matches[0] == 4 && matches[1] == 0)));
+}
+
+TEST_CASE("PresetSearchIndex matches two characters at the start of a word", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+
+    // "Fondue" and "Stardust" contain "du" within a word only.
+    auto matches = MatchIndices(index.Search("du", 10));
+    std::sort(matches.begin(), matches.end());
+    CHECK(matches == std::vector<uint32_t>{0, 2, 4});
+}
+
+TEST_CASE("PresetSearchIndex ignores queries below the minimum length", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+
+    CHECK(index.Search("", 10).matches.empty());
+    CHECK(index.Search("d", 10).matches.empty());
+
+    // Punctuation doesn't count towards the query length.
+    CHECK(index.Search(" - d_ ", 10).matches.empty());
+
+    auto results = index.Search("d", 10);
+    CHECK(results.presetCount == PresetFiles.size());
+}
+
+TEST_CASE("PresetSearchIndex limits the number of results", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+
+    auto results = index.Search("dust", 2);
+    CHECK(MatchIndices(results) == std::vector<uint32_t>{2, 0});
+}
+
+TEST_CASE("PresetSearchIndex replaces the index on updates", "[PresetSearchIndex]")
+{
+    PresetSearchIndex index;
+    BuildIndex(index, PresetFiles, 1);
+    BuildIndex(index, {"/other/Cosmic Ray.prjm"}, 2);
+
+    auto results = index.Search("cosmic", 10);
+    CHECK(results.playlistVersion == 2);
+    CHECK(results.presetCount == 1);
+    CHECK(MatchIndices(results) == std::vector<uint32_t>{0});
+}
@@ -0,0 +1,51 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "Resampler.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Measures the cost of converting one video frame's worth of captured audio, as done on the render thread.
+TEST_CASE("Resampler throughput", "[Resampler][benchmark]")
+{
+    constexpr uint32_t inputRate{48000};
+    constexpr size_t framesPerVideoFrame{inputRate / 60};
+
+    std::vector<float> input(framesPerVideoFrame * 2);
+    for (size_t frame = 0; frame < framesPerVideoFrame; frame++)
+    {
+        input[frame * 2] = static_cast<float>(std::sin(0.05 * static_cast<double>(frame)));
+        input[frame * 2 + 1] = -input[frame * 2];
+    }
+
+    std::vector<float> output;
+
+    Resampler resampler;
+
+    resampler.Configure(inputRate, 44100, 2, Resampler::Quality::Low);
+    BENCHMARK("48 kHz stereo, low quality")
+    {
+        return resampler.Process(input.data(), framesPerVideoFrame, output);
+    };
+
+    resampler.Configure(inputRate, 44100, 2, Resampler::Quality::Medium);
+    BENCHMARK("48 kHz stereo, medium quality")
+    {
+        return resampler.Process(input.data(), framesPerVideoFrame, output);
+    };
+
+    resampler.Configure(inputRate, 44100, 2, Resampler::Quality::High);
+    BENCHMARK("48 kHz stereo, high quality")
+    {
+        return resampler.Process(input.data(), framesPerVideoFrame, output);
+    };
+
+    resampler.Configure(192000, 44100, 2, Resampler::Quality::High);
+    std::vector<float> highRateInput(192000 / 60 * 2, 0.5f);
+    BENCHMARK("192 kHz stereo, high quality")
+    {
+        return resampler.Process(highRateInput.data(), 192000 / 60, output);
+    };
+}
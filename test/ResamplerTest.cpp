@@ -0,0 +1,116 @@
+#include "Resampler.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr double Pi{3.14159265358979323846};
+
+/**
+ * @brief Generates an interleaved stereo sine wave, with the right channel inverted.
+ */
+std::vector<float> StereoSine(double frequency, uint32_t sampleRate, size_t frames)
+{
+    std::vector<float> samples(frames * 2);
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        auto value = static_cast<float>(std::sin(2.0 * Pi * frequency * static_cast<double>(frame) / sampleRate));
+        samples[frame * 2] = value;
+        samples[frame * 2 + 1] = -value;
+    }
+    return samples;
+}
+
+/**
+ * @brief Resamples the input in chunks of the given size, like the capture path does.
+ */
+std::vector<float> ResampleInChunks(Resampler& resampler, const std::vector<float>& input, size_t chunkFrames)
+{
+    std::vector<float> output;
+    std::vector<float> chunkOutput;
+    for (size_t frame = 0; frame < input.size() / 2; frame += chunkFrames)
+    {
+        auto frames = std::min(chunkFrames, input.size() / 2 - frame);
+        resampler.Process(&input[frame * 2], frames, chunkOutput);
+        output.insert(output.end(), chunkOutput.begin(), chunkOutput.end());
+    }
+    return output;
+}
+
+/**
+ * @brief Returns the RMS level of one channel, skipping the filter's settling time at the start.
+ */
+double ChannelRms(const std::vector<float>& samples, size_t channel, size_t skipFrames)
+{
+    double sum{0.0};
+    size_t count{0};
+    for (size_t frame = skipFrames; frame < samples.size() / 2; frame++)
+    {
+        sum += samples[frame * 2 + channel] * samples[frame * 2 + channel];
+        count++;
+    }
+    return std::sqrt(sum / static_cast<double>(count));
+}
+
+} // namespace
+
+TEST_CASE("Resampler copies the input if both rates are equal", "[Resampler]")
+{
+    Resampler resampler;
+    resampler.Configure(44100, 44100, 2, Resampler::Quality::Medium);
+    REQUIRE(resampler.Passthrough());
+
+    auto input = StereoSine(440.0, 44100, 256);
+    std::vector<float> output;
+    CHECK(resampler.Process(input.data(), 256, output) == 256);
+    CHECK(output == input);
+}
+
+TEST_CASE("Resampler produces the expected number of output frames", "[Resampler]")
+{
+    auto inputRate = GENERATE(48000u, 96000u, 22050u, 8000u);
+    auto quality = GENERATE(Resampler::Quality::Low, Resampler::Quality::Medium, Resampler::Quality::High);
+
+    Resampler resampler;
+    resampler.Configure(inputRate, 44100, 2, quality);
+    REQUIRE_FALSE(resampler.Passthrough());
+
+    // One second of input, fed in uneven chunks.
+    auto input = StereoSine(440.0, inputRate, inputRate);
+    auto output = ResampleInChunks(resampler, input, 333);
+
+    // Only the input samples held back for the filter length, at most 32, are missing.
+    auto outputFrames = static_cast<long>(output.size() / 2);
+    auto maxMissingFrames = static_cast<long>(32 * 44100 / inputRate + 1);
+    CHECK(outputFrames <= 44100);
+    CHECK(outputFrames >= 44100 - maxMissingFrames);
+}
+
+TEST_CASE("Resampler passes low frequencies with unity gain", "[Resampler]")
+{
+    auto inputRate = GENERATE(48000u, 96000u, 22050u);
+
+    Resampler resampler;
+    resampler.Configure(inputRate, 44100, 2, Resampler::Quality::Medium);
+
+    auto input = StereoSine(1000.0, inputRate, inputRate / 2);
+    auto output = ResampleInChunks(resampler, input, 512);
+
+    // A full-scale sine has an RMS level of 1/sqrt(2).
+    CHECK(ChannelRms(output, 0, 100) == Approx(1.0 / std::sqrt(2.0)).epsilon(0.01));
+    CHECK(ChannelRms(output, 1, 100) == Approx(1.0 / std::sqrt(2.0)).epsilon(0.01));
+}
+
+TEST_CASE("Resampler attenuates frequencies above the output Nyquist frequency", "[Resampler]")
+{
+    Resampler resampler;
+    resampler.Configure(96000, 44100, 2, Resampler::Quality::High);
+
+    auto input = StereoSine(30000.0, 96000, 48000);
+    auto output = ResampleInChunks(resampler, input, 512);
+
+    CHECK(ChannelRms(output, 0, 100) < 0.01);
+}
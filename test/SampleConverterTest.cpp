@@ -0,0 +1,178 @@
+#include "SampleConverter.h"
+
+#include <Poco/Exception.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("SampleConverter converts integer formats to float", "[SampleConverter]")
+{
+    std::vector<float> output(4);
+
+    SECTION("S16")
+    {
+        const int16_t input[4]{0, 16384, -16384, -32768};
+        SampleConverter::ConvertToFloat(SampleConverter::Format::S16, input, 4, output.data());
+        CHECK(output == std::vector<float>{0.0f, 0.5f, -0.5f, -1.0f});
+    }
+
+    SECTION("S24")
+    {
+        // Packed little-endian: 0, 0x400000, -0x400000, -0x800000
+        const uint8_t input[12]{0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x80};
+        SampleConverter::ConvertToFloat(SampleConverter::Format::S24, input, 4, output.data());
+        CHECK(output == std::vector<float>{0.0f, 0.5f, -0.5f, -1.0f});
+    }
+
+    SECTION("S32")
+    {
+        const int32_t input[4]{0, 0x40000000, -0x40000000, INT32_MIN};
+        SampleConverter::ConvertToFloat(SampleConverter::Format::S32, input, 4, output.data());
+        CHECK(output == std::vector<float>{0.0f, 0.5f, -0.5f, -1.0f});
+    }
+
+    SECTION("F32")
+    {
+        const float input[4]{0.0f, 0.25f, -0.75f, 1.0f};
+        SampleConverter::ConvertToFloat(SampleConverter::Format::F32, input, 4, output.data());
+        CHECK(output == std::vector<float>{0.0f, 0.25f, -0.75f, 1.0f});
+    }
+}
+
+TEST_CASE("SampleConverter converts long blocks with odd lengths", "[SampleConverter]")
+{
+    // Long enough for the vectorized loops and the scalar remainder.
+    std::vector<int16_t> input(1001);
+    for (size_t sample = 0; sample < input.size(); sample++)
+    {
+        input[sample] = static_cast<int16_t>(static_cast<int>(sample * 61) - 30000);
+    }
+
+    std::vector<float> output(input.size());
+    SampleConverter::ConvertToFloat(SampleConverter::Format::S16, input.data(), input.size(), output.data());
+
+    for (size_t sample = 0; sample < input.size(); sample++)
+    {
+        CHECK(output[sample] == static_cast<float>(input[sample]) / 32768.0f);
+    }
+}
+
+TEST_CASE("SampleConverter passes stereo through and duplicates mono", "[SampleConverter]")
+{
+    SampleConverter converter;
+    std::vector<float> output(6);
+
+    const float stereo[6]{0.1f, -0.2f, 0.3f, -0.4f, 0.5f, -0.6f};
+    converter.Configure(SampleConverter::Format::F32, 2);
+    converter.Process(stereo, 3, output.data());
+    CHECK(output == std::vector<float>{0.1f, -0.2f, 0.3f, -0.4f, 0.5f, -0.6f});
+
+    const float mono[3]{0.1f, 0.2f, -0.3f};
+    converter.Configure(SampleConverter::Format::F32, 1);
+    converter.Process(mono, 3, output.data());
+    CHECK(output == std::vector<float>{0.1f, 0.1f, 0.2f, 0.2f, -0.3f, -0.3f});
+}
+
+TEST_CASE("SampleConverter downmixes 5.1 with normalized coefficients", "[SampleConverter]")
+{
+    SampleConverter converter;
+    converter.Configure(SampleConverter::Format::F32, 6);
+    REQUIRE(converter.Channels() == 6);
+
+    // FL FR FC LFE BL BR. Each side gets front, center, LFE and its back channel.
+    const float leftRowSum = 1.0f + 0.7071f + 0.5f + 0.7071f;
+    std::vector<float> output(2);
+
+    const float frontLeft[6]{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    converter.Process(frontLeft, 1, output.data());
+    CHECK(output[0] == Approx(1.0f / leftRowSum));
+    CHECK(output[1] == 0.0f);
+
+    const float center[6]{0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+    converter.Process(center, 1, output.data());
+    CHECK(output[0] == Approx(0.7071f / leftRowSum));
+    CHECK(output[1] == Approx(0.7071f / leftRowSum));
+
+    // Full scale on all channels must not clip.
+    const float fullScale[6]{1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+    converter.Process(fullScale, 1, output.data());
+    CHECK(output[0] == Approx(1.0f));
+    CHECK(output[1] == Approx(1.0f));
+}
+
+TEST_CASE("SampleConverter downmixes layouts above MaxChannels", "[SampleConverter]")
+{
+    SampleConverter converter;
+
+    SECTION("Even channel count")
+    {
+        const uint32_t channels{10};
+        const size_t frames{1000};
+        converter.Configure(SampleConverter::Format::S16, channels);
+
+        // Left channels at half scale, right channels at a quarter.
+        std::vector<int16_t> input(frames * channels);
+        for (size_t sample = 0; sample < input.size(); sample++)
+        {
+            input[sample] = sample % 2 == 0 ? 16384 : 8192;
+        }
+
+        std::vector<float> output(frames * 2);
+        converter.Process(input.data(), frames, output.data());
+
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            CHECK(output[frame * 2] == Approx(0.5f));
+            CHECK(output[frame * 2 + 1] == Approx(0.25f));
+        }
+    }
+
+    SECTION("Odd channel count")
+    {
+        const uint32_t channels{9};
+        const size_t frames{1000};
+        converter.Configure(SampleConverter::Format::F32, channels);
+
+        // Only the unpaired last channel is set, it must reach both sides equally.
+        std::vector<float> input(frames * channels, 0.0f);
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            input[frame * channels + channels - 1] = 1.0f;
+        }
+
+        std::vector<float> output(frames * 2, -1.0f);
+        converter.Process(input.data(), frames, output.data());
+
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            CHECK(output[frame * 2] == Approx(0.2f));
+            CHECK(output[frame * 2 + 1] == Approx(0.2f));
+        }
+
+        // Full scale on all channels must not clip on either side.
+        std::fill(input.begin(), input.end(), 1.0f);
+        converter.Process(input.data(), frames, output.data());
+        CHECK(output[0] == Approx(1.0f));
+        CHECK(output[1] == Approx(1.0f));
+    }
+
+    SECTION("Maximum channel count")
+    {
+        const uint32_t channels{SampleConverter::MaxInputChannels};
+        converter.Configure(SampleConverter::Format::F32, channels);
+
+        std::vector<float> input(channels * 3, 1.0f);
+        std::vector<float> output(6);
+        converter.Process(input.data(), 3, output.data());
+        CHECK(output == std::vector<float>(6, 1.0f));
+    }
+}
+
+TEST_CASE("SampleConverter rejects unsupported channel counts", "[SampleConverter]")
+{
+    SampleConverter converter;
+    CHECK_THROWS_AS(converter.Configure(SampleConverter::Format::F32, SampleConverter::MaxInputChannels + 1),
+                    Poco::InvalidArgumentException);
+}
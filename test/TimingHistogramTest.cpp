@@ -0,0 +1,101 @@
+#include "TimingHistogram.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+
+TEST_CASE("TimingHistogram reports zero without values", "[TimingHistogram]")
+{
+    TimingHistogram histogram;
+
+    CHECK(histogram.Count() == 0);
+    CHECK(histogram.Min() == 0);
+    CHECK(histogram.Max() == 0);
+    CHECK(histogram.Mean() == 0.0);
+    CHECK(histogram.Percentile(50.0) == 0);
+    CHECK(histogram.Buckets().empty());
+}
+
+TEST_CASE("TimingHistogram records small values exactly", "[TimingHistogram]")
+{
+    TimingHistogram histogram;
+    for (uint64_t value = 1; value <= 50; value++)
+    {
+        histogram.Record(value);
+    }
+
+    CHECK(histogram.Count() == 50);
+    CHECK(histogram.Min() == 1);
+    CHECK(histogram.Max() == 50);
+    CHECK(histogram.Mean() == Approx(25.5));
+
+    CHECK(histogram.Percentile(0.0) == 1);
+    CHECK(histogram.Percentile(50.0) == 25);
+    CHECK(histogram.Percentile(90.0) == 45);
+    CHECK(histogram.Percentile(99.0) == 50);
+    CHECK(histogram.Percentile(100.0) == 50);
+
+    // Out-of-range percentiles are clamped.
+    CHECK(histogram.Percentile(-10.0) == 1);
+    CHECK(histogram.Percentile(200.0) == 50);
+}
+
+TEST_CASE("TimingHistogram percentiles stay within the relative error for large values", "[TimingHistogram]")
+{
+    TimingHistogram histogram;
+
+    // 1000 frames at 16.6 ms and 10 spikes of 100 ms.
+    for (int frame = 0; frame < 1000; frame++)
+    {
+        histogram.Record(16600);
+    }
+    for (int spike = 0; spike < 10; spike++)
+    {
+        histogram.Record(100000);
+    }
+
+    auto median = histogram.Percentile(50.0);
+    CHECK(median >= 16600);
+    CHECK(median <= 16600 + 16600 / 32);
+
+    CHECK(histogram.Percentile(99.0) == histogram.Percentile(50.0));
+
+    // The result never exceeds the largest recorded value.
+    CHECK(histogram.Percentile(99.9) == 100000);
+    CHECK(histogram.Percentile(100.0) == 100000);
+}
+
+TEST_CASE("TimingHistogram buckets cover every value exactly once", "[TimingHistogram]")
+{
+    const uint64_t values[]{0, 63, 64, 65, 1000, 1023, 1024, 123456789, UINT64_MAX};
+
+    for (auto value : values)
+    {
+        TimingHistogram histogram;
+        histogram.Record(value);
+
+        auto buckets = histogram.Buckets();
+        REQUIRE(buckets.size() == 1);
+        CHECK(buckets[0].count == 1);
+        CHECK(buckets[0].upperBound >= value);
+        // The upper bound is at most about 3% above the value.
+        CHECK(buckets[0].upperBound - value <= value / 32);
+    }
+}
+
+TEST_CASE("TimingHistogram reset discards all values", "[TimingHistogram]")
+{
+    TimingHistogram histogram;
+    histogram.Record(5);
+    histogram.Record(500);
+    histogram.Reset();
+
+    CHECK(histogram.Count() == 0);
+    CHECK(histogram.Min() == 0);
+    CHECK(histogram.Max() == 0);
+    CHECK(histogram.Buckets().empty());
+
+    histogram.Record(7);
+    CHECK(histogram.Min() == 7);
+    CHECK(histogram.Percentile(50.0) == 7);
+}